@@ -38,6 +38,7 @@ int divideUp(int to_divide, int divisor);
 // String functions & types
 std::string toLowercase(const std::string& str);
 std::string toUppercase(const std::string& str);
+bool caseInsensitiveEqual(const std::string& a, const std::string& b);
 
 /**
  * Simple helper function to provide a printf like function.
@@ -30,9 +30,12 @@ public:
 	Configuration();
 	~Configuration();
 
-	void save();
+	bool save();
 	void load(const std::string& filePath);
 
+	void streamingLoad(bool enabled);
+	bool streamingLoad() const;
+
 	// Video Options
 	int graphicsWidth() const;
 	int graphicsHeight() const;
@@ -83,11 +86,16 @@ private:
 	Configuration& operator=(const Configuration&);	// Intentionally left undefined.
 
 	bool readConfig(const std::string& filePath);
+	bool readConfigStream(const std::string& filePath);
 
 	void parseGraphics(void *node);
 	void parseAudio(void *node);
 	void parseOptions(void *node);
 
+	void graphicsAttribute(const std::string& name, const std::string& value, const std::string& element);
+	void audioAttribute(const std::string& name, const std::string& value, const std::string& element);
+	void addOption(const std::string& name, const std::string& value, int row);
+
 private:
 	Options				mOptions;						/**< Options table containing option/value pairs. */
 
@@ -106,6 +114,7 @@ private:
 	std::string			mConfigPath;					/**< Path for the config file. */
 
 	bool				mOptionChanged;					/**< Flags whether or not an option was changed. */
+	bool				mStreamingLoad;					/**< Read the configuration file with an XmlReader. */
 };
 
 } // namespace
@@ -11,6 +11,9 @@
 
 #include "NAS2D/Signal.h"
 
+#include <atomic>
+#include <type_traits>
+
 namespace NAS2D {
 
 #define SCANCODE_MASK (1<<30)
@@ -20,6 +23,17 @@ namespace NAS2D {
  * \class	EventHandler
  * \brief	Handles and dispatches low-level events.
  * 
+ * Besides SDL events, any thread can post user events with post(). A user
+ * event emits a Signal with a payload on the main thread during pump().
+ * 
+ * \code
+ * // Main thread
+ * Signals::Signal1<const LoadResult&> loadFinished;
+ * loadFinished.connect(this, &Object::onLoadFinished);
+ * 
+ * // Worker thread
+ * Utility<EventHandler>::get().post(loadFinished, result);
+ * \endcode
  */
 class EventHandler
 {
@@ -584,6 +598,71 @@ public:
 
 	void disconnectAll();
 
+	void post(Signals::Signal0<>& signal);
+
+	/**
+	 * Posts a user event that emits a Signal on the main thread the next time
+	 * pump() is called. Can be called from any thread.
+	 *
+	 * \param	signal	Signal to emit. Must outlive the event.
+	 * \param	payload	Value to emit the signal with. Copied into the event.
+	 *
+	 * \note	The EventHandler must be created on the main thread before any
+	 *			other thread posts to it.
+	 */
+	template<class Param>
+	void post(Signals::Signal1<Param>& signal, const typename std::decay<Param>::type& payload) { postUserEvent(new SignalEvent1<Param>(signal, payload)); }
+
+	void userEventBudget(int count);
+	int userEventBudget() const;
+
+private:
+	/**
+	 * Node of the user event queue.
+	 */
+	struct UserEvent
+	{
+		UserEvent() : next(nullptr) {}
+		virtual ~UserEvent() {}
+
+		virtual void dispatch() {}
+
+		std::atomic<UserEvent*>	next;
+	};
+
+	/**
+	 * User event that emits a Signal0.
+	 */
+	struct SignalEvent0 : public UserEvent
+	{
+		SignalEvent0(Signals::Signal0<>& _signal) : signal(_signal) {}
+		void dispatch() { signal(); }
+
+		Signals::Signal0<>&	signal;
+	};
+
+	/**
+	 * User event that emits a Signal1 with a payload.
+	 */
+	template<class Param>
+	struct SignalEvent1 : public UserEvent
+	{
+		typedef typename std::decay<Param>::type Payload;
+
+		SignalEvent1(Signals::Signal1<Param>& _signal, const Payload& _payload) : signal(_signal), payload(_payload) {}
+		void dispatch() { signal(payload); }
+
+		Signals::Signal1<Param>&	signal;
+		Payload						payload;
+	};
+
+private:
+	EventHandler(const EventHandler&);				// Intentionally left undefined.
+	EventHandler& operator=(const EventHandler&);	// Intentionally left undefined.
+
+	void postUserEvent(UserEvent* event);
+	UserEvent* popUserEvent();
+
 private:
 	ActivateEventCallback				mActivateEvent;
 
@@ -614,6 +693,13 @@ private:
 	MouseWheelEventCallback				mMouseWheelEvent;
 
 	QuitEventCallback					mQuitEvent;
+
+	std::atomic<UserEvent*>				mUserEventHead;		/**< Most recently posted user event. Producers push here. */
+	UserEvent*							mUserEventTail;		/**< Oldest user event. Only touched by pump(). */
+	UserEvent							mUserEventStub;		/**< Placeholder node that keeps the queue from ever being empty. */
+	std::atomic<int>					mUserEventCount;	/**< Number of user events that are fully linked into the queue. */
+
+	int									mUserEventBudget;	/**< Maximum number of user events dispatched each pump(). */
 };
 
 void postQuitEvent();
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 namespace NAS2D {
@@ -19,6 +20,12 @@ namespace NAS2D {
  * \brief Represent a File object.
  *
  * The File object represents a file as a stream of bytes.
+ *
+ * The bytes are stored in an immutable buffer that is shared between copies of
+ * a File so copying a File is cheap. Functions that give non-const access to
+ * the bytes make a private copy of the buffer first if it's shared. Once a
+ * reference or iterator into the bytes has been handed out the buffer is no
+ * longer shared and copies of the File get their own copy of the bytes.
  */
 class File
 {
@@ -33,10 +40,72 @@ public:
 	typedef std::string ByteStream; /**< Byte stream. */
 
 
+	/**
+	 * \class Buffer
+	 * \brief Storage for the bytes of a File.
+	 *
+	 * Buffers must be null terminated so that raw_bytes() can be used as a C string.
+	 */
+	class Buffer
+	{
+	public:
+		virtual ~Buffer() {}
+
+		/**
+		 * Gets a pointer to the null terminated bytes of the buffer.
+		 */
+		virtual RawByteStream data() const = 0;
+
+		/**
+		 * Gets the size, in bytes, of the buffer not including the null terminator.
+		 */
+		virtual size_t size() const = 0;
+
+		/**
+		 * Gets the bytes as a ByteStream.
+		 *
+		 * \note	Buffers that aren't backed by a ByteStream build one on first use
+		 *			and keep it for as long as the buffer lives. Must be safe to call
+		 *			from more than one thread.
+		 */
+		virtual const ByteStream& bytes() const = 0;
+
+		/**
+		 * Gets the bytes as a ByteStream or \c nullptr if the buffer isn't backed
+		 * by a ByteStream.
+		 */
+		virtual ByteStream* stream() { return nullptr; }
+	};
+
+
+	/**
+	 * \class StreamBuffer
+	 * \brief Buffer backed by a ByteStream.
+	 */
+	class StreamBuffer : public Buffer
+	{
+	public:
+		StreamBuffer() {}
+		StreamBuffer(const ByteStream& stream) : mStream(stream) {}
+		StreamBuffer(ByteStream&& stream) : mStream(std::move(stream)) {}
+
+		RawByteStream data() const { return mStream.c_str(); }
+		size_t size() const { return mStream.size(); }
+		const ByteStream& bytes() const { return mStream; }
+		ByteStream* stream() { return &mStream; }
+
+	private:
+		ByteStream	mStream;
+	};
+
+
+	typedef std::shared_ptr<Buffer> BufferPtr; /**< Shared pointer to a File's Buffer. */
+
+
 	/**
 	 * Default C'tor
 	 */
-	File()
+	File():	mLeaked(false)
 	{}
 
 	/**
@@ -45,7 +114,25 @@ public:
 	 * \param	stream	A ByteStream representing the file.
 	 * \param	name	The full name of the file including path.
 	 */
-	File(const ByteStream& stream, const std::string& name):	mByteStream(stream), mFileName(name)
+	File(const ByteStream& stream, const std::string& name):	mBuffer(std::make_shared<StreamBuffer>(stream)), mFileName(name), mLeaked(false)
+	{}
+
+	/**
+	 * C'tor
+	 *
+	 * \param	stream	A ByteStream representing the file. The File takes over its contents.
+	 * \param	name	The full name of the file including path.
+	 */
+	File(ByteStream&& stream, const std::string& name):	mBuffer(std::make_shared<StreamBuffer>(std::move(stream))), mFileName(name), mLeaked(false)
+	{}
+
+	/**
+	 * C'tor
+	 *
+	 * \param	buffer	Buffer holding the bytes of the file.
+	 * \param	name	The full name of the file including path.
+	 */
+	File(BufferPtr buffer, const std::string& name):	mBuffer(buffer), mFileName(name), mLeaked(false)
 	{}
 
 	/**
@@ -57,18 +144,27 @@ public:
 
 	/**
 	 * Copy c'tor
+	 *
+	 * \note	Copies share the same buffer unless \c _f has handed out a
+	 *			non-const reference or iterator to its bytes.
 	 */
-	File(const File& _f):	mByteStream(_f.mByteStream), mFileName(_f.mFileName)
+	File(const File& _f):	mBuffer(_f.share()), mFileName(_f.mFileName), mLeaked(false)
 	{}
 
 
 	/**
 	 * Copy operator.
+	 *
+	 * \note	Copies share the same buffer unless \c _f has handed out a
+	 *			non-const reference or iterator to its bytes.
 	 */
 	File& operator=(const File& _f)
 	{
-		mByteStream = _f.mByteStream;
+		if (this == &_f) { return *this; }
+
+		mBuffer = _f.share();
 		mFileName = _f.mFileName;
+		mLeaked = false;
 		return *this;
 	}
 
@@ -77,16 +173,27 @@ public:
 	 *
 	 * \note	This gets a \c non-const reference to the internal \c ByteStream
 	 *			so that modifications can be made as necessary.
+	 *
+	 * \note	Makes a private copy of the bytes if they are shared with another
+	 *			File or not stored in a ByteStream.
 	 */
-	ByteStream& bytes() { return mByteStream; }
+	ByteStream& bytes() { return *leak(); }
 
 
 	/**
 	 * Gets a reference to the internal ByteStream.
 	 *
 	 * \note	This gets a \c const reference to the internal \c ByteStream.
+	 *
+	 * \note	Files opened from a memory mapped file have no ByteStream. One is
+	 *			built next to the mapping on first use, which copies the whole
+	 *			file. Prefer raw_bytes() and size().
 	 */
-	const ByteStream& bytes() const { return mByteStream; }
+	const ByteStream& bytes() const
+	{
+		static const ByteStream EMPTY_STREAM;
+		return mBuffer ? mBuffer->bytes() : EMPTY_STREAM;
+	}
 
 
 	/**
@@ -94,15 +201,16 @@ public:
 	 *
 	 * \note	This function is provided as a convenience for
 	 *			use with low-level and legacy C libraries that
-	 *			need a const char* byte stream.
+	 *			need a const char* byte stream. The stream is
+	 *			always null terminated.
 	 */
-	RawByteStream raw_bytes() const { return mByteStream.c_str(); }
+	RawByteStream raw_bytes() const { return mBuffer ? mBuffer->data() : ""; }
 
 
 	/**
 	 * Gets the size, in bytes, of the File.
 	 */
-	size_t size() const { return mByteStream.size(); }
+	size_t size() const { return mBuffer ? mBuffer->size() : 0; }
 
 
 	/**
@@ -119,7 +227,7 @@ public:
 	 *				will truncate the existing data. There is no way to
 	 *				recover the data once the File is resized.
 	 */
-	void resize(int size) { mByteStream.resize(size); }
+	void resize(int size) { detach()->resize(size); }
 
 
 	/**
@@ -132,39 +240,39 @@ public:
 	 *				will truncate the existing data. There is no way to
 	 *				recover the data once the File is resized.
 	 */
-	void resize(int size, byte b) { mByteStream.resize(size, b); }
+	void resize(int size, byte b) { detach()->resize(size, b); }
 
 	/**
 	 * Indicates that the File is empty.
 	 */
-	bool empty() const { return mByteStream.empty(); }
+	bool empty() const { return size() == 0; }
 
 	/**
 	 * Gets an iterator to the beginning of the File's byte stream.
 	 */
-	iterator begin() { return mByteStream.begin(); }
+	iterator begin() { return leak()->begin(); }
 
 	/**
 	 * Gets an iterator to the end of the File's byte stream.
 	 */
-	iterator end() { return mByteStream.end(); }
+	iterator end() { return leak()->end(); }
 
 	/**
 	 * Gets a reverse iterator to the beginning of the File's byte stream.
 	 */
-	reverse_iterator rbegin() { return mByteStream.rbegin(); }
+	reverse_iterator rbegin() { return leak()->rbegin(); }
 
 	/**
 	 * Gets a reverse iterator to the end of the File's byte stream.
 	 */
-	reverse_iterator rend() { return mByteStream.rend(); }
+	reverse_iterator rend() { return leak()->rend(); }
 
 	/**
 	 * Gets an iterator to the byte at a specified position.
 	 * 
 	 * \param pos	Position of the iterator to get.
 	 */
-	iterator seek(size_t pos) { iterator it = mByteStream.begin() + pos; return it; }
+	iterator seek(size_t pos) { iterator it = leak()->begin() + pos; return it; }
 
 	/**
 	 * Gets a reverse iterator to the byte at a specified position.
@@ -173,7 +281,7 @@ public:
 	 * 
 	 * \see seek
 	 */
-	reverse_iterator rseek(size_t pos) { reverse_iterator it = mByteStream.rbegin() + pos; return it; }
+	reverse_iterator rseek(size_t pos) { reverse_iterator it = leak()->rbegin() + pos; return it; }
 
 	/**
 	 * Gets a byte from the byte stream at a specified position.
@@ -183,7 +291,7 @@ public:
 	 * \warning	Out of range positions yield undefined behavior. Some compilers will
 	 *			throw an \c out_of_range exception.
 	 */
-	byte& operator[](size_t pos) { return mByteStream[pos]; }
+	byte& operator[](size_t pos) { return (*leak())[pos]; }
 
 	/**
 	 * Gets a const byte from the byte stream at a specified position.
@@ -193,12 +301,12 @@ public:
 	 * \warning	Out of range positions yield undefined behavior. Some compilers will
 	 *			throw an \c out_of_range exception.
 	 */
-	const_byte& operator[](size_t pos) const { return mByteStream[pos]; }
+	const_byte& operator[](size_t pos) const { return raw_bytes()[pos]; }
 
 	/**
 	 * Clears the File and leaves it completely empty.
 	 */
-	void clear() { mByteStream = ""; mFileName = ""; }
+	void clear() { mBuffer.reset(); mFileName = ""; mLeaked = false; }
 
 
 	/**
@@ -210,8 +318,51 @@ public:
 	std::string filename() const { return mFileName; }
 
 private:
-	ByteStream	mByteStream;	/**< Internal stream of bytes. */
-	std::string	mFileName;		/**< Internal filename including directory path. */
+	/**
+	 * Makes sure the File has a ByteStream of its own that can be modified.
+	 */
+	ByteStream* detach()
+	{
+		ByteStream* stream = mBuffer ? mBuffer->stream() : nullptr;
+		if (!stream || !mBuffer.unique())
+		{
+			mBuffer = std::make_shared<StreamBuffer>(ByteStream(raw_bytes(), size()));
+			stream = mBuffer->stream();
+		}
+
+		return stream;
+	}
+
+	/**
+	 * Makes sure the File has a ByteStream of its own and marks it as unshareable
+	 * because a reference or iterator into it is about to be handed out.
+	 */
+	ByteStream* leak()
+	{
+		ByteStream* stream = detach();
+		mLeaked = true;
+		return stream;
+	}
+
+	/**
+	 * Gets a buffer for a copy of this File. The buffer is shared unless a
+	 * reference into it has been handed out in which case it's copied so that
+	 * writes through the reference can't show up in the copy.
+	 */
+	BufferPtr share() const
+	{
+		if (mLeaked && mBuffer)
+		{
+			return std::make_shared<StreamBuffer>(ByteStream(raw_bytes(), size()));
+		}
+
+		return mBuffer;
+	}
+
+private:
+	BufferPtr			mBuffer;		/**< Shared buffer of bytes. */
+	std::string			mFileName;		/**< Internal filename including directory path. */
+	bool				mLeaked;		/**< Indicates that a non-const reference into the buffer has been handed out. */
 };
 
 } // namespace
@@ -0,0 +1,70 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright © 2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// = 
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+
+#pragma once
+
+#include <string>
+
+namespace NAS2D {
+
+/**
+ * \class FileStream
+ * \brief Seekable reader or writer over a file in the Filesystem.
+ *
+ * Unlike File, a FileStream doesn't load the whole file into memory. Bytes are
+ * read on demand through a buffer whose size can be set when the stream is opened
+ * with Filesystem::openStream() or changed later with bufferSize().
+ *
+ * Streams opened with Filesystem::openWriteStream() write bytes through the buffer
+ * as they're produced instead.
+ *
+ * A FileStream can be handed to SDL functions that take an \c SDL_RWops (e.g.,
+ * \c Mix_LoadMUS_RW or \c IMG_Load_RW) with rwops().
+ *
+ * FileStreams can be moved but not copied.
+ */
+class FileStream
+{
+public:
+	FileStream();
+	FileStream(void* handle, const std::string& name);
+	FileStream(FileStream&& other) noexcept;
+	~FileStream();
+
+	FileStream& operator=(FileStream&& other) noexcept;
+
+	bool isOpen() const;
+	bool close();
+	bool flush();
+
+	size_t read(void* buffer, size_t size);
+	size_t write(const void* buffer, size_t size);
+
+	bool seek(unsigned long long position);
+	unsigned long long tell() const;
+	unsigned long long size() const;
+	bool eof() const;
+
+	bool bufferSize(size_t size);
+
+	void* rwops();
+
+	const std::string& filename() const;
+
+private:
+	FileStream(const FileStream&);				// Intentionally left undefined.
+	FileStream& operator=(const FileStream&);	// Intentionally left undefined.
+
+private:
+	void*			mHandle;	/**< Handle to a PHYSFS_File. */
+	std::string		mFileName;	/**< Internal filename including directory path. */
+};
+
+} // namespace
@@ -15,6 +15,7 @@
 #include <string>
 
 #include "File.h"
+#include "FileStream.h"
 
 namespace NAS2D {
 
@@ -42,8 +43,11 @@ public:
 	StringList directoryList(const std::string& dir, const std::string& filter) const;
 
 	File open(const std::string& filename) const;
+	FileStream openStream(const std::string& filename, size_t bufferSize = 32768) const;
+	FileStream openWriteStream(const std::string& filename, bool overwrite = true, size_t bufferSize = 32768) const;
 	bool write(const File& file, bool overwrite = true) const;
 	bool del(const std::string& path) const;
+	bool rename(const std::string& from, const std::string& to) const;
 	bool exists(const std::string& filename) const;
 
 	std::string extension(const std::string& path);
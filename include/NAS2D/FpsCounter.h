@@ -9,25 +9,78 @@
 // ==================================================================================
 #pragma once
 
+#include "NAS2D/Timer.h"
+
+#include <cstddef>
+#include <vector>
+
 namespace NAS2D {
 
 /**
  * \class FpsCounter
- * \brief Implements a basic FPS Counter.
+ * \brief Implements an FPS Counter and frame time recorder.
+ * 
+ * Call fps() or frame() once per frame. Each call records the time since the previous
+ * call in a ring buffer of recent frame times. fps() returns an average over the most
+ * recent frames while stats() and histogram() describe every frame in the buffer.
+ * 
+ * Averages hide stutter. When looking for uneven frame pacing use the percentiles and
+ * the 1% low FPS reported by stats().
  * 
- * FPS values are only approximates. As the FPS count gets higher, the returned value
- * becomes a more average count.
+ * \code{.cpp}
+ * FpsCounter counter;
  * 
- * \note	Because of the nature of FPS counters and their limited context, the
- *			FpsCounter has been designed with shared state. This means that multiple
- *			instances of FpsCounter will share values.
+ * // Every frame
+ * counter.frame();
+ * 
+ * FpsCounter::FrameStats stats = counter.stats();
+ * std::cout << "p99: " << stats.p99 << " ms, 1% low: " << stats.low1Fps << " FPS" << std::endl;
+ * \endcode
  */
 class FpsCounter
 {
 public:
-	FpsCounter();
+	/**
+	 * Statistics on the frame times in an FpsCounter. Times are in milliseconds.
+	 */
+	struct FrameStats
+	{
+		size_t	samples = 0;	/**< Number of frame times the statistics were computed from. */
+
+		double	min = 0.0;		/**< Shortest frame time. */
+		double	max = 0.0;		/**< Longest frame time. */
+		double	mean = 0.0;		/**< Average frame time. */
+
+		double	p50 = 0.0;		/**< Median frame time. */
+		double	p95 = 0.0;		/**< 95th percentile frame time. */
+		double	p99 = 0.0;		/**< 99th percentile frame time. */
+
+		double	low1Fps = 0.0;	/**< Average FPS of the slowest 1% of frames. */
+	};
+
+public:
+	FpsCounter(size_t sampleCount = 1000);
 
 	unsigned int fps();
+	void frame();
+
+	FrameStats stats() const;
+	std::vector<unsigned int> histogram(double bucketWidth, size_t bucketCount) const;
+
+	size_t size() const;
+	size_t capacity() const;
+
+	void reset();
+
+private:
+	double sample(size_t age) const;
+
+private:
+	Timer				mTimer;			/**< Measures time between frames. */
+	std::vector<double>	mSamples;		/**< Ring buffer of frame times in milliseconds. */
+	size_t				mNext;			/**< Index of the next sample to write. */
+	size_t				mCount;			/**< Number of samples recorded, up to the size of the buffer. */
+	bool				mStarted;		/**< Whether the first frame has been seen. */
 };
 
 } // namespace
@@ -52,6 +52,13 @@ namespace NAS2D {
  *	return 0;
  * }
  * \endcode
+ *
+ * To run States at a fixed timestep, call fixedTimestep() before go():
+ *
+ * \code{.cpp}
+ * game.fixedTimestep(60);
+ * game.go(new MyState());
+ * \endcode
  */
 class Game
 {
@@ -61,7 +68,13 @@ public:
 
 	void mount(const std::string& path);
 
+	void fixedTimestep(unsigned int stepsPerSecond, unsigned int maxStepsPerFrame = 5);
+
 	void go(State *state);
+
+private:
+	unsigned int	mStepsPerSecond;		/**< Fixed update rate passed to the StateManager. 0 for no fixed timestep. */
+	unsigned int	mMaxStepsPerFrame;		/**< Maximum number of fixed updates per frame. */
 };
 
 } // namespace
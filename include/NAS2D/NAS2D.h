@@ -15,6 +15,7 @@
 #include "NAS2D/Filesystem.h"
 #include "NAS2D/FpsCounter.h"
 #include "NAS2D/Game.h"
+#include "NAS2D/Profiler.h"
 #include "NAS2D/Utility.h"
 #include "NAS2D/StateManager.h"
 #include "NAS2D/Timer.h"
@@ -26,7 +27,10 @@
 
 #include "NAS2D/Resources/Font.h"
 #include "NAS2D/Resources/Image.h"
+#include "NAS2D/Resources/ImageAtlas.h"
+#include "NAS2D/Resources/ImageCache.h"
 #include "NAS2D/Resources/Music.h"
+#include "NAS2D/Resources/ResourceLoader.h"
 #include "NAS2D/Resources/Sound.h"
 #include "NAS2D/Resources/Sprite.h"
 
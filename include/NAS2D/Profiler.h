@@ -0,0 +1,176 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright © 2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// = 
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#pragma once
+
+#include "NAS2D/Timer.h"
+#include "NAS2D/Utility.h"
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * \def NAS2D_PROFILE_ZONE(name)
+ * Times the enclosing scope and records it in the Profiler as \c name.
+ *
+ * \c name must be a string literal. Does nothing unless NAS2D is built with
+ * \c NAS2D_PROFILE defined.
+ */
+
+/**
+ * \def NAS2D_PROFILE_FRAME()
+ * Marks the end of a frame. Called once per frame by Game::go().
+ *
+ * Does nothing unless NAS2D is built with \c NAS2D_PROFILE defined.
+ */
+#if defined(NAS2D_PROFILE)
+	#define NAS2D_PROFILE_CONCAT_IMPL(a, b) a##b
+	#define NAS2D_PROFILE_CONCAT(a, b) NAS2D_PROFILE_CONCAT_IMPL(a, b)
+	#define NAS2D_PROFILE_ZONE(name) NAS2D::ProfileZone NAS2D_PROFILE_CONCAT(_profileZone, __LINE__)(name)
+	#define NAS2D_PROFILE_FRAME() NAS2D::Utility<NAS2D::Profiler>::get().frame()
+#else
+	#define NAS2D_PROFILE_ZONE(name)
+	#define NAS2D_PROFILE_FRAME()
+#endif
+
+namespace NAS2D {
+
+/**
+ * \class Profiler
+ * \brief Records timed zones of code for a frame timeline.
+ *
+ * Zones are recorded with the NAS2D_PROFILE_ZONE() macro, which times the scope
+ * it's placed in. Zones are kept in a ring buffer along with a "Frame" zone for
+ * every frame of the game loop so the oldest zones are dropped once the buffer
+ * is full. Zones can be recorded from any thread.
+ *
+ * Recorded zones can be exported in the Chrome trace event format and viewed
+ * with \c chrome://tracing or any compatible viewer.
+ *
+ * \code{.cpp}
+ * void MyState::updateUnits()
+ * {
+ *	NAS2D_PROFILE_ZONE("MyState::updateUnits");
+ *	...
+ * }
+ *
+ * // Later, before the Game is destroyed.
+ * Utility<Profiler>::get().writeTrace("trace.json");
+ * \endcode
+ *
+ * \note	The profiling macros compile out to nothing unless NAS2D and the
+ *			application are built with \c NAS2D_PROFILE defined. The Profiler
+ *			itself is always available.
+ *
+ * \note	The Profiler is created by Game before any worker threads start.
+ *			Applications that don't use Game should call
+ *			<tt>Utility<Profiler>::get()</tt> before starting threads of their
+ *			own that record zones.
+ */
+class Profiler
+{
+public:
+	Profiler(size_t capacity = 65536);
+	~Profiler();
+
+	void enabled(bool enabled);
+	bool enabled() const;
+
+	double now() const;
+
+	void record(const char* name, double start, double end);
+	void frame();
+
+	unsigned int frameCount() const;
+
+	size_t size() const;
+	size_t capacity() const;
+	void clear();
+
+	std::string trace() const;
+	bool writeTrace(const std::string& filename) const;
+
+private:
+	/**
+	 * A timed zone. Times are in milliseconds since the Profiler was created.
+	 */
+	struct Zone
+	{
+		const char*		name;
+		double			start;
+		double			duration;
+		unsigned int	thread;
+		unsigned int	frame;
+	};
+
+	typedef std::map<std::thread::id, unsigned int> ThreadMap;
+
+private:
+	Profiler(const Profiler&);				// Intentionally left undefined.
+	Profiler& operator=(const Profiler&);	// Intentionally left undefined.
+
+private:
+	Timer						mTimer;			/**< Clock zones are timed with. */
+	double						mStart;			/**< Time the Profiler was created. */
+	double						mFrameStart;	/**< Time the current frame started or a negative value before the first frame. */
+
+	std::atomic<bool>			mEnabled;		/**< Whether zones are recorded. */
+	std::atomic<unsigned int>	mFrame;			/**< Number of the current frame. */
+
+	mutable std::mutex			mMutex;			/**< Guards everything below. */
+	std::vector<Zone>			mZones;			/**< Ring buffer of recorded zones. Allocated on first use. */
+	size_t						mCapacity;		/**< Size of the ring buffer. */
+	size_t						mNext;			/**< Index of the next zone to write. */
+	size_t						mCount;			/**< Number of recorded zones, up to mCapacity. */
+	ThreadMap					mThreads;		/**< Short ID's for threads that recorded zones. */
+};
+
+
+/**
+ * \class ProfileZone
+ * \brief Records the time between its construction and destruction in the Profiler.
+ *
+ * Use NAS2D_PROFILE_ZONE() instead of creating ProfileZones directly so they
+ * compile out of builds without profiling.
+ */
+class ProfileZone
+{
+public:
+	/**
+	 * C'tor
+	 *
+	 * \param	name	Name of the zone. Must be a string literal.
+	 */
+	explicit ProfileZone(const char* name) : mProfiler(Utility<Profiler>::get()), mName(name), mStart(mProfiler.enabled() ? mProfiler.now() : -1.0)
+	{}
+
+	/**
+	 * D'tor. Records the zone.
+	 */
+	~ProfileZone()
+	{
+		if (mStart >= 0.0) { mProfiler.record(mName, mStart, mProfiler.now()); }
+	}
+
+private:
+	ProfileZone(const ProfileZone&);				// Intentionally left undefined.
+	ProfileZone& operator=(const ProfileZone&);		// Intentionally left undefined.
+
+private:
+	Profiler&		mProfiler;
+	const char*		mName;
+	double			mStart;
+};
+
+} // namespace
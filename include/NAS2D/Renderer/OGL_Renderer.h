@@ -21,6 +21,22 @@ namespace NAS2D {
  */
 class OGL_Renderer: public Renderer
 {
+public:
+	/**
+	 * \enum	BatchFlushReason
+	 * \brief	Reasons a pending batch of quads is submitted to OpenGL.
+	 */
+	enum BatchFlushReason
+	{
+		FLUSH_TEXTURE_CHANGE,	/**< A quad using a different texture was queued. */
+		FLUSH_STATE_CHANGE,		/**< Blend, texture or other GL state needed to change. */
+		FLUSH_SCISSOR_CHANGE,	/**< The clipping rectangle was changed. */
+		FLUSH_MATRIX_CHANGE,	/**< The projection or modelview matrix was changed. */
+		FLUSH_FRAME_END,		/**< The frame was presented. */
+
+		FLUSH_REASON_COUNT
+	};
+
 public:
 	OGL_Renderer(const std::string& title);
 
@@ -72,6 +88,9 @@ public:
 
 	void update();
 
+	unsigned int batchCount() const;
+	unsigned int batchFlushCount(BatchFlushReason reason) const;
+
 private:
 	OGL_Renderer(const OGL_Renderer&);				// Intentionally left undefined;
 	OGL_Renderer& operator=(const OGL_Renderer&);	// Intentionally left undefined;
@@ -45,6 +45,25 @@ extern const NAS2D::Color_4ub COLOR_NORMAL;
  */
 class Renderer
 {
+public:
+	/**
+	 * Counts of the work a Renderer did during a frame.
+	 *
+	 * What counts as each kind of work depends on the Renderer. The base
+	 * Renderer doesn't count anything.
+	 */
+	struct DrawStats
+	{
+		unsigned int	drawCalls = 0;				/**< Draw calls submitted to the graphics API. */
+		unsigned int	quads = 0;					/**< Quads drawn, batched or not. */
+		unsigned int	vertices = 0;				/**< Vertices submitted with draw calls. */
+		unsigned int	textureBinds = 0;			/**< Textures bound. */
+		unsigned int	stateChanges = 0;			/**< Render states enabled or disabled. */
+		unsigned int	scissorChanges = 0;			/**< Times the clipping rectangle was set or cleared. */
+		unsigned int	framebufferSwitches = 0;	/**< Render targets bound. */
+		unsigned int	glyphs = 0;					/**< Text glyphs drawn. */
+	};
+
 public:
 	Renderer();
 	virtual ~Renderer();
@@ -137,9 +156,14 @@ public:
 
 	virtual void update();
 
+	const DrawStats& drawStats() const;
+	void drawStatsOverlay(Font& font, float x, float y);
+
 protected:
 	Renderer(const std::string& rendererName, const std::string& appTitle);
 
+	void drawStats(const DrawStats& stats);
+
 	virtual void initVideo(unsigned int resX, unsigned int resY, unsigned int bpp, bool fullscreen, bool vsync) {}
 	void driverName(const std::string& name);
 
@@ -174,6 +198,8 @@ private:
 	float				mCurrentFade;	/**< Current fade amount. */
 
 	Point_2df			mResolution;	/**< Screen resolution. */
+
+	DrawStats			mDrawStats;		/**< Draw statistics for the last complete frame. */
 };
 
 } // namespace
@@ -38,7 +38,9 @@ public:
 	Font(const std::string& filePath, int ptSize = 12);
 	Font(const std::string& filePath, int glyphWidth, int glyphHeight, int glyphSpace);
 	Font(const Font& font);
+	Font(Font&& font) noexcept;
 	Font& operator=(const Font& font);
+	Font& operator=(Font&& font) noexcept;
 	~Font();
 
 	int width(const std::string& str) const;
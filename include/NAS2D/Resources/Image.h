@@ -45,7 +45,9 @@ public:
 	Image();
 
 	Image(const Image &rhs);
+	Image(Image&& rhs) noexcept;
 	Image& operator=(const Image& rhs);
+	Image& operator=(Image&& rhs) noexcept;
 
 	~Image();
 
@@ -0,0 +1,74 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright © 2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// =
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#pragma once
+
+#include "NAS2D/Common.h"
+#include "NAS2D/Resources/Image.h"
+
+namespace NAS2D {
+
+/**
+ * \class ImageAtlas
+ * \brief Packs small Images into shared texture pages.
+ *
+ * When enabled, Images that are no larger than maxImageSize() in either dimension
+ * are packed into shared texture pages as they are loaded instead of getting a
+ * texture of their own. Images that share a page can be drawn without changing
+ * textures which allows the Renderer to batch them together.
+ *
+ * The atlas is disabled by default and should be configured before any Images
+ * are loaded:
+ *
+ * \code{.cpp}
+ * ImageAtlas& atlas = Utility<ImageAtlas>::get();
+ * atlas.pageSize(2048);
+ * atlas.maxImageSize(128);
+ * atlas.enabled(true);
+ * \endcode
+ *
+ * \note	Space used by an Image is returned to a page only when every Image on
+ *			that page has been released.
+ *
+ * \note	Images used as the destination of Renderer::drawImageToImage() are
+ *			moved out of the atlas.
+ */
+class ImageAtlas
+{
+public:
+	ImageAtlas();
+	~ImageAtlas();
+
+	void enabled(bool enable);
+	bool enabled() const;
+
+	void pageSize(int size);
+	int pageSize() const;
+
+	void maxImageSize(int size);
+	int maxImageSize() const;
+
+	void build(const StringList& imageList);
+	void clear();
+
+	int pageCount() const;
+	int imageCount(int page) const;
+
+	float occupancy(int page) const;
+	float occupancy() const;
+
+private:
+	ImageAtlas(const ImageAtlas&);				// Intentionally left undefined;
+	ImageAtlas& operator=(const ImageAtlas&);	// Intentionally left undefined;
+
+private:
+	ImageList		mImages;	/**< Images kept resident by build(). */
+};
+
+} // namespace
@@ -0,0 +1,77 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright © 2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// =
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#pragma once
+
+#include <cstddef>
+
+namespace NAS2D {
+
+/**
+ * \class ImageCache
+ * \brief Controls what happens to the pixels of an Image once it has been
+ *		  uploaded to the GPU.
+ *
+ * Images only need their pixels on the CPU side for Image::pixelColor(). Keeping
+ * them around for every Image doubles the memory used by textures so the policy
+ * can be changed to one of:
+ *
+ * - PIXELS_KEEP: Pixels are kept for the lifetime of the Image. This is the default.
+ * - PIXELS_CACHE: Pixels are kept in a least recently used cache limited to budget()
+ *   bytes. Evicted pixels are read back when needed.
+ * - PIXELS_DISCARD: Pixels are freed after upload. If they're ever needed they're
+ *   read back once and kept in the cache from then on as if the Image had been
+ *   loaded with PIXELS_CACHE. Best for Images that are never queried.
+ *
+ * Pixels are read back from disk for Images loaded from a file or from the GPU for
+ * Images created from a buffer or used as the destination of
+ * Renderer::drawImageToImage(). Images packed into an ImageAtlas page only read
+ * back their own part of the page.
+ *
+ * \code{.cpp}
+ * ImageCache& cache = Utility<ImageCache>::get();
+ * cache.policy(ImageCache::PIXELS_CACHE);
+ * cache.budget(32 * 1024 * 1024);
+ * \endcode
+ *
+ * \note	An Image uses the policy that was set when it was loaded.
+ */
+class ImageCache
+{
+public:
+	enum PixelPolicy
+	{
+		PIXELS_KEEP,
+		PIXELS_CACHE,
+		PIXELS_DISCARD,
+		PIXEL_POLICY_COUNT
+	};
+
+public:
+	ImageCache();
+	~ImageCache();
+
+	void policy(PixelPolicy policy);
+	PixelPolicy policy() const;
+
+	void budget(size_t bytes);
+	size_t budget() const;
+
+	size_t residentBytes(PixelPolicy policy) const;
+	size_t residentBytes() const;
+
+	unsigned int reloadCount() const;
+	unsigned int evictionCount() const;
+
+private:
+	ImageCache(const ImageCache&);				// Intentionally left undefined;
+	ImageCache& operator=(const ImageCache&);	// Intentionally left undefined;
+};
+
+} // namespace
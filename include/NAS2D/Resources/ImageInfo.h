@@ -9,6 +9,7 @@
 // ==================================================================================
 #pragma once
 
+#include <cstddef>
 
 /**
  * Struct containing basic information related to Images. Not part of the public
@@ -16,13 +17,20 @@
  */
 struct ImageInfo
 {
-	ImageInfo() : pixels(nullptr), texture_id(0), fbo_id(0), w(0), h(0), ref_count(0) {}
+	ImageInfo() : pixels(nullptr), pixel_policy(0), pixel_bytes(0), pixel_stamp(0), texture_id(0), fbo_id(0), w(0), h(0), ref_count(0), atlas_page(-1), u0(0.0f), v0(0.0f), u1(1.0f), v1(1.0f) {}
 
 	void*			pixels;
+	int				pixel_policy;	/**< ImageCache::PixelPolicy the image was loaded with. */
+	size_t			pixel_bytes;	/**< Size of pixels in bytes or 0 if pixels are not resident. */
+	unsigned long long	pixel_stamp;	/**< Last use of pixels. Used by the ImageCache to find the least recently used image. */
 
 	unsigned int	texture_id;
 	unsigned int	fbo_id;
 	int				w;
 	int				h;
 	int				ref_count;
+
+	int				atlas_page;		/**< Index of the ImageAtlas page the image was packed into or -1 if it has its own texture. */
+	float			u0, v0;			/**< Top left texture coordinate of the image within its texture. */
+	float			u1, v1;			/**< Bottom right texture coordinate of the image within its texture. */
 };
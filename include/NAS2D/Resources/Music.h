@@ -27,7 +27,9 @@ public:
 	Music(const std::string& filePath);
 
 	Music(const Music& rhs);
+	Music(Music&& rhs) noexcept;
 	Music& operator=(const Music& rhs);
+	Music& operator=(Music&& rhs) noexcept;
 
 	~Music();
 
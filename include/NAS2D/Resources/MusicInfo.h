@@ -15,10 +15,9 @@
  */
 struct MusicInfo
 {
-	MusicInfo() : buffer(nullptr), music(nullptr), ref_count(0)
+	MusicInfo() : music(nullptr), ref_count(0)
 	{}
 
-	void*	buffer;
 	void*	music;
 	int		ref_count;
 };
@@ -10,10 +10,31 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 namespace NAS2D {
 
+/**
+ * \struct	ResourceHandle
+ * \brief	Identifies a slot in a resource registry.
+ *
+ * Handles are checked against the generation of the slot they refer to so
+ * that a handle to a released resource is never mistaken for a newer resource
+ * that reuses the same slot. A default constructed handle is invalid.
+ */
+struct ResourceHandle
+{
+	ResourceHandle() : index(0), generation(0) {}
+	ResourceHandle(unsigned int _index, unsigned int _generation) : index(_index), generation(_generation) {}
+
+	bool valid() const { return generation != 0; }
+
+	unsigned int index;			/**< Index of the slot. */
+	unsigned int generation;	/**< Generation of the slot when the handle was issued. 0 is never issued. */
+};
+
+
 /**
  * \class	Resource
  * \brief	A basic Resource.
@@ -32,9 +53,17 @@ public:
 
 	bool loaded() const;
 
+	const ResourceHandle& handle() const;
+
 protected:
+	Resource(const Resource& rhs);
+	Resource(Resource&& rhs) noexcept;
+	Resource& operator=(const Resource& rhs);
+	Resource& operator=(Resource&& rhs) noexcept;
+
 	void loaded(bool loaded);
 	void name(const std::string& name);
+	void handle(const ResourceHandle& handle);
 
 private:
 	/**
@@ -48,7 +77,9 @@ private:
 	 */
 	virtual void load() = 0;
 
-	std::string mResourceName;		/**< File path and internal identifier. */
+	std::shared_ptr<const std::string> mResourceName;	/**< File path and internal identifier. Shared between copies so copying a Resource doesn't copy the string. */
+
+	ResourceHandle mHandle;			/**< Handle to the resource's shared data. Invalid for resources without shared data. */
 	
 	bool mIsLoaded;					/**< Flag indicating whether or not this Resource has loaded properly. */
 };
@@ -0,0 +1,143 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright © 2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// =
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#pragma once
+
+#include "NAS2D/Signal.h"
+
+#include "NAS2D/Resources/Font.h"
+#include "NAS2D/Resources/Image.h"
+#include "NAS2D/Resources/Music.h"
+#include "NAS2D/Resources/Sound.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NAS2D {
+
+/**
+ * \class ResourceLoader
+ * \brief Loads resources in the background.
+ *
+ * Files are read and decoded by a pool of worker threads. Anything that needs
+ * the OpenGL context (e.g., uploading textures) is finished on the main thread
+ * by update() which is called once per frame by the Game loop. update() spends
+ * at most uploadBudget() milliseconds per frame so that loading doesn't stall
+ * the frame rate.
+ *
+ * Loaded resources are kept resident by the ResourceLoader until clear() is
+ * called so constructing a resource that has been loaded in the background is
+ * nearly free. Completion of each resource is reported through signals:
+ *
+ * \code{.cpp}
+ * ResourceLoader& loader = Utility<ResourceLoader>::get();
+ * loader.imageLoaded().connect(this, &LoadingState::onImageLoaded);
+ * loader.loadImage("sprites/player.png");
+ * loader.loadFont("fonts/opensans.ttf", 14);
+ *
+ * // ... later, while drawing a loading screen.
+ * renderer.drawBoxFilled(10.0f, 10.0f, 200.0f * loader.progress(), 20.0f, 255, 255, 255, 255);
+ * if (loader.finished()) { return new PlayState(); }
+ * \endcode
+ *
+ * \note	Resource loading functions must only be called from the main thread.
+ *
+ * \note	Don't call clear() from a slot connected to one of the loaded signals.
+ */
+class ResourceLoader
+{
+public:
+	typedef Signals::Signal1<Image&>	ImageLoadedCallback;
+	typedef Signals::Signal1<Font&>		FontLoadedCallback;
+	typedef Signals::Signal1<Music&>	MusicLoadedCallback;
+	typedef Signals::Signal1<Sound&>	SoundLoadedCallback;
+
+public:
+	ResourceLoader();
+	~ResourceLoader();
+
+	void threadCount(int count);
+	int threadCount() const;
+
+	void uploadBudget(unsigned int ms);
+	unsigned int uploadBudget() const;
+
+	void loadImage(const std::string& filePath);
+	void loadFont(const std::string& filePath, int ptSize = 12);
+	void loadFont(const std::string& filePath, int glyphWidth, int glyphHeight, int glyphSpace);
+	void loadMusic(const std::string& filePath);
+	void loadSound(const std::string& filePath);
+
+	void update();
+	void wait();
+	void clear();
+
+	int pending() const;
+	int completed() const;
+	float progress() const;
+	bool finished() const;
+
+	ImageLoadedCallback& imageLoaded();
+	FontLoadedCallback& fontLoaded();
+	MusicLoadedCallback& musicLoaded();
+	SoundLoadedCallback& soundLoaded();
+
+private:
+	struct Job;
+
+	typedef std::vector<Font> FontList;
+	typedef std::vector<Music> MusicList;
+	typedef std::vector<Sound*> SoundList;
+	typedef std::deque<Job*> JobQueue;
+
+private:
+	ResourceLoader(const ResourceLoader&);				// Intentionally left undefined;
+	ResourceLoader& operator=(const ResourceLoader&);	// Intentionally left undefined;
+
+	void queue(Job* job);
+	void finish(Job* job);
+
+	void decode(Job& job);
+	void discard(Job& job);
+
+	void startWorkers();
+	void stopWorkers();
+	void work();
+
+private:
+	std::vector<std::thread>	mWorkers;			/**< Worker thread pool. Started on the first load request. */
+	std::mutex					mMutex;				/**< Guards the job queues and mStopping. */
+	std::condition_variable		mJobCondition;		/**< Signaled when a job is queued or the workers should stop. */
+	std::condition_variable		mDoneCondition;		/**< Signaled when a job has been decoded. */
+
+	JobQueue					mJobs;				/**< Jobs waiting to be decoded. */
+	JobQueue					mDone;				/**< Decoded jobs waiting to be finished on the main thread. */
+	bool						mStopping;
+
+	int							mThreadCount;
+	unsigned int				mUploadBudget;
+
+	int							mTotal;				/**< Number of jobs requested since the loader was last idle. */
+	int							mCompleted;			/**< Number of those jobs that have been finished. */
+
+	ImageList					mImages;			/**< Loaded resources kept resident until clear(). */
+	FontList					mFonts;
+	MusicList					mMusic;
+	SoundList					mSounds;
+
+	ImageLoadedCallback			mImageLoaded;
+	FontLoadedCallback			mFontLoaded;
+	MusicLoadedCallback			mMusicLoaded;
+	SoundLoadedCallback			mSoundLoaded;
+};
+
+} // namespace
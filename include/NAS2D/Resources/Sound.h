@@ -31,6 +31,9 @@ public:
 
 protected:
 	friend class Mixer_SDL;
+	friend class ResourceLoader;
+
+	Sound(const std::string& filePath, void* chunk);
 
 	void* sound() const;
 
@@ -13,6 +13,7 @@
 #include "NAS2D/NAS2D.h"
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -26,9 +27,15 @@ extern const std::string SPRITE_VERSION;
  *
  * The Sprite Class is a self-contained group of Image Resource's that displays
  * Image's at a specified screen coordinate in sequence to display an animation.
+ *
+ * The imagesheets and actions of a sprite definition file are loaded once and
+ * shared by every Sprite created from the same file for as long as any of them
+ * exist. Each Sprite only stores its own playback state.
  */
 class Sprite
 {
+	friend class SpriteBatch;
+
 public:
 	typedef NAS2D::Signals::Signal0<> Callback;	/**< Signal used when action animations complete. */
 
@@ -104,6 +111,12 @@ public:
 	void incrementFrame();
 	void decrementFrame();
 
+	static void streamingLoad(bool enabled);
+	static bool streamingLoad();
+
+	static void compiledCache(bool enabled);
+	static bool compiledCache();
+
 protected:
 	/// Gets the name of the Sprite. \note Internal use only.
 	const std::string& name() const { return mSpriteName; }
@@ -116,14 +129,14 @@ private:
 	class SpriteFrame
 	{
 	public:
-		SpriteFrame(const std::string& sheetId, int x, int y, int w, int h, int aX, int aY, int d);
+		SpriteFrame(Image& sheet, int x, int y, int w, int h, int aX, int aY, int d);
 		SpriteFrame(const SpriteFrame &spriteframe);
 
 		SpriteFrame& operator=(const SpriteFrame &rhs);
 
 		~SpriteFrame() {}
 
-		const std::string& sheetId() const { return mSheetId; }
+		Image& sheet() const { return *mSheet; }
 		
 		int anchorX() const { return mAnchorX; }
 		int anchorY() const { return mAnchorY; }
@@ -136,7 +149,7 @@ private:
 		int frameDelay() const { return mFrameDelay; }
 
 	private:
-		std::string		mSheetId;
+		Image*			mSheet;
 
 		int				mFrameDelay;
 		int				mAnchorX, mAnchorY;
@@ -145,27 +158,45 @@ private:
 	};
 
 private:
+	struct FrameDefinition;
+	struct SpriteDefinition;
+
 	typedef std::vector<SpriteFrame>			FrameList;
 	typedef std::map<std::string, FrameList>	ActionList;
 	typedef std::map<std::string, Image>		SheetList;
 
+	typedef std::map<std::string, std::weak_ptr<SpriteDefinition>>	DefinitionCache;
+
 private:
+	void processCompiled(const std::string& filePath);
+	bool readCompiled(const File& file, unsigned long long hash);
+	void writeCompiled(const std::string& filePath, unsigned long long hash);
+
 	void processXml(const std::string& filePath);
+	void processXmlStream(const std::string& filePath);
 	void processImageSheets(void* root);
-	void addImageSheet(const std::string& id, const std::string& src, void* node);
+	void addImageSheet(const std::string& id, const std::string& src, int row);
 
 	void processActions(void* root);
 	void processFrames(const std::string& action, void* node);
+	void addAction(const std::string& action, const std::vector<FrameDefinition>& frames);
+
+	static bool frameAttribute(FrameDefinition& frame, const Xml::XmlString& name, const Xml::XmlString& value);
 
 	bool validateSheetId(const std::string& sheetId, int row);
 
 	void addDefaultAction();
 
+	const FrameList& currentFrames() const;
+
+	static const FrameList* findAction(const SpriteDefinition& definition, const std::string& action);
+
+	static DefinitionCache& definitionCache();
+
 private:
 	Timer				mTimer;				/**< Internal time keeper. */
 
-	SheetList			mImageSheets;		/**< Imagesheets */
-	ActionList			mActions;			/**< A list of Actions and their associated Frames. */
+	std::shared_ptr<SpriteDefinition>	mDefinition;	/**< Imagesheets and Actions shared by all Sprites loaded from the same file. */
 
 	std::string			mSpriteName;		/**< Name of this Sprite. */
 	std::string			mCurrentAction;		/**< The current Action being performed. */
@@ -0,0 +1,105 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright © 2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// =
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#pragma once
+
+#include "NAS2D/Resources/Sprite.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace NAS2D {
+
+/**
+ * \class SpriteBatch
+ * \brief Animates and draws large numbers of Sprites together.
+ *
+ * A SpriteBatch holds the playback state of many sprite instances in flat
+ * arrays. update() advances every instance from a single time delta and draw()
+ * draws them all grouped by imagesheet so the Renderer can batch their quads.
+ *
+ * Instances are created from a Sprite, which supplies the definition and
+ * starting state, and are referred to by index afterward.
+ *
+ * \code{.cpp}
+ * Sprite unit("sprites/unit.sprite");
+ *
+ * SpriteBatch units;
+ * for (int i = 0; i < 5000; ++i)
+ * {
+ *	units.add(unit, i % 100 * 16.0f, i / 100 * 16.0f);
+ * }
+ *
+ * // Every frame
+ * units.update();
+ * units.draw();
+ * \endcode
+ *
+ * \note	Instances are drawn in the order they were added within an imagesheet
+ *			but instances on different imagesheets aren't drawn in any
+ *			particular order relative to each other.
+ *
+ * \note	Instances don't have frame callbacks. Use Sprite for anything that
+ *			needs to know when its animation completes.
+ *
+ * \note	Not included by NAS2D.h. Sprite.h includes NAS2D.h so SpriteBatch.h
+ *			has to be included on its own.
+ */
+class SpriteBatch
+{
+public:
+	SpriteBatch();
+	~SpriteBatch();
+
+	size_t add(const Sprite& sprite, float x, float y);
+	void remove(size_t index);
+	void clear();
+
+	size_t size() const;
+
+	void play(size_t index, const std::string& action);
+	void pause(size_t index);
+	void resume(size_t index);
+
+	void position(size_t index, float x, float y);
+	void rotation(size_t index, float angle);
+	void color(size_t index, const Color_4ub& color);
+
+	void update();
+	void update(unsigned int delta);
+
+	void draw();
+
+private:
+	SpriteBatch(const SpriteBatch&);				// Intentionally left undefined.
+	SpriteBatch& operator=(const SpriteBatch&);		// Intentionally left undefined.
+
+private:
+	typedef std::pair<unsigned int, unsigned int>	DrawKey;	/**< Imagesheet and index of an instance. */
+
+private:
+	Timer										mTimer;				/**< Time keeper for update(). */
+
+	std::vector<std::shared_ptr<Sprite::SpriteDefinition>>	mDefinitions;	/**< Keeps each instance's definition loaded. */
+	std::vector<const Sprite::FrameList*>		mFrames;			/**< Frames of each instance's current action. */
+	std::vector<unsigned int>					mCurrentFrame;		/**< Index of each instance's current frame. */
+	std::vector<unsigned int>					mAccumulator;		/**< Time, in milliseconds, each instance has spent on its current frame. */
+	std::vector<char>							mPaused;			/**< Whether each instance is paused. */
+
+	std::vector<float>							mX;					/**< X-Coordinate of each instance. */
+	std::vector<float>							mY;					/**< Y-Coordinate of each instance. */
+	std::vector<float>							mRotation;			/**< Angle of rotation of each instance in degrees. */
+	std::vector<Color_4ub>						mColor;				/**< Color of each instance. */
+
+	std::vector<DrawKey>						mDrawOrder;			/**< Scratch space for sorting instances by imagesheet. */
+};
+
+} // namespace
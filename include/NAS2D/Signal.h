@@ -17,6 +17,8 @@
 // =	- Removed templates for parameter lists 6 - 8
 // =	- Replaced for loops using C++11 range-based loops
 // =	- Added doxygen comments for automatic generation of documentation.
+// =	- Replaced std::set with a contiguous list that allows disconnecting
+// =	  during emit.
 // = 
 // = Created by Patrick Hogan on 5/18/09.
 // = https://github.com/pbhogan/Signals
@@ -26,11 +28,84 @@
 #pragma once
 
 #include "Delegate.h"
-#include <set>
+#include <algorithm>
+#include <vector>
 
 namespace NAS2D {
 namespace Signals {
 
+namespace detail {
+
+/**
+ * \class DelegateVector
+ * \brief Contiguous list of delegates used by the Signal classes.
+ *
+ * Delegates are called in the order they were connected and each delegate is
+ * only connected once.
+ *
+ * Delegates can be connected and disconnected while the list is being emitted.
+ * Disconnected delegates are cleared in place and removed once the outermost
+ * emit returns. Delegates connected during an emit are not called until the
+ * next emit.
+ */
+template<class _Delegate>
+class DelegateVector
+{
+public:
+	DelegateVector() : emitDepth(0), erased(false) {}
+
+	void insert(const _Delegate& delegate) { if (std::find(delegates.begin(), delegates.end(), delegate) == delegates.end()) delegates.push_back(delegate); }
+
+	void erase(const _Delegate& delegate)
+	{
+		auto it = std::find(delegates.begin(), delegates.end(), delegate);
+		if (it == delegates.end()) { return; }
+
+		if (emitDepth > 0) { it->clear(); erased = true; }
+		else { delegates.erase(it); }
+	}
+
+	void clear()
+	{
+		if (emitDepth > 0) { for (auto& delegate : delegates) delegate.clear(); erased = true; }
+		else { delegates.clear(); }
+	}
+
+	bool empty() const
+	{
+		if (!erased) { return delegates.empty(); }
+		return std::find_if(delegates.begin(), delegates.end(), [](const _Delegate& delegate) { return !delegate.empty(); }) == delegates.end();
+	}
+
+	template<class... Params>
+	void emit(Params&... params) const
+	{
+		++emitDepth;
+
+		// Delegates are copied out before they're called because connecting
+		// during the call can reallocate the list. A copy is two pointers.
+		size_t count = delegates.size();
+		for (size_t i = 0; i < count; ++i)
+		{
+			const _Delegate delegate = delegates[i];
+			if (!delegate.empty()) { delegate(params...); }
+		}
+
+		if (--emitDepth == 0 && erased)
+		{
+			delegates.erase(std::remove_if(delegates.begin(), delegates.end(), [](const _Delegate& delegate) { return delegate.empty(); }), delegates.end());
+			erased = false;
+		}
+	}
+
+private:
+	mutable std::vector<_Delegate>	delegates;
+	mutable int						emitDepth;	/**< Number of emits in progress. */
+	mutable bool					erased;		/**< Whether delegates were disconnected during an emit. */
+};
+
+} // namespace detail
+
 /**
  * \class Signal0
  * \brief Signal with no paramters.
@@ -61,13 +136,12 @@ public:
 	void disconnect(Y * obj, void (X::*func)() const) { delegateList.erase(MakeDelegate(obj, func)); }
 
 	void clear() { delegateList.clear(); }
-	void emit() const { for (auto i : delegateList) i(); }
+	void emit() const { delegateList.emit(); }
 	void operator() () const { emit(); }
 	bool empty() const { return delegateList.empty(); }
 
 private:
-	typedef std::set<_Delegate> DelegateList;
-	typedef typename DelegateList::const_iterator DelegateIterator;
+	typedef detail::DelegateVector<_Delegate> DelegateList;
 	DelegateList delegateList;
 };
 
@@ -101,13 +175,12 @@ public:
 	void disconnect(Y * obj, void (X::*func)(Param1 p1) const) { delegateList.erase(MakeDelegate(obj, func)); }
 	
 	void clear() { delegateList.clear(); }
-	void emit(Param1 p1) const { for (auto i : delegateList) i(p1); }
+	void emit(Param1 p1) const { delegateList.emit(p1); }
 	void operator() (Param1 p1) const { emit(p1); }
 	bool empty() const { return delegateList.empty(); }
 
 private:
-	typedef std::set<_Delegate> DelegateList;
-	typedef typename DelegateList::const_iterator DelegateIterator;
+	typedef detail::DelegateVector<_Delegate> DelegateList;
 	DelegateList delegateList;
 };
 
@@ -143,12 +216,11 @@ public:
 
 	void clear() { delegateList.clear(); }
 	void operator() (Param1 p1, Param2 p2) const { emit(p1, p2); }
-	void emit(Param1 p1, Param2 p2) const { for (auto i : delegateList) i(p1, p2); }
+	void emit(Param1 p1, Param2 p2) const { delegateList.emit(p1, p2); }
 	bool empty() const { return delegateList.empty(); }
 
 private:
-	typedef std::set<_Delegate> DelegateList;
-	typedef typename DelegateList::const_iterator DelegateIterator;
+	typedef detail::DelegateVector<_Delegate> DelegateList;
 	DelegateList delegateList;
 };
 
@@ -183,13 +255,12 @@ public:
 	void disconnect(Y * obj, void (X::*func)(Param1 p1, Param2 p2, Param3 p3) const) { delegateList.erase(MakeDelegate(obj, func)); }
 
 	void clear() { delegateList.clear(); }
-	void emit(Param1 p1, Param2 p2, Param3 p3) const { for (auto i : delegateList) i(p1, p2, p3); }
+	void emit(Param1 p1, Param2 p2, Param3 p3) const { delegateList.emit(p1, p2, p3); }
 	void operator() (Param1 p1, Param2 p2, Param3 p3) const { emit(p1, p2, p3); }
 	bool empty() const { return delegateList.empty(); }
 
 private:
-	typedef std::set<_Delegate> DelegateList;
-	typedef typename DelegateList::const_iterator DelegateIterator;
+	typedef detail::DelegateVector<_Delegate> DelegateList;
 	DelegateList delegateList;
 };
 
@@ -224,13 +295,12 @@ public:
 	void disconnect(Y * obj, void (X::*func)(Param1 p1, Param2 p2, Param3 p3, Param4 p4) const) { delegateList.erase(MakeDelegate(obj, func)); }
 
 	void clear() { delegateList.clear(); }
-	void emit(Param1 p1, Param2 p2, Param3 p3, Param4 p4) const { for (auto i : delegateList) i(p1, p2, p3, p4); }
+	void emit(Param1 p1, Param2 p2, Param3 p3, Param4 p4) const { delegateList.emit(p1, p2, p3, p4); }
 	void operator() (Param1 p1, Param2 p2, Param3 p3, Param4 p4) const { emit(p1, p2, p3, p4); }
 	bool empty() const { return delegateList.empty(); }
 
 private:
-	typedef std::set<_Delegate> DelegateList;
-	typedef typename DelegateList::const_iterator DelegateIterator;
+	typedef detail::DelegateVector<_Delegate> DelegateList;
 	DelegateList delegateList;
 };
 
@@ -265,13 +335,12 @@ public:
 	void disconnect(Y * obj, void (X::*func)(Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5) const) { delegateList.erase(MakeDelegate(obj, func)); }
 
 	void clear() { delegateList.clear(); }
-	void emit(Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5) const { for (auto i : delegateList) i(p1, p2, p3, p4, p5); }
+	void emit(Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5) const { delegateList.emit(p1, p2, p3, p4, p5); }
 	void operator() (Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5) const { emit(p1, p2, p3, p4, p5); }
 	bool empty() const { return delegateList.empty(); }
 
 private:
-	typedef std::set<_Delegate> DelegateList;
-	typedef typename DelegateList::const_iterator DelegateIterator;
+	typedef detail::DelegateVector<_Delegate> DelegateList;
 	DelegateList delegateList;
 };
 
@@ -44,6 +44,14 @@ namespace NAS2D {
  * Updates to the State are done once every frame via the \c update() function. Updates
  * include logic, drawing, event handling, state changes, etc.
  *
+ * \section state-fixed Fixed Timestep Updates
+ *
+ * When the StateManager runs at a fixed timestep (see StateManager::fixedTimestep()),
+ * \c fixedUpdate() is called zero or more times before each \c update() so that
+ * simulation advances by the same amount of time at a steady rate regardless of the
+ * frame rate. \c update() then only needs to draw, using \c interpolation() to blend
+ * between the previous and current simulation states.
+ *
  * \section state-template Base Template
  * 
  * The following is a template State object. Use this as a starting point for building
@@ -77,7 +85,7 @@ namespace NAS2D {
 class State
 {
 public:
-	State() {}
+	State() : mInterpolation(1.0f) {}
 
 	virtual ~State() {}
 
@@ -109,6 +117,27 @@ protected:
 	 *			NAS2D application.
 	 */
 	virtual State* update() = 0;
+
+
+	/**
+	 * Called at a fixed rate when the StateManager runs at a fixed timestep.
+	 * Does nothing by default.
+	 *
+	 * \param	step	Time, in seconds, to advance the simulation by. Always
+	 *					the same for a given rate.
+	 */
+	virtual void fixedUpdate(float step) {}
+
+
+	/**
+	 * Gets how far, from 0.0 to 1.0, the current frame is between the last
+	 * fixed update and the next one. Always 1.0 when the StateManager doesn't
+	 * run at a fixed timestep.
+	 */
+	float interpolation() const { return mInterpolation; }
+
+private:
+	float		mInterpolation;		/**< Interpolation alpha set by the StateManager before each update(). */
 };
 
 } // namespace
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "State.h"
+#include "NAS2D/Timer.h"
 #include "NAS2D/Utility.h"
 
 namespace NAS2D {
@@ -37,12 +38,21 @@ public:
 
 	void forceStopAudio(bool);
 
+	void fixedTimestep(unsigned int stepsPerSecond, unsigned int maxStepsPerFrame = 5);
+	unsigned int fixedTimestep() const;
+
 private:
+	void fixedUpdate();
 	void handleQuit();
 
 	State			*mActiveState;
 	bool			mActive;
 	bool			mForceStopAudio = true;
+
+	Timer			mTimer;						/**< Measures frame time for fixed timestep updates. */
+	unsigned int	mStepsPerSecond = 0;		/**< Fixed update rate. 0 when not running at a fixed timestep. */
+	unsigned int	mMaxStepsPerFrame = 5;		/**< Maximum number of fixed updates per frame. */
+	double			mStepAccumulator = 0.0;		/**< Time, in milliseconds, not yet simulated. */
 };
 
 } // namespace
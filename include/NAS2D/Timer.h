@@ -14,7 +14,7 @@ namespace NAS2D {
 
 /**
  * \class Timer
- * \brief A timing class that provides high-resolution, millisecond-precision timing services.
+ * \brief A timing class that provides high-resolution timing services.
  * 
  * The Timer class provides three different method for getting and managing timing.
  * 
@@ -52,6 +52,15 @@ namespace NAS2D {
  * Accumulators are used internally in the Sprite animation handling to account for time desynchs between frames. As
  * time passes the frame counter loses accuracy. Using an accumulator corrects for these inaccuracies by skipping
  * frames whenever needed.
+ *
+ * \section Precision
+ *
+ * Timers are driven by the system's performance counter. delta() and accumulator() report whole
+ * milliseconds but carry the leftover fraction of a millisecond forward to the next call so no
+ * time is lost to rounding. preciseTick(), preciseDelta() and preciseAccumulator() report the
+ * same values as fractional milliseconds.
+ *
+ * \note	delta() and preciseDelta() share the same starting point. Calling one resets the other.
  */
 class Timer
 {
@@ -64,14 +73,19 @@ public:
 	unsigned int accumulator();
 	void adjust_accumulator(unsigned int a);
 
+	double preciseTick() const;
+	double preciseDelta();
+	double preciseAccumulator();
+
 	void reset();
 
 private:
 	
-	unsigned int	mCurrentTick;
-	unsigned int	mLastTick;
+	unsigned long long	mCurrentTick;		/**< Performance counter value at the last call to delta(). */
+	unsigned long long	mLastTick;			/**< Performance counter value at the call to delta() before that. */
 
-	unsigned int	mAccumulator;
+	double				mDeltaRemainder;	/**< Fraction of a millisecond not yet reported by delta(). */
+	double				mAccumulator;		/**< Accumulated time in milliseconds. */
 };
 
 } // namespace
@@ -52,6 +52,8 @@
 #include "NAS2D/Xml/XmlHandle.h"
 #include "NAS2D/Xml/XmlMemoryBuffer.h"
 #include "NAS2D/Xml/XmlNode.h"
+#include "NAS2D/Xml/XmlReader.h"
+#include "NAS2D/Xml/XmlString.h"
 #include "NAS2D/Xml/XmlText.h"
 #include "NAS2D/Xml/XmlVisitor.h"
 #include "NAS2D/Xml/XmlUnknown.h"
@@ -0,0 +1,63 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright  2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// =
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace NAS2D {
+namespace Xml {
+
+/**
+ * Bump allocator used by an XmlDocument to allocate its nodes, attributes and
+ * strings.
+ *
+ * Memory is handed out sequentially from large blocks and is only released when
+ * the arena is destroyed. Individual allocations are never freed.
+ */
+class XmlArena
+{
+public:
+	XmlArena(size_t blockSize = 16384);
+	~XmlArena();
+
+	void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	bool owns(const void* p) const;
+
+	size_t size() const;
+
+private:
+	XmlArena(const XmlArena&); // Explicitly disallowed.
+	void operator=(const XmlArena&); // Explicitly disallowed.
+
+private:
+	/**
+	 * Block of memory owned by the arena.
+	 */
+	struct Block
+	{
+		char*	begin;
+		char*	end;
+	};
+
+	static bool contains(const Block& block, const char* address);
+
+private:
+	std::vector<Block>	_blocks;		/**< Blocks of memory owned by the arena, sorted by address. */
+	char*				_cursor;		/**< Next free byte in the current block. */
+	size_t				_remaining;		/**< Bytes left in the current block. */
+	size_t				_blockSize;		/**< Size of a regular block. */
+	size_t				_size;			/**< Total number of bytes reserved by the arena. */
+	mutable size_t		_lastOwner;		/**< Index of the block that owned the last address passed to owns(). */
+};
+
+} // namespace Xml
+} // namespace NAS2D
@@ -39,6 +39,9 @@ public:
 	const std::string& name() const;
 	const std::string& value() const;
 
+	const XmlString& nameView() const;
+	const XmlString& valueView() const;
+
 	int intValue() const;
 	void intValue(int i);
 
@@ -61,7 +64,7 @@ public:
 	bool operator<(const XmlAttribute& rhs)	 const { return _name < rhs._name; }
 	bool operator>(const XmlAttribute& rhs)  const { return _name > rhs._name; }
 
-	bool operator==(const std::string& rhs) const { return rhs == _name; }
+	bool operator==(const std::string& rhs) const { return _name == rhs; }
 
 	/**
 	 * Attribute parsing starts: first letter of the name
@@ -84,8 +87,9 @@ private:
 
 private:
 	XmlDocument*	_document;	/**< Comment Me. */
-	std::string		_name;		/**< Comment Me. */
-	std::string		_value;		/**< Comment Me. */
+	XmlAttributeSet*	_set;		/**< Set the attribute belongs to, if any. */
+	XmlString		_name;		/**< Comment Me. */
+	XmlString		_value;		/**< Comment Me. */
 	XmlAttribute*	_prev;		/**< Comment Me. */
 	XmlAttribute*	_next;		/**< Comment Me. */
 };
@@ -13,6 +13,9 @@
 
 #include "NAS2D/Xml/XmlAttribute.h"
 
+#include <unordered_map>
+#include <vector>
+
 namespace NAS2D {
 namespace Xml {
 
@@ -35,6 +38,7 @@ public:
 
 	void add(XmlAttribute* attribute);
 	void remove(XmlAttribute* attribute);
+	void clear(XmlArena* arena = nullptr);
 
 	const XmlAttribute* first()	const { return (sentinel._next == &sentinel) ? nullptr : sentinel._next; }
 	XmlAttribute* first() { return (sentinel._next == &sentinel) ? nullptr : sentinel._next; }
@@ -42,14 +46,30 @@ public:
 	XmlAttribute* last() { return (sentinel._prev == &sentinel) ? nullptr : sentinel._prev; }
 
 	XmlAttribute* find(const std::string& _name) const;
+	XmlAttribute* find(const XmlString& _name) const;
+	XmlAttribute* findNoCase(const std::string& _name) const;
 	XmlAttribute* findOrCreate(const std::string& _name);
 
+	size_t size() const { return _index.size(); }
+
+private:
+	friend class XmlAttribute;
+
+	typedef std::unordered_multimap<size_t, XmlAttribute*> AttributeTable;
 
 private:
 	XmlAttributeSet(const XmlAttributeSet&); // Explicitly disallowed.
 	void operator=(const XmlAttributeSet&); // Explicitly disallowed.
 
+	XmlAttribute* find(const char* name, size_t length) const;
+
+	void rename(XmlAttribute* attribute, const std::string& name);
+	void tableRemove(XmlAttribute* attribute);
+
 	XmlAttribute sentinel;	/**< Comment me. */
+
+	std::vector<XmlAttribute*>	_index;		/**< Attributes in the set, for lookups without walking the list. */
+	AttributeTable				_table;		/**< Attributes keyed by the hash of their names. Only used by large sets. */
 };
 
 } // namespace Xml
@@ -11,13 +11,17 @@
 // ==================================================================================
 #pragma once
 
+#include "NAS2D/Xml/XmlString.h"
+
 #include <string>
 #include <vector>
 
 namespace NAS2D {
 namespace Xml {
 
+class XmlArena;
 class XmlAttribute;
+class XmlAttributeSet;
 class XmlComment;
 class XmlDocument;
 class XmlElement;
@@ -50,6 +54,8 @@ class XmlBase
 	friend class XmlNode;
 	friend class XmlElement;
 	friend class XmlDocument;
+	friend class XmlReader;
+	friend class XmlAttributeSet;
 
 public:
 	XmlBase() {}
@@ -101,19 +107,25 @@ protected:
 	static bool	streamWhiteSpace(std::istream& in, std::string& tag);
 	static bool streamTo(std::istream& in, int character, std::string& tag);
 
+	static const char* skipName(const char* p);
 	static const char* readName(const char* p, std::string& name);
+	static const char* readName(const char* p, XmlString& name, void* data);
 	static const char* readText(const char* in, std::string* text, bool ignoreWhiteSpace, const char* endTag, bool ignoreCase);
+	static const char* readText(const char* in, XmlString& text, bool ignoreWhiteSpace, const char* endTag, bool ignoreCase, void* data);
 	static const char* getEntity(const char* in, char* value, int* length);
 
 	inline static const char* getChar(const char* p, char* _value, int* length);
 
 	static bool stringEqual(const char* p, const char* endTag, bool ignoreCase);
+	static const char* findEndTag(const char* p, const char* endTag, bool ignoreCase);
 
 	static int isAlpha(unsigned char anyByte);
 	static int isAlphaNum(unsigned char anyByte);
 
 	inline static int toLower(int v) { return tolower(v); }
 
+	static void destroy(XmlBase* base, XmlArena* arena);
+
 protected:
 	std::pair<int, int> location;
 
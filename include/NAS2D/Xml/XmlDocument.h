@@ -2,6 +2,8 @@
 
 #include "NAS2D/Xml/XmlNode.h"
 
+#include "NAS2D/File.h"
+
 namespace NAS2D {
 namespace Xml {
 
@@ -17,9 +19,10 @@ public:
 	XmlDocument(const XmlDocument& copy);
 	XmlDocument& operator=(const XmlDocument& copy);
 
-	virtual ~XmlDocument() {}
+	virtual ~XmlDocument();
 
 	virtual const char* parse(const char* p, void* data = nullptr);
+	const char* parse(const File& file);
 
 	const XmlElement* rootElement() const;
 	XmlElement* rootElement();
@@ -32,6 +35,9 @@ public:
 
 	void clearError();
 
+	void arenaAllocation(bool enabled);
+	bool arenaAllocation() const;
+
 	virtual const XmlDocument* toDocument() const { return this; }
 	virtual XmlDocument* toDocument() { return this; }
 
@@ -46,8 +52,12 @@ protected:
 	virtual void streamIn(std::istream& in, std::string& tag);
 
 private:
+	friend class XmlNode;
+
 	void copyTo(XmlDocument* target) const;
 
+	const char* parse(const char* p, void* prevData, bool inSitu);
+
 private:
 	int					_errorId;
 
@@ -56,6 +66,11 @@ private:
 	std::string			_errorDesc;
 
 	std::pair<int, int>	_errorLocation;
+
+	bool				_arenaAllocation;	/**< Allocate parsed nodes from _arena. */
+	XmlArena*			_arena;				/**< Arena parsed nodes are allocated from. Created on first use. */
+
+	File				_source;			/**< File parsed in situ. Names and values of its nodes refer to its bytes. */
 };
 
 } // namespace Xml
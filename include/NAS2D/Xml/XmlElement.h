@@ -45,6 +45,8 @@ public:
 	const XmlAttribute* lastAttribute() const;
 	XmlAttribute* lastAttribute();
 
+	const XmlAttribute* findAttribute(const std::string& name, bool ignoreCase = false) const;
+
 	virtual XmlNode* clone() const;
 	
 	virtual void write(std::string& buf, int depth) const;
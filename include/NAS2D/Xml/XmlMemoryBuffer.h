@@ -16,6 +16,9 @@
 #include <string>
 
 namespace NAS2D {
+
+class FileStream;
+
 namespace Xml {
 
 /**
@@ -31,14 +34,33 @@ namespace Xml {
 *
 * Utility<Filesystem>::get().write(File(buff.buffer(), mConfigPath));
 * \endcode
+*
+* The size of a document is estimated and reserved before it's written so the
+* buffer doesn't have to grow while the document is written.
+*
+* An XmlMemoryBuffer can also write straight to a FileStream. The buffer is
+* written to the stream and emptied every time it grows past a given size, so
+* large documents never need to be held in memory all at once.
+*
+* \code{.cpp}
+* FileStream stream = Utility<Filesystem>::get().openWriteStream(mConfigPath, true, 0);
+* XmlMemoryBuffer buff(stream);
+* doc.accept(&buff);
+*
+* if (buff.error() || !stream.close()) { ... }
+* \endcode
+*
+* The XmlMemoryBuffer already writes in chunks so the stream is opened without
+* a buffer of its own.
 */
 class XmlMemoryBuffer : public XmlVisitor
 {
 public:
 	XmlMemoryBuffer();
+	XmlMemoryBuffer(FileStream& stream, size_t chunkSize = 65536);
 
-	virtual bool visitEnter(const XmlDocument& doc) { return true; }
-	virtual bool visitExit(const XmlDocument& doc) { return true; }
+	virtual bool visitEnter(const XmlDocument& doc);
+	virtual bool visitExit(const XmlDocument& doc);
 
 	virtual bool visitEnter(const XmlElement& element, const XmlAttribute* firstAttribute);
 	virtual bool visitExit(const XmlElement& element);
@@ -51,12 +73,26 @@ public:
 
 	const std::string& buffer();
 
+	void reserve(size_t size);
+
+	bool flush();
+	bool error() const;
+
+private:
+	void indent();
+	void lineBreak();
+
 private:
 	int depth;
 
 	std::string _buffer;
 	std::string _indent;
 	std::string _lineBreak;
+
+	FileStream*	_stream;		/**< Stream to write to or \c nullptr to keep the document in memory. */
+	size_t		_chunkSize;		/**< Size the buffer can grow to before it's written to the stream. */
+	size_t		_written;		/**< Number of bytes written to the stream so far. */
+	bool		_error;			/**< Whether writing to the stream failed. */
 };
 
 } // namespace Xml
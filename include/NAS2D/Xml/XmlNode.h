@@ -48,6 +48,8 @@ public:
 	const std::string& value() const;
 	void value(const std::string& value);
 
+	const XmlString& valueView() const;
+
 	void clear();
 
 	int type() const;
@@ -148,7 +150,9 @@ protected:
 	XmlNode(NodeType _type);
 
 	void copyTo(XmlNode* target) const;
-	XmlNode* identify(const char* start);
+	XmlNode* identify(const char* start, void* data = nullptr);
+
+	XmlArena* arena() const;
 
 protected:
 	XmlNode*		_parent;		/**< Parent of the XmlNode. */
@@ -157,7 +161,7 @@ protected:
 	XmlNode*		_firstChild;	/**< First child of the XmlNode. */
 	XmlNode*		_lastChild;		/**< Last child of the XmlNode. */
 
-	std::string		_value;			/**< Value of the XmlNode. */
+	XmlString		_value;			/**< Value of the XmlNode. */
 
 	XmlNode*		_prev;			/**< Previous XmlNode. */
 	XmlNode*		_next;			/**< Next XmlNode. */
@@ -0,0 +1,141 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright  2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// =
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#pragma once
+
+#include "NAS2D/Xml/XmlBase.h"
+
+#include <string>
+#include <vector>
+
+namespace NAS2D {
+
+class FileStream;
+
+namespace Xml {
+
+/**
+ * Pull reader that walks an XML document one node at a time without building
+ * a tree.
+ *
+ * Each call to read() advances to the next start element, end element or text
+ * node. Attributes are available while positioned on a start element. Comments,
+ * declarations and DTD's are skipped. Empty elements (<tag />) are reported as a
+ * start element followed by an end element.
+ *
+ * The reader can work on a null terminated buffer in memory or pull the document
+ * from a FileStream a chunk at a time.
+ *
+ * \code{.cpp}
+ * XmlReader reader(Utility<Filesystem>::get().openStream("data/config.xml"));
+ * while (reader.read())
+ * {
+ *	if (reader.type() == XmlReader::XML_READER_START_ELEMENT && reader.name() == "graphics")
+ *	{
+ *		std::cout << reader.attribute("screenwidth") << std::endl;
+ *	}
+ * }
+ *
+ * if (reader.error())
+ * {
+ *	std::cout << reader.errorDesc() << " Row: " << reader.errorRow() << std::endl;
+ * }
+ * \endcode
+ */
+class XmlReader
+{
+public:
+	/**
+	 * Kind of node the reader is positioned on.
+	 */
+	enum NodeType
+	{
+		XML_READER_NONE,
+		XML_READER_START_ELEMENT,
+		XML_READER_END_ELEMENT,
+		XML_READER_TEXT,
+		XML_READER_END_DOCUMENT
+	};
+
+public:
+	XmlReader(const char* buffer);
+	XmlReader(FileStream& stream, size_t chunkSize = 4096);
+	XmlReader(FileStream&& stream, size_t chunkSize = 4096);
+	~XmlReader();
+
+	bool read();
+
+	NodeType type() const;
+	const std::string& name() const;
+	const std::string& text() const;
+	bool emptyElement() const;
+	int depth() const;
+	int row() const;
+	int column() const;
+
+	int attributeCount() const;
+	const std::string& attributeName(int index) const;
+	const std::string& attributeValue(int index) const;
+	const std::string& attribute(const std::string& name) const;
+
+	bool error() const;
+	const std::string& errorDesc() const;
+	int errorId() const;
+	int errorRow() const;
+	int errorCol() const;
+
+private:
+	typedef std::pair<std::string, std::string> Attribute;
+
+private:
+	XmlReader(const XmlReader&); // Explicitly disallowed.
+	void operator=(const XmlReader&); // Explicitly disallowed.
+
+	void start(const char* buffer);
+
+	bool fetch();
+	const char* find(const char* endTag);
+	const char* findTagEnd();
+	void advance(const char* to);
+	bool skip(const char* endTag, XmlBase::XmlErrorCode err);
+
+	bool readStartElement();
+	bool readEndElement();
+	bool fail(XmlBase::XmlErrorCode err);
+
+private:
+	FileStream*					_stream;			/**< Stream to read from or \c nullptr when reading from memory. */
+	FileStream*					_ownedStream;		/**< Stream owned by the reader. */
+	size_t						_chunkSize;			/**< Number of bytes read from the stream at a time. */
+	bool						_streamDone;		/**< Whether all of the stream has been read. */
+	std::string					_buffer;			/**< Unread part of the stream. */
+
+	const char*					_p;					/**< Current read position. */
+	const char*					_end;				/**< End of the data available to read. */
+	std::pair<int, int>			_cursor;			/**< Row and column of the current read position. */
+
+	NodeType					_type;
+	std::string					_name;
+	std::string					_text;
+	bool						_emptyElement;
+	std::pair<int, int>			_location;			/**< Row and column of the current node. */
+
+	std::vector<Attribute>		_attributes;		/**< Attributes of the current start element. Entries past _attributeCount are kept for reuse. */
+	int							_attributeCount;
+
+	std::vector<std::string>	_openElements;		/**< Names of the elements that haven't been closed yet. */
+
+	bool						_error;
+	int							_errorId;
+	std::string					_errorDesc;
+	std::pair<int, int>			_errorLocation;
+};
+
+} // namespace Xml
+} // namespace NAS2D
@@ -0,0 +1,102 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright  2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// =
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <iosfwd>
+#include <new>
+#include <string>
+
+namespace NAS2D {
+namespace Xml {
+
+/**
+ * Holds the names and values of nodes and attributes.
+ *
+ * An XmlString either owns a \c std::string or is a view of characters owned
+ * by something else, like the arena or the source buffer of the XmlDocument
+ * the string belongs to. Views are turned into a \c std::string of their own
+ * the first time str() is called.
+ *
+ * \note	The characters returned by data() are not null terminated.
+ */
+class XmlString
+{
+public:
+	XmlString() : _owned(true) { new (&_storage.string) std::string(); }
+	XmlString(const std::string& string);
+	XmlString(const XmlString& other);
+	~XmlString() { if (_owned) { _storage.string.~basic_string(); } }
+
+	XmlString& operator=(const XmlString& other);
+	XmlString& operator=(const std::string& string);
+
+	void assign(const char* data, size_t size);
+	void assign(std::string&& string);
+	void view(const char* data, size_t size);
+	void clear();
+
+	const char* data() const { return _owned ? _storage.string.data() : _storage.view.data; }
+	size_t size() const { return _owned ? _storage.string.size() : _storage.view.size; }
+	bool empty() const { return size() == 0; }
+	bool isView() const { return !_owned; }
+
+	const std::string& str() const;
+
+	bool equals(const char* string, bool ignoreCase = false) const;
+	bool equals(const std::string& string, bool ignoreCase = false) const { return equalsRun(string.data(), string.size(), ignoreCase); }
+	bool equalsRun(const char* data, size_t size, bool ignoreCase = false) const { return size == this->size() && (ignoreCase ? equalsNoCase(data) : std::memcmp(this->data(), data, size) == 0); }
+
+	bool operator==(const XmlString& rhs) const { return equalsRun(rhs.data(), rhs.size()); }
+	bool operator==(const std::string& rhs) const { return equals(rhs); }
+	bool operator==(const char* rhs) const { return equals(rhs); }
+	bool operator!=(const XmlString& rhs) const { return !(*this == rhs); }
+	bool operator!=(const std::string& rhs) const { return !(*this == rhs); }
+	bool operator!=(const char* rhs) const { return !(*this == rhs); }
+	bool operator<(const XmlString& rhs) const;
+	bool operator>(const XmlString& rhs) const { return rhs < *this; }
+
+private:
+	bool equalsNoCase(const char* data) const;
+
+private:
+	/**
+	 * Characters owned by something else.
+	 */
+	struct View
+	{
+		const char*	data;
+		size_t		size;
+	};
+
+	/**
+	 * Either an owned string or a view. Only one is alive at a time.
+	 */
+	union Storage
+	{
+		Storage() {}
+		~Storage() {}
+
+		std::string	string;
+		View		view;
+	};
+
+private:
+	mutable Storage	_storage;	/**< The characters of the string. */
+	mutable bool	_owned;		/**< Indicates that _storage holds a std::string. */
+};
+
+
+std::ostream& operator<<(std::ostream& out, const XmlString& string);
+std::string& operator+=(std::string& out, const XmlString& string);
+
+} // namespace Xml
+} // namespace NAS2D
@@ -165,6 +165,36 @@ std::string NAS2D::toUppercase(const std::string& str)
 }
 
 
+/**
+ * \fn caseInsensitiveEqual(const std::string& a, const std::string& b)
+ *
+ * Compares two strings ignoring case. Unlike comparing the results of
+ * toLowercase(), no strings are allocated.
+ *
+ * \param a	First string.
+ * \param b	Second string.
+ *
+ * \return	Returns true if the strings are equal ignoring case.
+ */
+bool NAS2D::caseInsensitiveEqual(const std::string& a, const std::string& b)
+{
+	if (a.size() != b.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < a.size(); ++i)
+	{
+		if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i])))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
 /**
  * \fn clamp(int x, int a, int b)
  * 
@@ -14,6 +14,9 @@
 #include "NAS2D/Xml/Xml.h"
 
 #include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 using namespace NAS2D;
 using namespace NAS2D::Xml;
@@ -54,6 +57,12 @@ const std::string		GRAPHICS_CFG_FULLSCREEN		= "fullscreen";
 const std::string		GRAPHICS_CFG_VSYNC			= "vsync";
 
 
+// ==================================================================================
+// = UNEXPOSED FUNCTION PROTOTYPES
+// ==================================================================================
+void queryInt(const std::string& value, int& i);
+
+
 /**
  * C'tor
  */
@@ -67,7 +76,8 @@ Configuration::Configuration():	mScreenWidth(GRAPHICS_WIDTH),
 								mMusicVolume(AUDIO_MUSIC_VOLUME),
 								mBufferLength(AUDIO_BUFFER_SIZE),
 								mMixerName("SDL"),
-								mOptionChanged(false)
+								mOptionChanged(false),
+								mStreamingLoad(false)
 {}
 
 
@@ -114,10 +124,35 @@ void Configuration::load(const std::string& filePath)
 }
 
 
+/**
+ * Sets whether load() reads the configuration file with an XmlReader instead
+ * of building an XmlDocument. Off by default.
+ */
+void Configuration::streamingLoad(bool enabled)
+{
+	mStreamingLoad = enabled;
+}
+
+
+/**
+ * Gets whether load() reads the configuration file with an XmlReader.
+ */
+bool Configuration::streamingLoad() const
+{
+	return mStreamingLoad;
+}
+
+
 /**
  * Saves the Configuration to an XML file.
+ *
+ * The file is written to a temporary file first and renamed over the
+ * configuration file once it's complete so that a failed save leaves the
+ * previous configuration intact.
+ *
+ * \return	True on success, false otherwise.
  */
-void Configuration::save()
+bool Configuration::save()
 {
 	XmlDocument doc;
 
@@ -161,11 +196,30 @@ void Configuration::save()
 		options->linkEndChild(option);
 	}
 
-	// Write out the XML file.
-	XmlMemoryBuffer buff;
+	// Write out the XML file. XmlMemoryBuffer writes in chunks of its own so
+	// the stream doesn't need a buffer.
+	Filesystem& fs = Utility<Filesystem>::get();
+	std::string tempPath = mConfigPath + ".tmp";
+
+	FileStream stream = fs.openWriteStream(tempPath, true, 0);
+	if (!stream.isOpen())
+	{
+		std::cout << "Unable to open '" << tempPath << "' for writing." << std::endl;
+		return false;
+	}
+
+	XmlMemoryBuffer buff(stream);
 	doc.accept(&buff);
 
-	Utility<Filesystem>::get().write(File(buff.buffer(), mConfigPath));
+	bool written = !buff.error();
+	if (!stream.close() || !written)
+	{
+		std::cout << "Unable to write '" << mConfigPath << "'." << std::endl;
+		fs.del(tempPath);
+		return false;
+	}
+
+	return fs.rename(tempPath, mConfigPath);
 }
 
 
@@ -194,10 +248,15 @@ void Configuration::setDefaultValues()
  */
 bool Configuration::readConfig(const std::string& filePath)
 {
+	if (mStreamingLoad)
+	{
+		return readConfigStream(filePath);
+	}
+
 	File xmlFile = Utility<Filesystem>::get().open(filePath);
 
 	XmlDocument config;
-	config.parse(xmlFile.raw_bytes());
+	config.parse(xmlFile);
 	if (config.error())
 	{
 		std::cout << "Error parsing configuration file '" << filePath << "' on Row " << config.errorRow() << ", Column " << config.errorCol() << ": " << config.errorDesc() << std::endl;
@@ -217,9 +276,9 @@ bool Configuration::readConfig(const std::string& filePath)
 		XmlNode *xmlNode = nullptr;
 		while ((xmlNode = root->iterateChildren(xmlNode)))
 		{
-			if (xmlNode->value() == "graphics") { parseGraphics(xmlNode); }
-			else if (xmlNode->value() == "audio") { parseAudio(xmlNode); }
-			else if (xmlNode->value() == "options") { parseOptions(xmlNode); }
+			if (xmlNode->valueView() == "graphics") { parseGraphics(xmlNode); }
+			else if (xmlNode->valueView() == "audio") { parseAudio(xmlNode); }
+			else if (xmlNode->valueView() == "options") { parseOptions(xmlNode); }
 			else if (xmlNode->type() == XmlNode::XML_COMMENT) {} // Ignore comments
 			else
 			{
@@ -253,18 +312,30 @@ void Configuration::parseGraphics(void* _n)
 	XmlAttribute* attribute = element->firstAttribute();
 	while (attribute)
 	{
-		if (attribute->name() == GRAPHICS_CFG_SCREEN_WIDTH) { attribute->queryIntValue(mScreenWidth); }
-		else if (attribute->name() == GRAPHICS_CFG_SCREEN_HEIGHT) { attribute->queryIntValue(mScreenHeight); }
-		else if (attribute->name() == GRAPHICS_CFG_SCREEN_DEPTH) { attribute->queryIntValue(mScreenBpp); }
-		else if (attribute->name() == GRAPHICS_CFG_FULLSCREEN) { fullscreen(toLowercase(attribute->value()) == "true"); }
-		else if (attribute->name() == GRAPHICS_CFG_VSYNC) { vsync(toLowercase(attribute->value()) == "true"); }
-		else { std::cout << "Unexpected attribute '" << attribute->name() << "' found in '" << element->value() << "'." << std::endl; }
-
+		graphicsAttribute(attribute->name(), attribute->value(), element->value());
 		attribute = attribute->next();
 	}
 }
 
 
+/**
+ * Sets a graphics option from an attribute of the <graphics> tag.
+ *
+ * \param	name	Name of the attribute.
+ * \param	value	Value of the attribute.
+ * \param	element	Name of the element the attribute was found in.
+ */
+void Configuration::graphicsAttribute(const std::string& name, const std::string& value, const std::string& element)
+{
+	if (name == GRAPHICS_CFG_SCREEN_WIDTH) { queryInt(value, mScreenWidth); }
+	else if (name == GRAPHICS_CFG_SCREEN_HEIGHT) { queryInt(value, mScreenHeight); }
+	else if (name == GRAPHICS_CFG_SCREEN_DEPTH) { queryInt(value, mScreenBpp); }
+	else if (name == GRAPHICS_CFG_FULLSCREEN) { fullscreen(toLowercase(value) == "true"); }
+	else if (name == GRAPHICS_CFG_VSYNC) { vsync(toLowercase(value) == "true"); }
+	else { std::cout << "Unexpected attribute '" << name << "' found in '" << element << "'." << std::endl; }
+}
+
+
 /**
  * Parses audio information from an XML node.
  * 
@@ -287,61 +358,75 @@ void Configuration::parseAudio(void* _n)
 	XmlAttribute* attribute = element->firstAttribute();
 	while (attribute)
 	{
-		if (attribute->name() == AUDIO_CFG_MIXRATE)
+		audioAttribute(attribute->name(), attribute->value(), element->value());
+		attribute = attribute->next();
+	}
+}
+
+
+/**
+ * Sets an audio option from an attribute of the <audio> tag.
+ *
+ * \param	name	Name of the attribute.
+ * \param	value	Value of the attribute.
+ * \param	element	Name of the element the attribute was found in.
+ *
+ * \note	If the value is invalid, this function will set a default value.
+ */
+void Configuration::audioAttribute(const std::string& name, const std::string& value, const std::string& element)
+{
+	if (name == AUDIO_CFG_MIXRATE)
+	{
+		queryInt(value, mMixRate);
+		if (mMixRate != AUDIO_LOW_QUALITY && mMixRate != AUDIO_MEDIUM_QUALITY && mMixRate != AUDIO_HIGH_QUALITY)
 		{
-			attribute->queryIntValue(mMixRate);
-			if (mMixRate != AUDIO_LOW_QUALITY && mMixRate != AUDIO_MEDIUM_QUALITY && mMixRate != AUDIO_HIGH_QUALITY)
-			{
-				std::cout << "Invalid audio mixrate setting '" << mMixRate << "'. Expected 11025, 22050 or 44100. Setting to default of 22050." << std::endl;
-				audioMixRate(AUDIO_MEDIUM_QUALITY);
-			}
+			std::cout << "Invalid audio mixrate setting '" << mMixRate << "'. Expected 11025, 22050 or 44100. Setting to default of 22050." << std::endl;
+			audioMixRate(AUDIO_MEDIUM_QUALITY);
 		}
-		else if (attribute->name() == AUDIO_CFG_CHANNELS)
-		{
-			attribute->queryIntValue(mStereoChannels);
+	}
+	else if (name == AUDIO_CFG_CHANNELS)
+	{
+		queryInt(value, mStereoChannels);
 
-			if (mStereoChannels != AUDIO_MONO && mStereoChannels != AUDIO_STEREO)
-			{
-				std::cout << "Invalid audio channels setting '" << mStereoChannels << "'. Expected 1 or 2. Setting to default of 2." << std::endl;
-				audioStereoChannels(AUDIO_STEREO);
-			}
-		}
-		else if (attribute->name() == AUDIO_CFG_SFX_VOLUME)
+		if (mStereoChannels != AUDIO_MONO && mStereoChannels != AUDIO_STEREO)
 		{
-			attribute->queryIntValue(mSfxVolume);
-
-			if (mSfxVolume < AUDIO_SFX_MIN_VOLUME || mSfxVolume > AUDIO_SFX_MAX_VOLUME)
-			{
-				audioSfxVolume(clamp(mSfxVolume, AUDIO_SFX_MIN_VOLUME, AUDIO_SFX_MAX_VOLUME));
-			}
+			std::cout << "Invalid audio channels setting '" << mStereoChannels << "'. Expected 1 or 2. Setting to default of 2." << std::endl;
+			audioStereoChannels(AUDIO_STEREO);
 		}
-		else if (attribute->name() == AUDIO_CFG_MUS_VOLUME)
-		{
-			attribute->queryIntValue(mMusicVolume);
+	}
+	else if (name == AUDIO_CFG_SFX_VOLUME)
+	{
+		queryInt(value, mSfxVolume);
 
-			if (mMusicVolume < AUDIO_SFX_MIN_VOLUME || mMusicVolume > AUDIO_SFX_MAX_VOLUME)
-			{
-				audioSfxVolume(clamp(mMusicVolume, AUDIO_SFX_MIN_VOLUME, AUDIO_SFX_MAX_VOLUME));
-			}
-		}
-		else if (attribute->name() == AUDIO_CFG_BUFFER_SIZE)
+		if (mSfxVolume < AUDIO_SFX_MIN_VOLUME || mSfxVolume > AUDIO_SFX_MAX_VOLUME)
 		{
-			attribute->queryIntValue(mBufferLength);
-			if (mBufferLength < AUDIO_BUFFER_MIN_SIZE || mBufferLength > AUDIO_BUFFER_MAX_SIZE)
-			{
-				audioBufferSize(clamp(mBufferLength, AUDIO_BUFFER_MIN_SIZE, AUDIO_BUFFER_MAX_SIZE));
-			}
+			audioSfxVolume(clamp(mSfxVolume, AUDIO_SFX_MIN_VOLUME, AUDIO_SFX_MAX_VOLUME));
 		}
-		else if (attribute->name() == AUDIO_CFG_MIXER)
+	}
+	else if (name == AUDIO_CFG_MUS_VOLUME)
+	{
+		queryInt(value, mMusicVolume);
+
+		if (mMusicVolume < AUDIO_SFX_MIN_VOLUME || mMusicVolume > AUDIO_SFX_MAX_VOLUME)
 		{
-			mMixerName = attribute->value();
+			audioSfxVolume(clamp(mMusicVolume, AUDIO_SFX_MIN_VOLUME, AUDIO_SFX_MAX_VOLUME));
 		}
-		else
+	}
+	else if (name == AUDIO_CFG_BUFFER_SIZE)
+	{
+		queryInt(value, mBufferLength);
+		if (mBufferLength < AUDIO_BUFFER_MIN_SIZE || mBufferLength > AUDIO_BUFFER_MAX_SIZE)
 		{
-			std::cout << "Unexpected attribute '" << attribute->name() << "' found in '" << element->value() << "'." << std::endl;
+			audioBufferSize(clamp(mBufferLength, AUDIO_BUFFER_MIN_SIZE, AUDIO_BUFFER_MAX_SIZE));
 		}
-
-		attribute = attribute->next();
+	}
+	else if (name == AUDIO_CFG_MIXER)
+	{
+		mMixerName = value;
+	}
+	else
+	{
+		std::cout << "Unexpected attribute '" << name << "' found in '" << element << "'." << std::endl;
 	}
 }
 
@@ -366,43 +451,158 @@ void Configuration::parseOptions(void* _n)
 	XmlNode *node = nullptr;
 	while ((node = element->iterateChildren(node)))
 	{
-		if (node->value() == "option")
+		if (node->valueView() == "option")
 		{
 			XmlAttribute* attribute = node->toElement()->firstAttribute();
 
 			std::string name, value;
 			while (attribute)
 			{
-				if (attribute->name() == "name")
-				{
-					name = attribute->value();
-				}
-				else if (attribute->name() == "value")
-				{
-					value = attribute->value();
-				}
-				else
-				{
-					std::cout << "Unexpected attribute '" << attribute->name() << "' found in '" << element->value() << "'." << std::endl;
-				}
+				if (attribute->nameView() == "name") { name = attribute->value(); }
+				else if (attribute->nameView() == "value") { value = attribute->value(); }
+				else { std::cout << "Unexpected attribute '" << attribute->name() << "' found in '" << element->value() << "'." << std::endl; }
 
 				attribute = attribute->next();
 			}
 
-			if (name.empty() || value.empty())
+			addOption(name, value, node->row());
+		}
+		else
+		{
+			std::cout << "Unexpected tag '<" << node->value() << ">' found in configuration on row " << node->row() << "." << std::endl;
+		}
+	}
+}
+
+
+/**
+ * Adds a name/value pair read from an <option> tag to the options table.
+ *
+ * \param	name	Name of the option.
+ * \param	value	Value of the option.
+ * \param	row		Row of the <option> tag (for error information).
+ */
+void Configuration::addOption(const std::string& name, const std::string& value, int row)
+{
+	if (name.empty() || value.empty())
+	{
+		std::cout << "Invalid name/value pair in <option> tag in configuration file on row " << row << ". This option will be ignored." << std::endl;
+	}
+	else
+	{
+		mOptions[name] = value;
+	}
+}
+
+
+/**
+ * Reads a configuration file with an XmlReader instead of building an XmlDocument.
+ *
+ * Settings are collected while reading and only applied once the whole file
+ * has been read without error so that, like readConfig(), a file with a syntax
+ * error leaves the Configuration unchanged.
+ */
+bool Configuration::readConfigStream(const std::string& filePath)
+{
+	typedef std::pair<std::string, std::string> Setting;
+
+	// An <option> tag read from the file.
+	struct PendingOption
+	{
+		std::string name;
+		std::string value;
+		int row;
+	};
+
+	std::vector<Setting> graphics;
+	std::vector<Setting> audio;
+	std::vector<PendingOption> options;
+
+	XmlReader reader(Utility<Filesystem>::get().openStream(filePath));
+
+	bool foundRoot = false;
+	bool inRoot = false;
+	bool inOptions = false;
+
+	while (reader.read())
+	{
+		if (reader.type() == XmlReader::XML_READER_END_ELEMENT)
+		{
+			if (reader.depth() == 0) { inRoot = false; }
+			else if (reader.depth() == 1) { inOptions = false; }
+			continue;
+		}
+
+		if (reader.depth() == 0)
+		{
+			if (reader.type() == XmlReader::XML_READER_START_ELEMENT && reader.name() == "configuration" && !foundRoot)
+			{
+				foundRoot = inRoot = true;
+			}
+		}
+		else if (inRoot && reader.depth() == 1)
+		{
+			if (reader.type() == XmlReader::XML_READER_TEXT)
 			{
-				std::cout << "Invalid name/value pair in <option> tag in configuration file on row " << node->row() << ". This option will be ignored." << std::endl;
+				std::cout << "Unexpected tag '<" << reader.text() << ">' found in '" << filePath << "' on row " << reader.row() << "." << std::endl;
+			}
+			else if (reader.name() == "graphics")
+			{
+				for (int i = 0; i < reader.attributeCount(); ++i) { graphics.push_back(Setting(reader.attributeName(i), reader.attributeValue(i))); }
+			}
+			else if (reader.name() == "audio")
+			{
+				for (int i = 0; i < reader.attributeCount(); ++i) { audio.push_back(Setting(reader.attributeName(i), reader.attributeValue(i))); }
+			}
+			else if (reader.name() == "options")
+			{
+				inOptions = true;
 			}
 			else
 			{
-				mOptions[name] = value;
+				std::cout << "Unexpected tag '<" << reader.name() << ">' found in '" << filePath << "' on row " << reader.row() << "." << std::endl;
 			}
 		}
-		else
+		else if (inOptions && reader.depth() == 2)
 		{
-			std::cout << "Unexpected tag '<" << node->value() << ">' found in configuration on row " << node->row() << "." << std::endl;
+			if (reader.type() == XmlReader::XML_READER_START_ELEMENT && reader.name() == "option")
+			{
+				PendingOption option;
+				option.row = reader.row();
+				for (int i = 0; i < reader.attributeCount(); ++i)
+				{
+					if (reader.attributeName(i) == "name") { option.name = reader.attributeValue(i); }
+					else if (reader.attributeName(i) == "value") { option.value = reader.attributeValue(i); }
+					else { std::cout << "Unexpected attribute '" << reader.attributeName(i) << "' found in 'options'." << std::endl; }
+				}
+
+				options.push_back(option);
+			}
+			else
+			{
+				const std::string& tag = reader.type() == XmlReader::XML_READER_TEXT ? reader.text() : reader.name();
+				std::cout << "Unexpected tag '<" << tag << ">' found in configuration on row " << reader.row() << "." << std::endl;
+			}
 		}
 	}
+
+	if (reader.error())
+	{
+		std::cout << "Error parsing configuration file '" << filePath << "' on Row " << reader.errorRow() << ", Column " << reader.errorCol() << ": " << reader.errorDesc() << std::endl;
+		return false;
+	}
+
+	if (!foundRoot)
+	{
+		std::cout << "'" << filePath << "' doesn't contain a '<configuration>' tag." << std::endl;
+		return false;
+	}
+
+	for (const Setting& setting : graphics) { graphicsAttribute(setting.first, setting.second, "graphics"); }
+	for (const Setting& setting : audio) { audioAttribute(setting.first, setting.second, "audio"); }
+	for (const PendingOption& option : options) { addOption(option.name, option.value, option.row); }
+
+	return true;
 }
 
 
@@ -715,3 +915,22 @@ void Configuration::deleteOption(const std::string& option)
 		mOptionChanged = true;
 	}
 }
+
+
+// ==================================================================================
+// = Unexposed module-level functions defined here that don't need to be part of the
+// = API interface.
+// ==================================================================================
+
+/**
+ * Converts a string to an int. Leaves \c i unchanged if the string isn't a number.
+ */
+void queryInt(const std::string& value, int& i)
+{
+	try
+	{
+		i = std::stoi(value);
+	}
+	catch (const std::invalid_argument&)
+	{}
+}
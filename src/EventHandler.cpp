@@ -12,9 +12,12 @@
 #include <SDL.h>
 
 // UGLY ASS HACK for mouse window grabbing
+#include "NAS2D/Profiler.h"
 #include "NAS2D/Renderer/OGL_Renderer.h"
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
 
 // UGLY ASS HACK!
 // This is required for mouse grabbing in the EventHandler class.
@@ -30,18 +33,31 @@ const int MAX_MESSAGE_PROCESSING = 100;	/**
 										 * \todo	Make this configurable?
 										 */
 
+const int DEFAULT_USER_EVENT_BUDGET = 256;	/**< Default maximum number of user events to dispatch each frame. */
+
 /**
  * Default c'tor.
  */
-EventHandler::EventHandler()
+EventHandler::EventHandler():	mUserEventHead(&mUserEventStub),
+								mUserEventTail(&mUserEventStub),
+								mUserEventCount(0),
+								mUserEventBudget(DEFAULT_USER_EVENT_BUDGET)
 {}
 
 
 /**
  * Default d'tor.
+ *
+ * \note	User events that haven't been dispatched are discarded.
  */
 EventHandler::~EventHandler()
 {
+	UserEvent* event = nullptr;
+	while ((event = popUserEvent()))
+	{
+		delete event;
+	}
+
 	cout << "EventHandler Terminated." << endl;
 }
 
@@ -508,6 +524,8 @@ void EventHandler::mouseRelativeMode(bool rel)
  */
 void EventHandler::pump()
 {
+	NAS2D_PROFILE_ZONE("EventHandler::pump");
+
 	SDL_Event event;
 
 	int count = 0;
@@ -593,6 +611,131 @@ void EventHandler::pump()
 		}
 		count++;
 	}
+
+	// Only events already queued are dispatched. Anything posted while these
+	// are dispatched, e.g. by a slot that posts again, waits for the next pump.
+	// The queue is FIFO so the first 'pending' events out are the ones counted.
+	int pending = std::min(mUserEventCount.load(std::memory_order_acquire), mUserEventBudget);
+	for (int i = 0; i < pending; ++i)
+	{
+		std::unique_ptr<UserEvent> event(popUserEvent());
+		if (!event)
+		{
+			break;
+		}
+
+		mUserEventCount.fetch_sub(1, std::memory_order_relaxed);
+		event->dispatch();
+	}
+}
+
+
+/**
+ * Posts a user event that emits a Signal on the main thread the next time
+ * pump() is called. Can be called from any thread.
+ *
+ * \param	signal	Signal to emit. Must outlive the event.
+ *
+ * \note	The EventHandler must be created on the main thread before any
+ *			other thread posts to it.
+ */
+void EventHandler::post(Signals::Signal0<>& signal)
+{
+	postUserEvent(new SignalEvent0(signal));
+}
+
+
+/**
+ * Sets the maximum number of user events dispatched by each call to pump().
+ * Events beyond the budget are dispatched by later calls. Default is 256.
+ *
+ * \note	pump() never dispatches more events than were queued when it
+ *			started, even when the budget allows more.
+ */
+void EventHandler::userEventBudget(int count)
+{
+	mUserEventBudget = count;
+}
+
+
+/**
+ * Gets the maximum number of user events dispatched by each call to pump().
+ */
+int EventHandler::userEventBudget() const
+{
+	return mUserEventBudget;
+}
+
+
+/**
+ * Adds a user event to the queue. Takes ownership of the event.
+ *
+ * The queue is a lock free, intrusive, multiple producer/single consumer
+ * linked list. Producers swap themselves in as the head and then link the
+ * previous head to themselves. The consumer follows the links from the tail.
+ */
+void EventHandler::postUserEvent(UserEvent* event)
+{
+	event->next.store(nullptr, std::memory_order_relaxed);
+	UserEvent* previous = mUserEventHead.exchange(event, std::memory_order_acq_rel);
+	previous->next.store(event, std::memory_order_release);
+
+	// Counted only once linked so pump() never waits on a half posted event.
+	if (event != &mUserEventStub)
+	{
+		mUserEventCount.fetch_add(1, std::memory_order_release);
+	}
+}
+
+
+/**
+ * Takes the oldest user event out of the queue. Only called from pump() and
+ * the d'tor.
+ *
+ * \return	The event, which the caller then owns, or \c nullptr if the queue
+ *			is empty or the next event is still being posted.
+ */
+EventHandler::UserEvent* EventHandler::popUserEvent()
+{
+	UserEvent* tail = mUserEventTail;
+	UserEvent* next = tail->next.load(std::memory_order_acquire);
+
+	// Step over the stub.
+	if (tail == &mUserEventStub)
+	{
+		if (!next)
+		{
+			return nullptr;
+		}
+
+		mUserEventTail = next;
+		tail = next;
+		next = next->next.load(std::memory_order_acquire);
+	}
+
+	if (next)
+	{
+		mUserEventTail = next;
+		return tail;
+	}
+
+	// A producer has swapped in a new head but not linked it yet.
+	if (tail != mUserEventHead.load(std::memory_order_acquire))
+	{
+		return nullptr;
+	}
+
+	// tail is the last event. Put the stub behind it so it can be taken.
+	postUserEvent(&mUserEventStub);
+
+	next = tail->next.load(std::memory_order_acquire);
+	if (next)
+	{
+		mUserEventTail = next;
+		return tail;
+	}
+
+	return nullptr;
 }
 
 
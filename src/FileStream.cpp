@@ -0,0 +1,380 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright © 2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// =
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+
+#include "NAS2D/FileStream.h"
+
+#include <physfs.h>
+#include <SDL.h>
+
+#include <algorithm>
+#include <climits>
+#include <iostream>
+
+using namespace NAS2D;
+
+
+// ==================================================================================
+// = UNEXPOSED FUNCTION PROTOTYPES
+// ==================================================================================
+Sint64 rwopsSize(SDL_RWops* context);
+Sint64 rwopsSeek(SDL_RWops* context, Sint64 offset, int whence);
+size_t rwopsRead(SDL_RWops* context, void* ptr, size_t size, size_t maxnum);
+size_t rwopsWrite(SDL_RWops* context, const void* ptr, size_t size, size_t num);
+int rwopsClose(SDL_RWops* context);
+
+
+/**
+ * Default c'tor. Creates a FileStream that isn't open.
+ */
+FileStream::FileStream(): mHandle(nullptr)
+{}
+
+
+/**
+ * C'tor.
+ *
+ * \param	handle	Handle to a PHYSFS_File opened for reading. The FileStream takes ownership of the handle.
+ * \param	name	The full name of the file including path.
+ *
+ * \note	Use Filesystem::openStream() instead of constructing FileStreams directly.
+ */
+FileStream::FileStream(void* handle, const std::string& name): mHandle(handle), mFileName(name)
+{}
+
+
+/**
+ * Move c'tor.
+ */
+FileStream::FileStream(FileStream&& other) noexcept: mHandle(other.mHandle), mFileName(std::move(other.mFileName))
+{
+	other.mHandle = nullptr;
+}
+
+
+/**
+ * D'tor.
+ */
+FileStream::~FileStream()
+{
+	close();
+}
+
+
+/**
+ * Move assignment operator.
+ */
+FileStream& FileStream::operator=(FileStream&& other) noexcept
+{
+	if (this == &other) { return *this; }
+
+	close();
+
+	mHandle = other.mHandle;
+	mFileName = std::move(other.mFileName);
+	other.mHandle = nullptr;
+
+	return *this;
+}
+
+
+/**
+ * Gets whether the FileStream is open.
+ */
+bool FileStream::isOpen() const
+{
+	return mHandle != nullptr;
+}
+
+
+/**
+ * Closes the FileStream. Bytes still in the write buffer are written first.
+ *
+ * \return	False if the buffered bytes couldn't be written or the file couldn't
+ *			be closed. The FileStream is closed either way. True if the
+ *			FileStream wasn't open.
+ */
+bool FileStream::close()
+{
+	if (!mHandle) { return true; }
+
+	bool closed = PHYSFS_close(static_cast<PHYSFS_File*>(mHandle)) != 0;
+	if (!closed)
+	{
+		std::cout << "Unable to close '" << mFileName << "'. " << PHYSFS_getLastError() << "." << std::endl;
+	}
+
+	mHandle = nullptr;
+	return closed;
+}
+
+
+/**
+ * Writes any bytes held in the write buffer to the file.
+ *
+ * \return	True on success, false otherwise.
+ */
+bool FileStream::flush()
+{
+	if (!mHandle) { return false; }
+	return PHYSFS_flush(static_cast<PHYSFS_File*>(mHandle)) != 0;
+}
+
+
+/**
+ * Reads bytes from the current position of the FileStream.
+ *
+ * \param	buffer	Buffer to read into.
+ * \param	size	Number of bytes to read.
+ *
+ * \return	Number of bytes read. Less than \c size at the end of the file or on error.
+ */
+size_t FileStream::read(void* buffer, size_t size)
+{
+	if (!mHandle) { return 0; }
+
+	// PhysFS reads at most 4 GiB at a time.
+	size_t total = 0;
+	while (total < size)
+	{
+		PHYSFS_uint32 count = static_cast<PHYSFS_uint32>(std::min<size_t>(size - total, UINT_MAX));
+		PHYSFS_sint64 bytesRead = PHYSFS_read(static_cast<PHYSFS_File*>(mHandle), static_cast<char*>(buffer) + total, 1, count);
+		if (bytesRead <= 0) { break; }
+
+		total += static_cast<size_t>(bytesRead);
+		if (static_cast<PHYSFS_uint32>(bytesRead) < count) { break; }
+	}
+
+	return total;
+}
+
+
+/**
+ * Writes bytes at the current position of the FileStream.
+ *
+ * \param	buffer	Bytes to write.
+ * \param	size	Number of bytes to write.
+ *
+ * \return	Number of bytes written. Less than \c size on error.
+ *
+ * \note	Only FileStreams opened with Filesystem::openWriteStream() can be written to.
+ */
+size_t FileStream::write(const void* buffer, size_t size)
+{
+	if (!mHandle) { return 0; }
+
+	// PhysFS writes at most 4 GiB at a time.
+	size_t total = 0;
+	while (total < size)
+	{
+		PHYSFS_uint32 count = static_cast<PHYSFS_uint32>(std::min<size_t>(size - total, UINT_MAX));
+		PHYSFS_sint64 bytesWritten = PHYSFS_write(static_cast<PHYSFS_File*>(mHandle), static_cast<const char*>(buffer) + total, 1, count);
+		if (bytesWritten <= 0) { break; }
+
+		total += static_cast<size_t>(bytesWritten);
+		if (static_cast<PHYSFS_uint32>(bytesWritten) < count) { break; }
+	}
+
+	return total;
+}
+
+
+/**
+ * Moves the read position of the FileStream.
+ *
+ * \param	position	Offset, in bytes, from the beginning of the file.
+ *
+ * \return	True on success, false otherwise.
+ */
+bool FileStream::seek(unsigned long long position)
+{
+	if (!mHandle) { return false; }
+	return PHYSFS_seek(static_cast<PHYSFS_File*>(mHandle), position) != 0;
+}
+
+
+/**
+ * Gets the read position of the FileStream in bytes from the beginning of the file.
+ */
+unsigned long long FileStream::tell() const
+{
+	if (!mHandle) { return 0; }
+
+	PHYSFS_sint64 position = PHYSFS_tell(static_cast<PHYSFS_File*>(mHandle));
+	return position < 0 ? 0 : static_cast<unsigned long long>(position);
+}
+
+
+/**
+ * Gets the size, in bytes, of the file.
+ */
+unsigned long long FileStream::size() const
+{
+	if (!mHandle) { return 0; }
+
+	PHYSFS_sint64 length = PHYSFS_fileLength(static_cast<PHYSFS_File*>(mHandle));
+	return length < 0 ? 0 : static_cast<unsigned long long>(length);
+}
+
+
+/**
+ * Gets whether the read position is at the end of the file.
+ */
+bool FileStream::eof() const
+{
+	if (!mHandle) { return true; }
+	return PHYSFS_eof(static_cast<PHYSFS_File*>(mHandle)) != 0;
+}
+
+
+/**
+ * Sets the size of the read buffer.
+ *
+ * \param	size	Size, in bytes, of the buffer. 0 disables buffering.
+ *
+ * \return	True on success, false otherwise.
+ */
+bool FileStream::bufferSize(size_t size)
+{
+	if (!mHandle) { return false; }
+	return PHYSFS_setBuffer(static_cast<PHYSFS_File*>(mHandle), size) != 0;
+}
+
+
+/**
+ * Moves the FileStream into a new \c SDL_RWops.
+ *
+ * The FileStream is closed after this call. The file is closed when the
+ * \c SDL_RWops is closed, either with \c SDL_RWclose() or by a function that
+ * is passed a non-zero \c freesrc parameter.
+ *
+ * \code{.cpp}
+ * FileStream stream = Utility<Filesystem>::get().openStream("music/theme.ogg");
+ * Mix_Music* music = Mix_LoadMUS_RW(static_cast<SDL_RWops*>(stream.rwops()), 1);
+ * \endcode
+ *
+ * \return	Pointer to an \c SDL_RWops or \c nullptr if the FileStream isn't open.
+ */
+void* FileStream::rwops()
+{
+	if (!mHandle) { return nullptr; }
+
+	SDL_RWops* rw = SDL_AllocRW();
+	if (!rw)
+	{
+		std::cout << "FileStream::rwops(): " << SDL_GetError() << std::endl;
+		return nullptr;
+	}
+
+	rw->size = rwopsSize;
+	rw->seek = rwopsSeek;
+	rw->read = rwopsRead;
+	rw->write = rwopsWrite;
+	rw->close = rwopsClose;
+	rw->type = SDL_RWOPS_UNKNOWN;
+	rw->hidden.unknown.data1 = new FileStream(std::move(*this));
+
+	return rw;
+}
+
+
+/**
+ * Gets the file name.
+ *
+ * \note	Filenames include both the individual file's
+ *			name and full directory path.
+ */
+const std::string& FileStream::filename() const
+{
+	return mFileName;
+}
+
+
+// ==================================================================================
+// = Unexposed module-level functions defined here that don't need to be part of the
+// = API interface.
+// ==================================================================================
+
+/**
+ * SDL_RWops size callback.
+ */
+Sint64 rwopsSize(SDL_RWops* context)
+{
+	return static_cast<Sint64>(static_cast<FileStream*>(context->hidden.unknown.data1)->size());
+}
+
+
+/**
+ * SDL_RWops seek callback.
+ */
+Sint64 rwopsSeek(SDL_RWops* context, Sint64 offset, int whence)
+{
+	FileStream* stream = static_cast<FileStream*>(context->hidden.unknown.data1);
+
+	Sint64 position = offset;
+	switch (whence)
+	{
+	case RW_SEEK_SET:
+		break;
+	case RW_SEEK_CUR:
+		position += static_cast<Sint64>(stream->tell());
+		break;
+	case RW_SEEK_END:
+		position += static_cast<Sint64>(stream->size());
+		break;
+	default:
+		return -1;
+	}
+
+	if (position < 0 || !stream->seek(static_cast<unsigned long long>(position)))
+	{
+		return -1;
+	}
+
+	return position;
+}
+
+
+/**
+ * SDL_RWops read callback.
+ */
+size_t rwopsRead(SDL_RWops* context, void* ptr, size_t size, size_t maxnum)
+{
+	if (size == 0) { return 0; }
+
+	FileStream* stream = static_cast<FileStream*>(context->hidden.unknown.data1);
+	return stream->read(ptr, size * maxnum) / size;
+}
+
+
+/**
+ * SDL_RWops write callback.
+ */
+size_t rwopsWrite(SDL_RWops* context, const void* ptr, size_t size, size_t num)
+{
+	if (size == 0) { return 0; }
+
+	FileStream* stream = static_cast<FileStream*>(context->hidden.unknown.data1);
+	return stream->write(ptr, size * num) / size;
+}
+
+
+/**
+ * SDL_RWops close callback. Closes and frees the FileStream.
+ */
+int rwopsClose(SDL_RWops* context)
+{
+	if (context)
+	{
+		delete static_cast<FileStream*>(context->hidden.unknown.data1);
+		SDL_FreeRW(context);
+	}
+
+	return 0;
+}
@@ -17,17 +17,43 @@
 #include <CoreFoundation/CoreFoundation.h>
 #endif
 
+#if defined(WINDOWS)
+#include <windows.h>
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include <climits>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <mutex>
 
 using namespace NAS2D;
 using namespace NAS2D::Exception;
 
 bool FILESYSTEM_INITIALIZED = false;
 
+/**
+ * Files smaller than this are read into memory instead of being mapped. Mapping
+ * has a fixed cost that isn't worth paying for small files.
+ */
+const size_t MAP_THRESHOLD = 64 * 1024;
+
+
+// ==================================================================================
+// = UNEXPOSED FUNCTION PROTOTYPES
+// ==================================================================================
+File::BufferPtr mapFile(const std::string& filename, const std::string& dirSeparator, size_t length);
+
 
 /**
  * Default c'tor.
@@ -222,12 +248,64 @@ bool Filesystem::del(const std::string& filename) const
 }
 
 
+/**
+ * Renames a file in the write directory, replacing any file that already
+ * has the new name.
+ *
+ * Renaming a fully written temporary file over another is how a file can be
+ * replaced without leaving a truncated copy behind if writing fails.
+ *
+ * \param	from	Path of the file to rename relative to the write directory.
+ * \param	to		New path of the file relative to the write directory.
+ *
+ * \return	Returns \c true if successful. Otherwise, returns \c false.
+ */
+bool Filesystem::rename(const std::string& from, const std::string& to) const
+{
+	if (!FILESYSTEM_INITIALIZED) { throw filesystem_not_initialized(); }
+
+	// PhysFS can't rename files so this goes through the native filesystem.
+	const char* writeDir = PHYSFS_getWriteDir();
+	if (!writeDir)
+	{
+		std::cout << "Unable to rename '" << from << "': No write directory is set." << std::endl;
+		return false;
+	}
+
+	std::string source = std::string(writeDir) + mDirSeparator + from;
+	std::string destination = std::string(writeDir) + mDirSeparator + to;
+
+#if defined(WINDOWS)
+	bool renamed = MoveFileExA(source.c_str(), destination.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	bool renamed = std::rename(source.c_str(), destination.c_str()) == 0;
+#endif
+
+	if (!renamed)
+	{
+		std::cout << "Unable to rename '" << from << "' to '" << to << "'." << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+
 /**
  * Opens a file.
  *
  * \param filename	Path of the file to load.
  *
  * \return Returns a File.
+ *
+ * \note	Large files in a directory on the native filesystem are mapped into
+ *			memory instead of being read. The mapping stays valid for as long as
+ *			any copy of the File lives. If the file on disk is truncated or
+ *			rewritten in the meantime, reading the File may see the new bytes or
+ *			crash with SIGBUS. For this reason, files in the write directory are
+ *			always read and never mapped, because Filesystem::write() and
+ *			openWriteStream() can change them. Files outside the write directory
+ *			must not be modified by other processes while they're open.
  */
 File Filesystem::open(const std::string& filename) const
 {
@@ -252,22 +330,32 @@ File Filesystem::open(const std::string& filename) const
 		return File();
 	}
 
-	// Create a char* buffer large enough to hold the entire file.
 	PHYSFS_uint32 fileLength = static_cast<PHYSFS_uint32>(len);
-	char *fileBuffer = new char[fileLength + 1];
 
-	// If we read less then the file length, return an empty File object, log a message and free any used memory.
-	if (PHYSFS_read(myFile, fileBuffer, sizeof(char), fileLength) < fileLength)
+	// Large files on the native filesystem are mapped instead of read.
+	File::BufferPtr buffer = mapFile(filename, mDirSeparator, fileLength);
+	if (buffer)
+	{
+		closeFile(myFile);
+		if (mVerbose) { std::cout << "Mapped '" << filename << "' successfully." << std::endl; }
+		return File(buffer, filename);
+	}
+
+	// Read straight into the File's buffer.
+	std::shared_ptr<File::StreamBuffer> streamBuffer = std::make_shared<File::StreamBuffer>();
+	File::ByteStream& stream = *streamBuffer->stream();
+	stream.resize(fileLength);
+
+	// If we read less then the file length, return an empty File object and log a message.
+	if (fileLength > 0 && PHYSFS_read(myFile, &stream[0], sizeof(char), fileLength) < fileLength)
 	{
 		std::cout << "Unable to load '" << filename << "'. " << PHYSFS_getLastError() << "." << std::endl;
-		delete[] fileBuffer;
 		closeFile(myFile);
 		return File();
 	}
 
-	File file(std::string(fileBuffer, fileLength), filename);
+	File file(streamBuffer, filename);
 	closeFile(myFile);
-	delete[] fileBuffer;
 
 	if (mVerbose) { std::cout << "Loaded '" << filename << "' successfully." << std::endl; }
 
@@ -275,6 +363,79 @@ File Filesystem::open(const std::string& filename) const
 }
 
 
+/**
+ * Opens a file for streaming.
+ *
+ * Unlike open(), the file is not read into memory. Use this for large files
+ * like music tracks that don't need to be resident.
+ *
+ * \param filename		Path of the file to open.
+ * \param bufferSize	Size, in bytes, of the read buffer. 0 disables buffering.
+ *
+ * \return Returns a FileStream. The FileStream is not open if the file couldn't be opened.
+ */
+FileStream Filesystem::openStream(const std::string& filename, size_t bufferSize) const
+{
+	if (!FILESYSTEM_INITIALIZED) { throw filesystem_not_initialized(); }
+
+	if (mVerbose) { std::cout << "Attempting to stream '" << filename << std::endl; }
+
+	PHYSFS_file* myFile = PHYSFS_openRead(filename.c_str());
+	if (!myFile)
+	{
+		std::cout << "Unable to stream '" << filename << "'. " << PHYSFS_getLastError() << "." << std::endl;
+		return FileStream();
+	}
+
+	FileStream stream(myFile, filename);
+	if (bufferSize > 0 && !stream.bufferSize(bufferSize))
+	{
+		std::cout << "Unable to set buffer for '" << filename << "'. " << PHYSFS_getLastError() << "." << std::endl;
+	}
+
+	return stream;
+}
+
+
+/**
+ * Opens a file for writing as a stream.
+ *
+ * Unlike write(), the contents of the file don't need to be in memory all at
+ * once. Bytes are written through the stream as they're produced.
+ *
+ * \param filename		Path of the file to write.
+ * \param overwrite		Flag indicating if a file should be overwritten if it already exists. Default is true.
+ * \param bufferSize	Size, in bytes, of the write buffer. 0 disables buffering.
+ *
+ * \return Returns a FileStream. The FileStream is not open if the file couldn't be opened.
+ */
+FileStream Filesystem::openWriteStream(const std::string& filename, bool overwrite, size_t bufferSize) const
+{
+	if (!FILESYSTEM_INITIALIZED) { throw filesystem_not_initialized(); }
+
+	if (!overwrite && exists(filename))
+	{
+		if (mVerbose) { std::cout << "Attempted to overwrite a file '" << filename << "' that already exists." << std::endl; }
+		return FileStream();
+	}
+
+	PHYSFS_file* myFile = PHYSFS_openWrite(filename.c_str());
+	if (!myFile)
+	{
+		if (mVerbose) { std::cout << "Couldn't open '" << filename << "' for writing: " << PHYSFS_getLastError() << std::endl; }
+		return FileStream();
+	}
+
+	FileStream stream(myFile, filename);
+	if (bufferSize > 0 && !stream.bufferSize(bufferSize))
+	{
+		std::cout << "Unable to set buffer for '" << filename << "'. " << PHYSFS_getLastError() << "." << std::endl;
+	}
+
+	return stream;
+}
+
+
 /**
  * Creates a new directory within the primary search path.
  *
@@ -378,7 +539,7 @@ bool Filesystem::write(const File& file, bool overwrite) const
 		return false;
 	}
 
-	if (PHYSFS_write(myFile, file.bytes().c_str(), sizeof(char), static_cast<PHYSFS_uint32>(file.size())) < static_cast<PHYSFS_sint64>(file.size()))
+	if (PHYSFS_write(myFile, file.raw_bytes(), sizeof(char), static_cast<PHYSFS_uint32>(file.size())) < static_cast<PHYSFS_sint64>(file.size()))
 	{
 		if (mVerbose) { std::cout << "Error occured while writing to file '" << file.filename() << "': " << PHYSFS_getLastError() << std::endl; }
 		closeFile(myFile);
@@ -469,3 +630,154 @@ std::string Filesystem::extension(const std::string& path)
 		return std::string();
 	}
 }
+
+
+// ==================================================================================
+// = Unexposed module-level functions defined here that don't need to be part of the
+// = API interface.
+// ==================================================================================
+
+#if defined(__linux__) || defined(__APPLE__)
+
+/**
+ * File::Buffer backed by a read only memory mapping of a native file.
+ */
+class MappedBuffer : public File::Buffer
+{
+public:
+	MappedBuffer(void* data, size_t size) : mData(data), mSize(size) {}
+	~MappedBuffer() { munmap(mData, mSize); }
+
+	File::RawByteStream data() const { return static_cast<File::RawByteStream>(mData); }
+	size_t size() const { return mSize; }
+
+	const File::ByteStream& bytes() const
+	{
+		std::call_once(mStreamFlag, [this]() { mStream.assign(data(), mSize); });
+		return mStream;
+	}
+
+private:
+	MappedBuffer(const MappedBuffer&);				// Intentionally left undefined;
+	MappedBuffer& operator=(const MappedBuffer&);	// Intentionally left undefined;
+
+private:
+	void*	mData;
+	size_t	mSize;
+
+	mutable std::once_flag		mStreamFlag;	/**< Guards building mStream. */
+	mutable File::ByteStream	mStream;		/**< Copy of the mapped bytes built by bytes(). */
+};
+
+
+/**
+ * Determines if a native path is inside of the PhysFS write directory.
+ *
+ * Both paths are resolved first so that relative paths, symbolic links,
+ * trailing separators and a write directory nested inside of a search path
+ * are all caught.
+ *
+ * \return	True if the path is inside of the write directory or either path
+ *			can't be resolved.
+ */
+bool insideWriteDir(const std::string& path)
+{
+	const char* writeDir = PHYSFS_getWriteDir();
+	if (!writeDir)
+	{
+		return false;
+	}
+
+	char* resolvedPath = realpath(path.c_str(), nullptr);
+	char* resolvedWriteDir = realpath(writeDir, nullptr);
+
+	bool inside = true;
+	if (resolvedPath && resolvedWriteDir)
+	{
+		std::string file(resolvedPath), dir(resolvedWriteDir);
+		if (dir.empty() || dir[dir.size() - 1] != '/') { dir += '/'; }
+
+		inside = file.compare(0, dir.size(), dir) == 0;
+	}
+
+	free(resolvedPath);
+	free(resolvedWriteDir);
+
+	return inside;
+}
+
+#endif
+
+
+/**
+ * Maps a file into memory if it lives in a directory on the native filesystem.
+ *
+ * \param	filename		Path of the file within the search path.
+ * \param	dirSeparator	Platform directory separator.
+ * \param	length			Length of the file as reported by PhysFS.
+ *
+ * \return	Buffer with the mapped file or an empty pointer if the file is small,
+ *			inside of an archive, in the write directory or can't be mapped.
+ */
+File::BufferPtr mapFile(const std::string& filename, const std::string& dirSeparator, size_t length)
+{
+#if defined(__linux__) || defined(__APPLE__)
+	if (length < MAP_THRESHOLD)
+	{
+		return File::BufferPtr();
+	}
+
+	// File::raw_bytes() must be null terminated. The tail of the last page of a
+	// mapping is zero filled so files that end on a page boundary are read instead.
+	long pageSize = sysconf(_SC_PAGESIZE);
+	if (pageSize <= 0 || length % static_cast<size_t>(pageSize) == 0)
+	{
+		return File::BufferPtr();
+	}
+
+	const char* realDir = PHYSFS_getRealDir(filename.c_str());
+	if (!realDir)
+	{
+		return File::BufferPtr();
+	}
+
+	// Files found in an archive have the archive as their real dir.
+	struct stat dirInfo;
+	if (stat(realDir, &dirInfo) != 0 || !S_ISDIR(dirInfo.st_mode))
+	{
+		return File::BufferPtr();
+	}
+
+	// Files in the write dir can be rewritten while a File still maps them.
+	std::string path = std::string(realDir) + dirSeparator + filename;
+	if (insideWriteDir(path))
+	{
+		return File::BufferPtr();
+	}
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return File::BufferPtr();
+	}
+
+	struct stat fileInfo;
+	if (fstat(fd, &fileInfo) != 0 || static_cast<size_t>(fileInfo.st_size) != length)
+	{
+		close(fd);
+		return File::BufferPtr();
+	}
+
+	void* data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (data == MAP_FAILED)
+	{
+		return File::BufferPtr();
+	}
+
+	return std::make_shared<MappedBuffer>(data, length);
+#else
+	return File::BufferPtr();
+#endif
+}
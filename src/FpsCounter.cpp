@@ -10,48 +10,201 @@
 
 #include "NAS2D/FpsCounter.h"
 
-#include <SDL.h>
+#include <algorithm>
+#include <cmath>
 
 using namespace NAS2D;
 
-const unsigned int FPS_COUNTS_SIZE = 25;
-unsigned int FPS_COUNTS[FPS_COUNTS_SIZE] = { 0 };
+const size_t FPS_AVERAGE_SIZE = 25;		/**< Number of recent frames fps() averages over. */
 
-unsigned int	CURRENT_TICK		= 0;
-unsigned int	LAST_TICK			= 0;
-unsigned int	TICK_DELTA			= 0;
-unsigned int	INDEX				= 0;
-unsigned int	ACCUMULATOR			= 0;
+
+// ==================================================================================
+// = UNEXPOSED FUNCTION PROTOTYPES
+// ==================================================================================
+double percentile(const std::vector<double>& sorted, double p);
 
 
 /**
  * FpsCounter c'tor
+ *
+ * \param	sampleCount	Number of frame times to keep. Minimum is 1.
  */
-FpsCounter::FpsCounter()
+FpsCounter::FpsCounter(size_t sampleCount):	mSamples(std::max<size_t>(sampleCount, 1), 0.0),
+											mNext(0),
+											mCount(0),
+											mStarted(false)
 {}
 
 
 /**
- * Gets an average count of Frames per Second.
+ * Records a frame and gets the average Frames per Second over the most recent
+ * frames.
  */
 unsigned int FpsCounter::fps()
 {
-	LAST_TICK = CURRENT_TICK;
-	CURRENT_TICK = SDL_GetTicks();
+	frame();
+
+	size_t count = std::min(mCount, FPS_AVERAGE_SIZE);
+	if (count == 0) { return 0; }
+
+	double total = 0.0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		total += sample(i);
+	}
+
+	if (total <= 0.0) { return 0; }
+
+	return static_cast<unsigned int>(1000.0 * count / total);
+}
+
+
+/**
+ * Records the time since the previous call as a frame time.
+ *
+ * \note	The first call only starts timing and doesn't record a frame.
+ */
+void FpsCounter::frame()
+{
+	double delta = mTimer.preciseDelta();
+
+	if (!mStarted)
+	{
+		mStarted = true;
+		return;
+	}
+
+	mSamples[mNext] = delta;
+	mNext = (mNext + 1) % mSamples.size();
+	if (mCount < mSamples.size()) { ++mCount; }
+}
+
+
+/**
+ * Computes statistics on the recorded frame times.
+ *
+ * \note	Sorts a copy of the recorded frame times so this is best called
+ *			periodically rather than every frame.
+ */
+FpsCounter::FrameStats FpsCounter::stats() const
+{
+	FrameStats stats;
+	if (mCount == 0) { return stats; }
 
-	TICK_DELTA = CURRENT_TICK - LAST_TICK;
+	std::vector<double> sorted(mSamples.begin(), mSamples.begin() + mCount);
+	std::sort(sorted.begin(), sorted.end());
 
-	if (TICK_DELTA == 0) { TICK_DELTA = 1; }
+	double total = 0.0;
+	for (double time : sorted)
+	{
+		total += time;
+	}
 
-	FPS_COUNTS[++INDEX] = 1000 / TICK_DELTA;
+	stats.samples = mCount;
+	stats.min = sorted.front();
+	stats.max = sorted.back();
+	stats.mean = total / mCount;
 
-	if (INDEX >= FPS_COUNTS_SIZE) { INDEX = 0; }
+	stats.p50 = percentile(sorted, 0.50);
+	stats.p95 = percentile(sorted, 0.95);
+	stats.p99 = percentile(sorted, 0.99);
 
-	ACCUMULATOR = 0;
-	for (auto i : FPS_COUNTS)
+	// Slowest 1% of frames, at least one.
+	size_t lowCount = std::max<size_t>(mCount / 100, 1);
+	double lowTotal = 0.0;
+	for (size_t i = mCount - lowCount; i < mCount; ++i)
 	{
-		ACCUMULATOR += i;
+		lowTotal += sorted[i];
 	}
 
-	return ACCUMULATOR / FPS_COUNTS_SIZE;
+	stats.low1Fps = lowTotal > 0.0 ? 1000.0 * lowCount / lowTotal : 0.0;
+
+	return stats;
+}
+
+
+/**
+ * Counts recorded frame times in buckets of equal width.
+ *
+ * \param	bucketWidth	Width, in milliseconds, of each bucket.
+ * \param	bucketCount	Number of buckets.
+ *
+ * \return	Number of frames in each bucket. Bucket \c i counts frame times from
+ *			<tt>i * bucketWidth</tt> up to but not including <tt>(i + 1) * bucketWidth</tt>.
+ *			The last bucket also counts every frame time past the end of the range.
+ *			Empty if \c bucketWidth isn't positive or \c bucketCount is 0.
+ */
+std::vector<unsigned int> FpsCounter::histogram(double bucketWidth, size_t bucketCount) const
+{
+	std::vector<unsigned int> buckets;
+	if (bucketWidth <= 0.0 || bucketCount == 0) { return buckets; }
+
+	buckets.resize(bucketCount, 0);
+	for (size_t i = 0; i < mCount; ++i)
+	{
+		double bucket = std::floor(mSamples[i] / bucketWidth);
+		buckets[bucket >= bucketCount ? bucketCount - 1 : static_cast<size_t>(bucket)]++;
+	}
+
+	return buckets;
+}
+
+
+/**
+ * Gets the number of recorded frame times.
+ */
+size_t FpsCounter::size() const
+{
+	return mCount;
+}
+
+
+/**
+ * Gets the maximum number of frame times the FpsCounter keeps.
+ */
+size_t FpsCounter::capacity() const
+{
+	return mSamples.size();
+}
+
+
+/**
+ * Clears all recorded frame times. The next call to fps() or frame() starts
+ * timing again.
+ */
+void FpsCounter::reset()
+{
+	mNext = 0;
+	mCount = 0;
+	mStarted = false;
+}
+
+
+/**
+ * Gets a recorded frame time.
+ *
+ * \param	age	Number of frames before the most recent frame. 0 is the most
+ *				recent frame.
+ */
+double FpsCounter::sample(size_t age) const
+{
+	return mSamples[(mNext + mSamples.size() - 1 - age) % mSamples.size()];
+}
+
+
+// ==================================================================================
+// = Unexposed module-level functions defined here that don't need to be part of the
+// = API interface.
+// ==================================================================================
+
+/**
+ * Gets a percentile of sorted values using the nearest rank.
+ *
+ * \param	sorted	Values sorted in ascending order. Must not be empty.
+ * \param	p		Percentile from 0.0 to 1.0.
+ */
+double percentile(const std::vector<double>& sorted, double p)
+{
+	size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+	return sorted[rank > 0 ? rank - 1 : 0];
 }
@@ -13,11 +13,14 @@
 #include "NAS2D/Exception.h"
 #include "NAS2D/Filesystem.h"
 #include "NAS2D/Game.h"
+#include "NAS2D/Profiler.h"
 #include "NAS2D/Utility.h"
 
 #include "NAS2D/Mixer/Mixer_SDL.h"
 #include "NAS2D/Renderer/OGL_Renderer.h"
 
+#include "NAS2D/Resources/ResourceLoader.h"
+
 #include <SDL.h>
 
 #include <iostream>
@@ -34,7 +37,8 @@ using namespace NAS2D;
  * \param	configPath	Path to the Config file. Defaults to 'config.xml'.
  * \param	dataPath	Intitial data path. Defaults to 'data'.
  */
-Game::Game(const std::string& title, const std::string& argv_0, const std::string& configPath, const std::string& dataPath)
+Game::Game(const std::string& title, const std::string& argv_0, const std::string& configPath, const std::string& dataPath):	mStepsPerSecond(0),
+																																mMaxStepsPerFrame(5)
 {
 	std::cout << "NAS2D BUILD: " << __DATE__ << " | " << __TIME__ << std::endl;
 	std::cout << "NAS2D VERSION: " << NAS2D::versionString() << std::endl << std::endl;
@@ -43,6 +47,9 @@ Game::Game(const std::string& title, const std::string& argv_0, const std::strin
 
 	Utility<Filesystem>::get().init(argv_0, dataPath);
 
+	// Created up front so worker threads never race to create it.
+	Utility<Profiler>::get();
+
 	Configuration& cf = Utility<Configuration>::get();
 	cf.load(configPath);
 
@@ -80,11 +87,13 @@ Game::~Game()
 	std::cout << "Shutting down..." << std::endl;
 
 	// Destroy all of our various components in reverse order.
+	Utility<ResourceLoader>::clear();
 	Utility<Renderer>::clear();
 	Utility<EventHandler>::clear();
 	Utility<Mixer>::clear();
 	Utility<Configuration>::clear();
 	Utility<Filesystem>::clear();
+	Utility<Profiler>::clear();
 
 	std::cout << std::endl << "Game object has been terminated." << std::endl;
 
@@ -105,6 +114,23 @@ void Game::mount(const std::string& path)
 }
 
 
+/**
+ * Sets the fixed timestep the StateManager runs States at once go() is called.
+ *
+ * \param	stepsPerSecond		Number of times per second to call State::fixedUpdate().
+ *								0 turns fixed timestep updates off. Default is 0.
+ * \param	maxStepsPerFrame	Maximum number of times State::fixedUpdate() is called
+ *								in a single frame.
+ *
+ * \see StateManager::fixedTimestep()
+ */
+void Game::fixedTimestep(unsigned int stepsPerSecond, unsigned int maxStepsPerFrame)
+{
+	mStepsPerSecond = stepsPerSecond;
+	mMaxStepsPerFrame = maxStepsPerFrame;
+}
+
+
 /**
  * Primes the EventHandler and StateManager and enters the main game loop.
  *
@@ -118,12 +144,18 @@ void Game::go(State *state)
 	std::cout << "** GAME STATE START **" << std::endl << std::endl;
 
 	StateManager stateManager;
+	stateManager.fixedTimestep(mStepsPerSecond, mMaxStepsPerFrame);
 
 	stateManager.setState(state);
 
+	NAS2D_PROFILE_FRAME();
+
 	// Game Loop
 	while (stateManager.update())
 	{
+		Utility<ResourceLoader>::get().update();
 		Utility<Renderer>::get().update();
+
+		NAS2D_PROFILE_FRAME();
 	}
 }
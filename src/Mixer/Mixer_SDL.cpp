@@ -14,6 +14,7 @@
 #include "NAS2D/Exception.h"
 
 #include "NAS2D/Resources/MusicInfo.h"
+#include "NAS2D/Resources/ResourceRegistry.h"
 
 #include "NAS2D/Utility.h"
 
@@ -26,7 +27,7 @@
 using namespace NAS2D;
 using namespace NAS2D::Exception;
 
-extern std::map<std::string, MusicInfo>	MUSIC_REF_MAP;
+extern ResourceRegistry<MusicInfo>	MUSIC_REGISTRY;
 
 
 // ==================================================================================
@@ -149,12 +150,13 @@ void Mixer_SDL::resumeMusic()
 
 void Mixer_SDL::fadeInMusic(Music& music, int loops, int time)
 {
-	if (!music.loaded())
+	MusicInfo* info = MUSIC_REGISTRY.get(music.handle());
+	if (!music.loaded() || !info)
 	{
 		return;
 	}
 
-	Mix_FadeInMusic(static_cast<Mix_Music*>(MUSIC_REF_MAP[music.name()].music), loops, time);
+	Mix_FadeInMusic(static_cast<Mix_Music*>(info->music), loops, time);
 }
 
 
@@ -0,0 +1,265 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright © 2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// = 
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+
+#include "NAS2D/Profiler.h"
+
+#include "NAS2D/FileStream.h"
+#include "NAS2D/Filesystem.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+using namespace NAS2D;
+
+
+// ==================================================================================
+// = UNEXPOSED FUNCTION PROTOTYPES
+// ==================================================================================
+void writeJsonString(std::ostream& out, const char* str);
+
+
+/**
+ * C'tor
+ *
+ * \param	capacity	Maximum number of zones to keep. Minimum is 1.
+ */
+Profiler::Profiler(size_t capacity):	mStart(mTimer.preciseTick()),
+										mFrameStart(-1.0),
+										mEnabled(true),
+										mFrame(0),
+										mCapacity(std::max<size_t>(capacity, 1)),
+										mNext(0),
+										mCount(0)
+{
+	// The thread that creates the Profiler is reported as the main thread.
+	mThreads[std::this_thread::get_id()] = 0;
+}
+
+
+/**
+ * D'tor
+ */
+Profiler::~Profiler()
+{}
+
+
+/**
+ * Sets whether zones are recorded. Enabled by default.
+ */
+void Profiler::enabled(bool enabled)
+{
+	mEnabled = enabled;
+}
+
+
+/**
+ * Gets whether zones are recorded.
+ */
+bool Profiler::enabled() const
+{
+	return mEnabled;
+}
+
+
+/**
+ * Gets the time, in milliseconds, since the Profiler was created.
+ */
+double Profiler::now() const
+{
+	return mTimer.preciseTick() - mStart;
+}
+
+
+/**
+ * Records a zone on the calling thread.
+ *
+ * \param	name	Name of the zone. Must outlive the Profiler, e.g., a string literal.
+ * \param	start	Time the zone started as returned by now().
+ * \param	end		Time the zone ended as returned by now().
+ */
+void Profiler::record(const char* name, double start, double end)
+{
+	if (!mEnabled) { return; }
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	if (mZones.empty()) { mZones.resize(mCapacity); }
+
+	ThreadMap::iterator thread = mThreads.find(std::this_thread::get_id());
+	if (thread == mThreads.end())
+	{
+		thread = mThreads.insert(ThreadMap::value_type(std::this_thread::get_id(), static_cast<unsigned int>(mThreads.size()))).first;
+	}
+
+	Zone& zone = mZones[mNext];
+	zone.name = name;
+	zone.start = start;
+	zone.duration = end - start;
+	zone.thread = thread->second;
+	zone.frame = mFrame;
+
+	mNext = (mNext + 1) % mCapacity;
+	if (mCount < mCapacity) { ++mCount; }
+}
+
+
+/**
+ * Ends the current frame, recording it as a zone named "Frame", and starts the
+ * next one.
+ *
+ * \note	The first call only starts timing the first frame.
+ */
+void Profiler::frame()
+{
+	double time = now();
+
+	if (mFrameStart >= 0.0)
+	{
+		record("Frame", mFrameStart, time);
+		++mFrame;
+	}
+
+	mFrameStart = time;
+}
+
+
+/**
+ * Gets the number of frames that have ended.
+ */
+unsigned int Profiler::frameCount() const
+{
+	return mFrame;
+}
+
+
+/**
+ * Gets the number of recorded zones.
+ */
+size_t Profiler::size() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mCount;
+}
+
+
+/**
+ * Gets the maximum number of zones the Profiler keeps.
+ */
+size_t Profiler::capacity() const
+{
+	return mCapacity;
+}
+
+
+/**
+ * Discards all recorded zones.
+ */
+void Profiler::clear()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mNext = 0;
+	mCount = 0;
+}
+
+
+/**
+ * Gets the recorded zones, oldest first, in the Chrome trace event format.
+ */
+std::string Profiler::trace() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	std::ostringstream out;
+	out.precision(3);
+	out << std::fixed;
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Main\"}}";
+
+	size_t first = (mNext + mCapacity - mCount) % mCapacity;
+	for (size_t i = 0; i < mCount; ++i)
+	{
+		const Zone& zone = mZones[(first + i) % mCapacity];
+
+		// Trace event times are in microseconds.
+		out << ",\n{\"name\":";
+		writeJsonString(out, zone.name);
+		out << ",\"cat\":\"nas2d\",\"ph\":\"X\",\"pid\":1,\"tid\":" << zone.thread;
+		out << ",\"ts\":" << zone.start * 1000.0 << ",\"dur\":" << zone.duration * 1000.0;
+		out << ",\"args\":{\"frame\":" << zone.frame << "}}";
+	}
+
+	out << "\n]}\n";
+
+	return out.str();
+}
+
+
+/**
+ * Writes the recorded zones to a file in the Chrome trace event format.
+ *
+ * \param	filename	Name of the file to write, relative to the Filesystem's write directory.
+ *
+ * \return	True on success, false otherwise.
+ */
+bool Profiler::writeTrace(const std::string& filename) const
+{
+	std::string json = trace();
+
+	FileStream stream = Utility<Filesystem>::get().openWriteStream(filename);
+	if (!stream.isOpen())
+	{
+		std::cout << "Profiler: Unable to write trace to '" << filename << "'." << std::endl;
+		return false;
+	}
+
+	return stream.write(json.c_str(), json.size()) == json.size();
+}
+
+
+// ==================================================================================
+// = Unexposed module-level functions defined here that don't need to be part of the
+// = API interface.
+// ==================================================================================
+
+/**
+ * Writes a quoted and escaped JSON string.
+ */
+void writeJsonString(std::ostream& out, const char* str)
+{
+	static const char HEX[] = "0123456789abcdef";
+
+	out << '"';
+	for (const char* p = str; *p; ++p)
+	{
+		unsigned char c = static_cast<unsigned char>(*p);
+		switch (c)
+		{
+		case '"':
+			out << "\\\"";
+			break;
+		case '\\':
+			out << "\\\\";
+			break;
+		default:
+			if (c < 0x20)
+			{
+				out << "\\u00" << HEX[c >> 4] << HEX[c & 0x0f];
+			}
+			else
+			{
+				out << *p;
+			}
+			break;
+		}
+	}
+	out << '"';
+}
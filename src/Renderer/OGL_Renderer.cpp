@@ -20,13 +20,19 @@
 #include "NAS2D/EventHandler.h"
 #include "NAS2D/Exception.h"
 #include "NAS2D/Filesystem.h"
+#include "NAS2D/Profiler.h"
 #include "NAS2D/Resources/FontInfo.h"
 #include "NAS2D/Resources/ImageInfo.h"
+#include "NAS2D/Resources/ResourceRegistry.h"
 #include "NAS2D/Utility.h"
 
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 #include <math.h>
+#include <vector>
 
 using namespace NAS2D;
 using namespace NAS2D::Exception;
@@ -42,19 +48,46 @@ GLfloat DEFAULT_TEXTURE_COORDS[12] = { 0.0f, 0.0f,  0.0f, 1.0f,  1.0f, 1.0f,  1.
 
 GLfloat POINT_VERTEX_ARRAY[2] = { 0.0f, 0.0f };
 
-/** Color value array for four verts. Defaults to white or normal color. */
-GLfloat COLOR_VERTEX_ARRAY[24] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+/** Color value array for six verts. Defaults to white or normal color. */
+GLubyte COLOR_VERTEX_ARRAY[24] = { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255 };
 
 GLfloat		VERTEX_ARRAY[12]		= {};	/**< Vertex array for quad drawing functions (all blitter functions). */
 GLfloat		TEXTURE_COORD_ARRAY[12]	= {};	/**< Texture coordinate array for quad drawing functions (all blitter functions). */
 
+/** Initial number of quads the batch buffers are sized for. The buffers grow as needed. */
+const size_t BATCH_INITIAL_QUADS = 1024;
+
+/**
+ * Interleaved vertex format used by the quad batch.
+ */
+struct BatchVertex
+{
+	GLfloat x, y;			/**< Position. */
+	GLfloat u, v;			/**< Texture coordinate. */
+	GLubyte r, g, b, a;		/**< Color. */
+};
+
+std::vector<BatchVertex>	BATCH_VERTEX_ARRAY;			/**< Pending quad vertices, two triangles per quad. */
+GLuint						BATCH_TEXTURE_ID = 0;		/**< Texture used by every quad in the pending batch. 0 draws untextured. */
+
+GLuint		BATCH_VBO = 0;					/**< Streaming vertex buffer. 0 if buffer objects are unavailable and client arrays are used. */
+GLsizeiptr	BATCH_VBO_SIZE = 0;				/**< Size of the streaming vertex buffer's data store in bytes. */
+bool		BATCH_VBO_MAP_RANGE = false;	/**< Use glMapBufferRange() instead of glBufferSubData() to fill the vertex buffer. */
+
+unsigned int BATCH_COUNT = 0;												/**< Batches submitted during the current frame. */
+unsigned int BATCH_FLUSH_COUNTS[OGL_Renderer::FLUSH_REASON_COUNT] = {};		/**< Flushes per reason during the current frame. */
+unsigned int LAST_BATCH_COUNT = 0;											/**< Batches submitted during the last complete frame. */
+unsigned int LAST_BATCH_FLUSH_COUNTS[OGL_Renderer::FLUSH_REASON_COUNT] = {};	/**< Flushes per reason during the last complete frame. */
+
+Renderer::DrawStats DRAW_STATS;		/**< Draw statistics for the current frame. */
+
 /** Mouse cursors */
 std::map<int, SDL_Cursor*> CURSORS;
 
 // UGLY ASS HACK!
 // This is required here in order to remove OpenGL implementation details from Image and Font.
-extern std::map<std::string, ImageInfo>	IMAGE_ID_MAP;
-extern std::map<std::string, FontInfo> FONTMAP;
+extern ResourceRegistry<ImageInfo>	IMAGE_REGISTRY;
+extern ResourceRegistry<FontInfo>	FONT_REGISTRY;
 
 // UGLY ASS HACK!
 // This is required for mouse grabbing in the EventHandler class.
@@ -66,11 +99,29 @@ SDL_GLContext		CONTEXT;					/**< Primary OpenGL render context. */
 // MODULE LEVEL FUNCTIONS
 void fillVertexArray(GLfloat x, GLfloat y, GLfloat w, GLfloat h);
 void fillTextureArray(GLfloat x, GLfloat y, GLfloat u, GLfloat v);
+void fillImageTextureArray(const ImageInfo& info, GLfloat x, GLfloat y, GLfloat u, GLfloat v);
+const ImageInfo& imageInfo(const Image& image);
 void drawVertexArray(GLuint textureId, bool defaultTextureCoords = true);
 
+void fillColorArray(int r, int g, int b, int a);
+void rotateVertexArray(GLfloat x, GLfloat y, GLfloat degrees);
+void batchVertexArray(GLuint textureId, bool defaultTextureCoords = true);
+void batchTexture(GLuint textureId);
+void flushBatch(OGL_Renderer::BatchFlushReason reason);
+void uploadBatch();
+
+void drawArrays(GLenum mode, GLsizei count);
+void bindTexture(GLuint textureId);
+void bindFramebuffer(GLuint fbo);
+void setCapability(GLenum capability, bool enabled);
+void setClientState(GLenum array, bool enabled);
+
 void line(float x1, float y1, float x2, float y2, float w, float Cr, float Cg, float Cb, float Ca);
 GLuint generate_fbo(Image& image);
 
+void atlasRelease(ImageInfo& info);
+void freePixels(ImageInfo& info);
+
 
 /**
  * C'tor
@@ -95,6 +146,13 @@ OGL_Renderer::~OGL_Renderer()
 {
 	Utility<EventHandler>::get().windowResized().disconnect(this, &OGL_Renderer::_resize);
 
+	if (BATCH_VBO != 0)
+	{
+		glDeleteBuffers(1, &BATCH_VBO);
+		BATCH_VBO = 0;
+		BATCH_VBO_SIZE = 0;
+	}
+
 	SDL_GL_DeleteContext(CONTEXT);
 	SDL_DestroyWindow(_WINDOW);
 	_WINDOW = nullptr;
@@ -106,62 +164,58 @@ OGL_Renderer::~OGL_Renderer()
 
 void OGL_Renderer::drawImage(Image& image, float x, float y, float scale, int r, int g, int b, int a)
 {
-	glColor4ub(r, g, b, a);
-
+	fillColorArray(r, g, b, a);
 	fillVertexArray(x, y, static_cast<float>(image.width() * scale), static_cast<float>(image.height() * scale));
-	fillTextureArray(0.0, 0.0, 1.0, 1.0);
-	drawVertexArray(IMAGE_ID_MAP[image.name()].texture_id);
+
+	const ImageInfo& info = imageInfo(image);
+	fillImageTextureArray(info, 0.0f, 0.0f, 1.0f, 1.0f);
+	batchVertexArray(info.texture_id, false);
 }
 
 
 void OGL_Renderer::drawSubImage(Image& image, float rasterX, float rasterY, float x, float y, float width, float height, int r, int g, int b, int a)
 {
-	glColor4ub(r, g, b, a);
-
+	fillColorArray(r, g, b, a);
 	fillVertexArray(rasterX, rasterY, width, height);
 
-	fillTextureArray(	x / image.width(),
-						y / image.height(),
-						x / image.width() + width / image.width(),
-						y / image.height() + height / image.height()
-					);
+	const ImageInfo& info = imageInfo(image);
+	fillImageTextureArray(	info,
+							x / image.width(),
+							y / image.height(),
+							x / image.width() + width / image.width(),
+							y / image.height() + height / image.height()
+						);
 
-	drawVertexArray(IMAGE_ID_MAP[image.name()].texture_id, false);
+	batchVertexArray(info.texture_id, false);
 }
 
 
 void OGL_Renderer::drawSubImageRotated(Image& image, float rasterX, float rasterY, float x, float y, float width, float height, float degrees, int r, int g, int b, int a)
 {
-	glPushMatrix();
-
 	// Find center point of the image.
 	float tX = width / 2.0f;
 	float tY = height / 2.0f;
 
-	// Adjust the translation so that images appear where expected.
-	glTranslatef(rasterX + tX, rasterY + tY, 0.0f);
-	glRotatef(degrees, 0.0f, 0.0f, 1.0f);
-
-	glColor4ub(r, g, b, a);
+	fillColorArray(r, g, b, a);
 
+	// Rotate on the CPU so that rotated images don't break the batch with a matrix change.
 	fillVertexArray(-tX, -tY, tX * 2, tY * 2);
+	rotateVertexArray(rasterX + tX, rasterY + tY, degrees);
 
-	fillTextureArray(	x / image.width(),
-						y / image.height(),
-						x / image.width() + width / image.width(),
-						y / image.height() + height / image.height()
-					);
+	const ImageInfo& info = imageInfo(image);
+	fillImageTextureArray(	info,
+							x / image.width(),
+							y / image.height(),
+							x / image.width() + width / image.width(),
+							y / image.height() + height / image.height()
+						);
 
-	drawVertexArray(IMAGE_ID_MAP[image.name()].texture_id, false);
-
-	glPopMatrix();
+	batchVertexArray(info.texture_id, false);
 }
 
 
 void OGL_Renderer::drawImageRotated(Image& image, float x, float y, float degrees, int r, int g, int b, int a, float scale)
 {
-	glPushMatrix();
-
 	// Find center point of the image.
 	int imgHalfW = (image.width() / 2);
 	int imgHalfH = (image.height() / 2);
@@ -169,42 +223,59 @@ void OGL_Renderer::drawImageRotated(Image& image, float x, float y, float degree
 	float tX = imgHalfW * scale;
 	float tY = imgHalfH * scale;
 
-	// Adjust the translation so that images appear where expected.
-	glTranslatef(x + imgHalfW, y + imgHalfH, 0.0f);
-
-	float _deg = degrees;
-	if (_deg < 0.0f)
-	{
-		_deg += 360.0f;
-	}
-
-	glRotatef(degrees, 0.0f, 0.0f, 1.0f);
-
-	glColor4ub(r, g, b, a);
-	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	fillColorArray(r, g, b, a);
 
+	// Adjust the translation so that images appear where expected.
 	fillVertexArray(-tX, -tY, tX * 2, tY * 2);
+	rotateVertexArray(x + imgHalfW, y + imgHalfH, degrees);
 
-	drawVertexArray(IMAGE_ID_MAP[image.name()].texture_id);
-	glPopMatrix();
+	const ImageInfo& info = imageInfo(image);
+	fillImageTextureArray(info, 0.0f, 0.0f, 1.0f, 1.0f);
+	batchVertexArray(info.texture_id, false);
 }
 
 
 void OGL_Renderer::drawImageStretched(Image& image, float x, float y, float w, float h, int r, int g, int b, int a)
 {
-	glColor4ub(r, g, b, a);
-	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-
+	fillColorArray(r, g, b, a);
 	fillVertexArray(x, y, w, h);
-	drawVertexArray(IMAGE_ID_MAP[image.name()].texture_id);
+
+	const ImageInfo& info = imageInfo(image);
+	fillImageTextureArray(info, 0.0f, 0.0f, 1.0f, 1.0f);
+	batchVertexArray(info.texture_id, false);
 }
 
 
 void OGL_Renderer::drawImageRepeated(Image& image, float x, float y, float w, float h)
 {
+	if (image.width() < 1 || image.height() < 1) { return; }
+
+	const ImageInfo& info = imageInfo(image);
+
+	// Images on a shared atlas page can't use GL_REPEAT so they're tiled with individual quads.
+	if (info.atlas_page >= 0)
+	{
+		fillColorArray(255, 255, 255, 255);
+		for (float tileY = 0.0f; tileY < h; tileY += image.height())
+		{
+			for (float tileX = 0.0f; tileX < w; tileX += image.width())
+			{
+				float tileW = std::min(static_cast<float>(image.width()), w - tileX);
+				float tileH = std::min(static_cast<float>(image.height()), h - tileY);
+
+				fillVertexArray(x + tileX, y + tileY, tileW, tileH);
+				fillImageTextureArray(info, 0.0f, 0.0f, tileW / image.width(), tileH / image.height());
+				batchVertexArray(info.texture_id, false);
+			}
+		}
+		return;
+	}
+
+	flushBatch(FLUSH_STATE_CHANGE);
+
 	glColor4ub(255, 255, 255, 255);
 
-	glBindTexture(GL_TEXTURE_2D, IMAGE_ID_MAP[image.name()].texture_id);
+	bindTexture(info.texture_id);
 
 	// Change texture mode to repeat at edges.
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -223,7 +294,8 @@ void OGL_Renderer::drawImageRepeated(Image& image, float x, float y, float w, fl
 	glVertexPointer(2, GL_FLOAT, 0, VERTEX_ARRAY);
 
 	glTexCoordPointer(2, GL_FLOAT, 0, TEXTURE_COORD_ARRAY);
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 6);
+	drawArrays(GL_TRIANGLE_STRIP, 6);
+	++DRAW_STATS.quads;
 
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -232,14 +304,20 @@ void OGL_Renderer::drawImageRepeated(Image& image, float x, float y, float w, fl
 
 void OGL_Renderer::drawImageToImage(Image& source, Image& destination, const Point_2df& dstPoint)
 {
-	glColor4ub(255, 255, 255, 255);
-
 	// Ignore the call if the detination point is outside the bounds of destination image.
 	if (!isRectInRect(dstPoint.x(), dstPoint.y(), source.width(), source.height(), 0, 0, destination.width(), destination.height()))
 		return;
 
+	ImageInfo* destinationInfo = IMAGE_REGISTRY.get(destination.handle());
+	if (!destinationInfo) { return; }
+
+	// Anything queued may sample from the destination texture.
+	flushBatch(FLUSH_STATE_CHANGE);
+
+	glColor4ub(255, 255, 255, 255);
+
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-	glBindTexture(GL_TEXTURE_2D, IMAGE_ID_MAP[destination.name()].texture_id);
+	bindTexture(destinationInfo->texture_id);
 
 	Rectangle_2d clipRect;
 
@@ -252,47 +330,57 @@ void OGL_Renderer::drawImageToImage(Image& source, Image& destination, const Poi
 		return;
 	}
 
-	GLuint fbo = IMAGE_ID_MAP[destination.name()].fbo_id;
+	GLuint fbo = destinationInfo->fbo_id;
 	if (fbo == 0)
 	{
 		fbo = generate_fbo(destination);
 	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, IMAGE_ID_MAP[destination.name()].texture_id, 0);
+	bindFramebuffer(fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, destinationInfo->texture_id, 0);
 	// Flip the Y axis to keep images drawing correctly.
 	fillVertexArray(dstPoint.x(), static_cast<float>(destination.height()) - dstPoint.y(), static_cast<float>(clipRect.width()), static_cast<float>(-clipRect.height()));
 
-	drawVertexArray(IMAGE_ID_MAP[source.name()].texture_id);
-	glBindTexture(GL_TEXTURE_2D, IMAGE_ID_MAP[destination.name()].texture_id);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	const ImageInfo& sourceInfo = imageInfo(source);
+	fillImageTextureArray(sourceInfo, 0.0f, 0.0f, 1.0f, 1.0f);
+	drawVertexArray(sourceInfo.texture_id, false);
+	++DRAW_STATS.quads;
+	bindTexture(destinationInfo->texture_id);
+	bindFramebuffer(0);
+
+	// CPU side pixels no longer match the texture.
+	freePixels(*destinationInfo);
 }
 
 
 void OGL_Renderer::drawPoint(float x, float y, int r, int g, int b, int a)
 {
-	glDisable(GL_TEXTURE_2D);
+	flushBatch(FLUSH_STATE_CHANGE);
+
+	setCapability(GL_TEXTURE_2D, false);
 
 	glColor4ub(r, g, b, a);
 
 	POINT_VERTEX_ARRAY[0] = x + 0.5f; POINT_VERTEX_ARRAY[1] = y + 0.5f;
 
 	glVertexPointer(2, GL_FLOAT, 0, POINT_VERTEX_ARRAY);
-	glDrawArrays(GL_POINTS, 0, 1);
+	drawArrays(GL_POINTS, 1);
 
-	glEnable(GL_TEXTURE_2D);
+	setCapability(GL_TEXTURE_2D, true);
 }
 
 
 void OGL_Renderer::drawLine(float x, float y, float x2, float y2, int r, int g, int b, int a, int line_width = 1)
 {
-	glDisable(GL_TEXTURE_2D);
-	glEnableClientState(GL_COLOR_ARRAY);
+	flushBatch(FLUSH_STATE_CHANGE);
+
+	setCapability(GL_TEXTURE_2D, false);
+	setClientState(GL_COLOR_ARRAY, true);
 
 	line(x, y, x2, y2, (float)line_width, r / 255.0f, g / 255.0f, b / 255.0f, a / 255.0f);
 
-	glDisableClientState(GL_COLOR_ARRAY);
-	glEnable(GL_TEXTURE_2D);
+	setClientState(GL_COLOR_ARRAY, false);
+	setCapability(GL_TEXTURE_2D, true);
 }
 
 
@@ -303,7 +391,9 @@ void OGL_Renderer::drawLine(float x, float y, float x2, float y2, int r, int g,
  */
 void OGL_Renderer::drawCircle(float cx, float cy, float radius, int r, int g, int b, int a, int num_segments, float scale_x, float scale_y)
 {
-	glDisable(GL_TEXTURE_2D);
+	flushBatch(FLUSH_STATE_CHANGE);
+
+	setCapability(GL_TEXTURE_2D, false);
 	glColor4ub(r, g, b, a);
 
 	float theta = PI_2 / static_cast<float>(num_segments);
@@ -329,7 +419,7 @@ void OGL_Renderer::drawCircle(float cx, float cy, float radius, int r, int g, in
 	}
 
 	glVertexPointer(2, GL_FLOAT, 0, verts);
-	glDrawArrays(GL_LINE_LOOP, 0, num_segments);
+	drawArrays(GL_LINE_LOOP, num_segments);
 
 	/**
 	 * \todo	I really hate the alloc's/dealloc's that are done in this function.
@@ -339,68 +429,63 @@ void OGL_Renderer::drawCircle(float cx, float cy, float radius, int r, int g, in
 	 */
 	delete[] verts;
 
-	glEnable(GL_TEXTURE_2D);
+	setCapability(GL_TEXTURE_2D, true);
 }
 
 
 void OGL_Renderer::drawGradient(float x, float y, float w, float h, int r1, int g1, int b1, int a1, int r2, int g2, int b2, int a2, int r3, int g3, int b3, int a3, int r4, int g4, int b4, int a4)
 {
-	glEnableClientState(GL_COLOR_ARRAY);
-	glDisable(GL_TEXTURE_2D);
-
-	COLOR_VERTEX_ARRAY[0] = r1 / 255.0f;
-	COLOR_VERTEX_ARRAY[1] = g1 / 255.0f;
-	COLOR_VERTEX_ARRAY[2] = b1 / 255.0f;
-	COLOR_VERTEX_ARRAY[3] = a1 / 255.0f;
+	COLOR_VERTEX_ARRAY[0] = r1;
+	COLOR_VERTEX_ARRAY[1] = g1;
+	COLOR_VERTEX_ARRAY[2] = b1;
+	COLOR_VERTEX_ARRAY[3] = a1;
 
-	COLOR_VERTEX_ARRAY[4] = r2 / 255.0f;
-	COLOR_VERTEX_ARRAY[5] = g2 / 255.0f;
-	COLOR_VERTEX_ARRAY[6] = b2 / 255.0f;
-	COLOR_VERTEX_ARRAY[7] = a2 / 255.0f;
+	COLOR_VERTEX_ARRAY[4] = r2;
+	COLOR_VERTEX_ARRAY[5] = g2;
+	COLOR_VERTEX_ARRAY[6] = b2;
+	COLOR_VERTEX_ARRAY[7] = a2;
 
-	COLOR_VERTEX_ARRAY[8] = r3 / 255.0f;
-	COLOR_VERTEX_ARRAY[9] = g3 / 255.0f;
-	COLOR_VERTEX_ARRAY[10] = b3 / 255.0f;
-	COLOR_VERTEX_ARRAY[11] = a3 / 255.0f;
+	COLOR_VERTEX_ARRAY[8] = r3;
+	COLOR_VERTEX_ARRAY[9] = g3;
+	COLOR_VERTEX_ARRAY[10] = b3;
+	COLOR_VERTEX_ARRAY[11] = a3;
 
 
-	COLOR_VERTEX_ARRAY[12] = r3 / 255.0f;
-	COLOR_VERTEX_ARRAY[13] = g3 / 255.0f;
-	COLOR_VERTEX_ARRAY[14] = b3 / 255.0f;
-	COLOR_VERTEX_ARRAY[15] = a3 / 255.0f;
+	COLOR_VERTEX_ARRAY[12] = r3;
+	COLOR_VERTEX_ARRAY[13] = g3;
+	COLOR_VERTEX_ARRAY[14] = b3;
+	COLOR_VERTEX_ARRAY[15] = a3;
 
-	COLOR_VERTEX_ARRAY[16] = r4 / 255.0f;
-	COLOR_VERTEX_ARRAY[17] = g4 / 255.0f;
-	COLOR_VERTEX_ARRAY[18] = b4 / 255.0f;
-	COLOR_VERTEX_ARRAY[19] = a4 / 255.0f;
+	COLOR_VERTEX_ARRAY[16] = r4;
+	COLOR_VERTEX_ARRAY[17] = g4;
+	COLOR_VERTEX_ARRAY[18] = b4;
+	COLOR_VERTEX_ARRAY[19] = a4;
 
-	COLOR_VERTEX_ARRAY[20] = r1 / 255.0f;
-	COLOR_VERTEX_ARRAY[21] = g1 / 255.0f;
-	COLOR_VERTEX_ARRAY[22] = b1 / 255.0f;
-	COLOR_VERTEX_ARRAY[23] = a1 / 255.0f;
+	COLOR_VERTEX_ARRAY[20] = r1;
+	COLOR_VERTEX_ARRAY[21] = g1;
+	COLOR_VERTEX_ARRAY[22] = b1;
+	COLOR_VERTEX_ARRAY[23] = a1;
 
 
 	fillVertexArray(x, y, w, h);
-	glColorPointer(4, GL_FLOAT, 0, COLOR_VERTEX_ARRAY);
-	drawVertexArray(0);
-
-	glEnable(GL_TEXTURE_2D);
-	glDisableClientState(GL_COLOR_ARRAY);
+	batchVertexArray(0);
 }
 
 
 void OGL_Renderer::drawBox(float x, float y, float width, float height, int r, int g, int b, int a)
 {
-	glDisable(GL_TEXTURE_2D);
-	glEnableClientState(GL_COLOR_ARRAY);
+	flushBatch(FLUSH_STATE_CHANGE);
+
+	setCapability(GL_TEXTURE_2D, false);
+	setClientState(GL_COLOR_ARRAY, true);
 
 	line(x, y, x + width, y, 1.0f, r / 255.0f, g / 255.0f, b / 255.0f, a / 255.0f);
 	line(x, y, x, y + height + 0.5f, 1.0f, r / 255.0f, g / 255.0f, b / 255.0f, a / 255.0f);
 	line(x, y + height + 0.5f, x + width, y + height + 0.5f, 1.0f, r / 255.0f, g / 255.0f, b / 255.0f, a / 255.0f);
 	line(x + width, y, x + width, y + height + 0.5f, 1.0f, r / 255.0f, g / 255.0f, b / 255.0f, a / 255.0f);
 
-	glDisableClientState(GL_COLOR_ARRAY);
-	glEnable(GL_TEXTURE_2D);
+	setClientState(GL_COLOR_ARRAY, false);
+	setCapability(GL_TEXTURE_2D, true);
 
 	glColor4ub(255, 255, 255, 255); // Reset color back to normal.
 }
@@ -408,13 +493,9 @@ void OGL_Renderer::drawBox(float x, float y, float width, float height, int r, i
 
 void OGL_Renderer::drawBoxFilled(float x, float y, float width, float height, int r, int g, int b, int a)
 {
-	glColor4ub(r, g, b, a);
-	glDisable(GL_TEXTURE_2D);
-
+	fillColorArray(r, g, b, a);
 	fillVertexArray(x, y, width, height);
-	drawVertexArray(0);
-
-	glEnable(GL_TEXTURE_2D);
+	batchVertexArray(0);
 }
 
 
@@ -422,22 +503,42 @@ void OGL_Renderer::drawText(NAS2D::Font& font, const std::string& text, float x,
 {
 	if (!font.loaded() || text.empty()) { return; }
 
-	glColor4ub(r, g, b, a);
+	// Resolve the font once for the whole string.
+	const FontInfo* info = FONT_REGISTRY.get(font.handle());
+	if (!info) { return; }
 
-	int offset = 0;
-	
-	GlyphMetricsList& gml = FONTMAP[font.name()].metrics;
+	const FontInfo& fi = *info;
+	const GlyphMetricsList& gml = fi.metrics;
 	if (gml.empty()) { return; }
-	
-	GlyphMetrics gm;
+
+	batchTexture(fi.texture_id);
+	DRAW_STATS.glyphs += static_cast<unsigned int>(text.size());
+
+	// Build the glyph run directly into the batch.
+	size_t first = BATCH_VERTEX_ARRAY.size();
+	BATCH_VERTEX_ARRAY.resize(first + text.size() * 6);
+	BatchVertex* vertex = &BATCH_VERTEX_ARRAY[first];
+
+	GLfloat w = static_cast<GLfloat>(fi.glyph_size.x());
+	GLfloat h = static_cast<GLfloat>(fi.glyph_size.y());
+
+	int offset = 0;
 	for (size_t i = 0; i < text.size(); i++)
 	{
-		gm = gml[clamp(text[i], 0, 255)];
+		const GlyphMetrics& gm = gml[clamp(text[i], 0, 255)];
 
-		fillVertexArray(x + offset, y, (float)font.glyphCellWidth(), (float)font.glyphCellHeight());
-		fillTextureArray(gm.uvX, gm.uvY, gm.uvW, gm.uvH);
+		GLfloat left = x + offset;
+		GLfloat right = left + w;
+		GLfloat bottom = y + h;
 
-		drawVertexArray(FONTMAP[font.name()].texture_id, false);
+		vertex[0] = { left, y, gm.uvX, gm.uvY, static_cast<GLubyte>(r), static_cast<GLubyte>(g), static_cast<GLubyte>(b), static_cast<GLubyte>(a) };
+		vertex[1] = { left, bottom, gm.uvX, gm.uvH, vertex[0].r, vertex[0].g, vertex[0].b, vertex[0].a };
+		vertex[2] = { right, bottom, gm.uvW, gm.uvH, vertex[0].r, vertex[0].g, vertex[0].b, vertex[0].a };
+		vertex[3] = vertex[2];
+		vertex[4] = { right, y, gm.uvW, gm.uvY, vertex[0].r, vertex[0].g, vertex[0].b, vertex[0].a };
+		vertex[5] = vertex[0];
+
+		vertex += 6;
 		offset += gm.advance + gm.minX;
 	}
 }
@@ -495,6 +596,9 @@ void OGL_Renderer::setCursor(int cursorId)
 
 void OGL_Renderer::clipRect(float x, float y, float width, float height)
 {
+	flushBatch(FLUSH_SCISSOR_CHANGE);
+	++DRAW_STATS.scissorChanges;
+
 	if (width == 0 || height == 0)
 	{
 		glDisable(GL_SCISSOR_TEST);
@@ -509,6 +613,8 @@ void OGL_Renderer::clipRect(float x, float y, float width, float height)
 
 void OGL_Renderer::clearScreen(int r, int g, int b)
 {
+	flushBatch(FLUSH_STATE_CHANGE);
+
 	glClearColor((GLfloat)r / 255, (GLfloat)g / 255, (GLfloat)b / 255, 0.0);
 	glClear(GL_COLOR_BUFFER_BIT);
 }
@@ -516,8 +622,50 @@ void OGL_Renderer::clearScreen(int r, int g, int b)
 
 void OGL_Renderer::update()
 {
+	NAS2D_PROFILE_ZONE("OGL_Renderer::update");
+
 	Renderer::update();
+	flushBatch(FLUSH_FRAME_END);
+
 	SDL_GL_SwapWindow(_WINDOW);
+
+	LAST_BATCH_COUNT = BATCH_COUNT;
+	BATCH_COUNT = 0;
+
+	for (size_t i = 0; i < FLUSH_REASON_COUNT; ++i)
+	{
+		LAST_BATCH_FLUSH_COUNTS[i] = BATCH_FLUSH_COUNTS[i];
+		BATCH_FLUSH_COUNTS[i] = 0;
+	}
+
+	drawStats(DRAW_STATS);
+	DRAW_STATS = DrawStats();
+}
+
+
+/**
+ * Gets the number of quad batches submitted to OpenGL during the last frame.
+ */
+unsigned int OGL_Renderer::batchCount() const
+{
+	return LAST_BATCH_COUNT;
+}
+
+
+/**
+ * Gets the number of times a quad batch was flushed for a given reason
+ * during the last frame.
+ *
+ * \param	reason	A BatchFlushReason.
+ */
+unsigned int OGL_Renderer::batchFlushCount(BatchFlushReason reason) const
+{
+	if (reason < 0 || reason >= FLUSH_REASON_COUNT)
+	{
+		return 0;
+	}
+
+	return LAST_BATCH_FLUSH_COUNTS[reason];
 }
 
 
@@ -601,6 +749,8 @@ bool OGL_Renderer::resizeable()
 
 void OGL_Renderer::_resize(int w, int h)
 {
+	flushBatch(FLUSH_MATRIX_CHANGE);
+
 	glViewport(0, 0, w, h);
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
@@ -667,11 +817,24 @@ void OGL_Renderer::initGL()
 
 	glEnable(GL_TEXTURE_2D);
 
+	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 
 	glVertexPointer(2, GL_FLOAT, 0, DEFAULT_VERTEX_COORDS);
 	glTexCoordPointer(2, GL_FLOAT, 0, DEFAULT_TEXTURE_COORDS);
+
+	BATCH_VERTEX_ARRAY.reserve(BATCH_INITIAL_QUADS * 6);
+
+	// Stream batches through a vertex buffer object when available, otherwise fall back to client arrays.
+	if (GLEW_VERSION_1_5)
+	{
+		glGenBuffers(1, &BATCH_VBO);
+		BATCH_VBO_MAP_RANGE = GLEW_VERSION_3_0 || GLEW_ARB_map_buffer_range;
+	}
+
+	std::cout << "\tVertex Buffers: " << (BATCH_VBO != 0 ? (BATCH_VBO_MAP_RANGE ? "Mapped" : "SubData") : "No") << std::endl;
 }
 
 
@@ -735,13 +898,18 @@ void OGL_Renderer::initVideo(unsigned int resX, unsigned int resY, unsigned int
  */
 GLuint generate_fbo(Image& image)
 {
+	ImageInfo& info = *IMAGE_REGISTRY.get(image.handle());
+
+	// Render targets can't live on a shared atlas page.
+	atlasRelease(info);
+
 	unsigned int framebuffer;
 	glGenFramebuffers(1, &framebuffer);
-	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	bindFramebuffer(framebuffer);
 
 	unsigned int textureColorbuffer;
 	glGenTextures(1, &textureColorbuffer);
-	glBindTexture(GL_TEXTURE_2D, textureColorbuffer);
+	bindTexture(textureColorbuffer);
 	GLenum textureFormat = 0;
 	textureFormat = SDL_BYTEORDER == SDL_BIG_ENDIAN ? GL_BGRA : GL_RGBA;
 
@@ -751,10 +919,10 @@ GLuint generate_fbo(Image& image)
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureColorbuffer, 0);
 
 	// Update resource management.
-	IMAGE_ID_MAP[image.name()].texture_id = textureColorbuffer;
-	IMAGE_ID_MAP[image.name()].fbo_id = framebuffer;
+	info.texture_id = textureColorbuffer;
+	info.fbo_id = framebuffer;
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	bindFramebuffer(0);
 
 	return framebuffer;
 }
@@ -765,14 +933,234 @@ GLuint generate_fbo(Image& image)
  */
 void drawVertexArray(GLuint textureId, bool defaultTextureCoords)
 {
-	glBindTexture(GL_TEXTURE_2D, textureId);
+	bindTexture(textureId);
 	glVertexPointer(2, GL_FLOAT, 0, VERTEX_ARRAY);
 
 	// Choose from the default texture coordinates or from a custom set.
 	if (defaultTextureCoords) { glTexCoordPointer(2, GL_FLOAT, 0, DEFAULT_TEXTURE_COORDS); }
 	else { glTexCoordPointer(2, GL_FLOAT, 0, TEXTURE_COORD_ARRAY); }
 
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 6);
+	drawArrays(GL_TRIANGLE_STRIP, 6);
+}
+
+
+/**
+ * Queues the quad in the vertex array to be drawn with the next batch.
+ *
+ * The pending batch is flushed first if the quad uses a different texture.
+ * Per-vertex colors are taken from COLOR_VERTEX_ARRAY.
+ */
+void batchVertexArray(GLuint textureId, bool defaultTextureCoords)
+{
+	batchTexture(textureId);
+
+	const GLfloat* textureCoords = defaultTextureCoords ? DEFAULT_TEXTURE_COORDS : TEXTURE_COORD_ARRAY;
+
+	BatchVertex vertex;
+	for (size_t i = 0; i < 6; ++i)
+	{
+		vertex.x = VERTEX_ARRAY[i * 2];
+		vertex.y = VERTEX_ARRAY[i * 2 + 1];
+		vertex.u = textureCoords[i * 2];
+		vertex.v = textureCoords[i * 2 + 1];
+		vertex.r = COLOR_VERTEX_ARRAY[i * 4];
+		vertex.g = COLOR_VERTEX_ARRAY[i * 4 + 1];
+		vertex.b = COLOR_VERTEX_ARRAY[i * 4 + 2];
+		vertex.a = COLOR_VERTEX_ARRAY[i * 4 + 3];
+
+		BATCH_VERTEX_ARRAY.push_back(vertex);
+	}
+}
+
+
+/**
+ * Sets the texture used by the pending batch, flushing it first if the
+ * texture is different.
+ */
+void batchTexture(GLuint textureId)
+{
+	if (textureId != BATCH_TEXTURE_ID)
+	{
+		flushBatch(OGL_Renderer::FLUSH_TEXTURE_CHANGE);
+		BATCH_TEXTURE_ID = textureId;
+	}
+}
+
+
+/**
+ * Copies the pending batch into the streaming vertex buffer.
+ *
+ * The buffer's data store is orphaned before every upload so that the driver
+ * can hand back fresh memory instead of waiting for previous draws that still
+ * read from it. The data store only ever grows.
+ */
+void uploadBatch()
+{
+	GLsizeiptr size = static_cast<GLsizeiptr>(BATCH_VERTEX_ARRAY.size() * sizeof(BatchVertex));
+
+	glBindBuffer(GL_ARRAY_BUFFER, BATCH_VBO);
+
+	if (size > BATCH_VBO_SIZE)
+	{
+		BATCH_VBO_SIZE = size;
+	}
+
+	glBufferData(GL_ARRAY_BUFFER, BATCH_VBO_SIZE, nullptr, GL_STREAM_DRAW);
+
+	if (BATCH_VBO_MAP_RANGE)
+	{
+		void* buffer = glMapBufferRange(GL_ARRAY_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (buffer)
+		{
+			memcpy(buffer, &BATCH_VERTEX_ARRAY[0], size);
+			if (glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE)
+			{
+				return;
+			}
+		}
+	}
+
+	// Mapping is unavailable or failed (data store contents are undefined after a failed unmap).
+	glBufferSubData(GL_ARRAY_BUFFER, 0, size, &BATCH_VERTEX_ARRAY[0]);
+}
+
+
+/**
+ * Draws all pending quads with a single draw call.
+ *
+ * \param	reason	Why the batch is being flushed. Used for statistics.
+ */
+void flushBatch(OGL_Renderer::BatchFlushReason reason)
+{
+	if (BATCH_VERTEX_ARRAY.empty())
+	{
+		return;
+	}
+
+	if (BATCH_TEXTURE_ID == 0) { setCapability(GL_TEXTURE_2D, false); }
+
+	bindTexture(BATCH_TEXTURE_ID);
+	setClientState(GL_COLOR_ARRAY, true);
+
+	// With a bound buffer object the pointers are offsets into the buffer.
+	const GLubyte* base = reinterpret_cast<const GLubyte*>(&BATCH_VERTEX_ARRAY[0]);
+	if (BATCH_VBO != 0)
+	{
+		uploadBatch();
+		base = nullptr;
+	}
+
+	glVertexPointer(2, GL_FLOAT, sizeof(BatchVertex), base + offsetof(BatchVertex, x));
+	glTexCoordPointer(2, GL_FLOAT, sizeof(BatchVertex), base + offsetof(BatchVertex, u));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(BatchVertex), base + offsetof(BatchVertex, r));
+
+	drawArrays(GL_TRIANGLES, static_cast<GLsizei>(BATCH_VERTEX_ARRAY.size()));
+	DRAW_STATS.quads += static_cast<unsigned int>(BATCH_VERTEX_ARRAY.size() / 6);
+
+	// Everything else still draws from client arrays.
+	if (BATCH_VBO != 0) { glBindBuffer(GL_ARRAY_BUFFER, 0); }
+
+	setClientState(GL_COLOR_ARRAY, false);
+	if (BATCH_TEXTURE_ID == 0) { setCapability(GL_TEXTURE_2D, true); }
+
+	BATCH_VERTEX_ARRAY.clear();
+
+	++BATCH_COUNT;
+	++BATCH_FLUSH_COUNTS[reason];
+}
+
+
+/**
+ * Submits a draw call from the current vertex arrays and counts it.
+ */
+void drawArrays(GLenum mode, GLsizei count)
+{
+	glDrawArrays(mode, 0, count);
+
+	++DRAW_STATS.drawCalls;
+	DRAW_STATS.vertices += static_cast<unsigned int>(count);
+}
+
+
+/**
+ * Binds a 2D texture and counts the bind.
+ */
+void bindTexture(GLuint textureId)
+{
+	glBindTexture(GL_TEXTURE_2D, textureId);
+	++DRAW_STATS.textureBinds;
+}
+
+
+/**
+ * Binds a framebuffer and counts the switch. 0 binds the window.
+ */
+void bindFramebuffer(GLuint fbo)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	++DRAW_STATS.framebufferSwitches;
+}
+
+
+/**
+ * Enables or disables an OpenGL capability and counts the state change.
+ */
+void setCapability(GLenum capability, bool enabled)
+{
+	if (enabled) { glEnable(capability); }
+	else { glDisable(capability); }
+
+	++DRAW_STATS.stateChanges;
+}
+
+
+/**
+ * Enables or disables a client side array and counts the state change.
+ */
+void setClientState(GLenum array, bool enabled)
+{
+	if (enabled) { glEnableClientState(array); }
+	else { glDisableClientState(array); }
+
+	++DRAW_STATS.stateChanges;
+}
+
+
+/**
+ * Fills the color array with a single color for all six verts.
+ */
+void fillColorArray(int r, int g, int b, int a)
+{
+	for (size_t i = 0; i < 24; i += 4)
+	{
+		COLOR_VERTEX_ARRAY[i] = static_cast<GLubyte>(r);
+		COLOR_VERTEX_ARRAY[i + 1] = static_cast<GLubyte>(g);
+		COLOR_VERTEX_ARRAY[i + 2] = static_cast<GLubyte>(b);
+		COLOR_VERTEX_ARRAY[i + 3] = static_cast<GLubyte>(a);
+	}
+}
+
+
+/**
+ * Rotates the vertex array about the origin by a given number of degrees
+ * and then translates it to x, y.
+ *
+ * Equivalent to glTranslatef(x, y, 0) followed by glRotatef(degrees, 0, 0, 1).
+ */
+void rotateVertexArray(GLfloat x, GLfloat y, GLfloat degrees)
+{
+	GLfloat rad = degrees * DEG2RAD;
+	GLfloat c = cosf(rad);
+	GLfloat s = sinf(rad);
+
+	for (size_t i = 0; i < 12; i += 2)
+	{
+		GLfloat vx = VERTEX_ARRAY[i];
+		GLfloat vy = VERTEX_ARRAY[i + 1];
+
+		VERTEX_ARRAY[i] = vx * c - vy * s + x;
+		VERTEX_ARRAY[i + 1] = vx * s + vy * c + y;
+	}
 }
 
 
@@ -791,6 +1179,34 @@ void fillVertexArray(GLfloat x, GLfloat y, GLfloat w, GLfloat h)
 }
 
 
+/**
+ * Gets the shared data of an Image.
+ *
+ * Images without valid shared data (e.g., the default Image) get an empty
+ * ImageInfo which draws untextured.
+ */
+const ImageInfo& imageInfo(const Image& image)
+{
+	static const ImageInfo EMPTY_IMAGE_INFO;
+
+	const ImageInfo* info = IMAGE_REGISTRY.get(image.handle());
+	return info ? *info : EMPTY_IMAGE_INFO;
+}
+
+
+/**
+ * Fills a texture coordinate array with coordinates given relative to an image,
+ * mapped into the texture the image lives in (its own texture or an atlas page).
+ */
+void fillImageTextureArray(const ImageInfo& info, GLfloat x, GLfloat y, GLfloat u, GLfloat v)
+{
+	GLfloat w = info.u1 - info.u0;
+	GLfloat h = info.v1 - info.v0;
+
+	fillTextureArray(info.u0 + x * w, info.v0 + y * h, info.u0 + u * w, info.v0 + v * h);
+}
+
+
 /**
  * Fills a texture coordinate array with quad vertex information.
  */
@@ -948,7 +1364,7 @@ void line(float x1, float y1, float x2, float y2, float w, float Cr, float Cg, f
 	};
 
 	glColorPointer(4, GL_FLOAT, 0, line_color);
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 8);
+	drawArrays(GL_TRIANGLE_STRIP, 8);
 
 	// Line End Caps
 	if (w > 3.0f) // <<< Arbitrary number.
@@ -986,6 +1402,6 @@ void line(float x1, float y1, float x2, float y2, float w, float Cr, float Cg, f
 			Cr, Cg, Cb, 0
 		};
 		glColorPointer(4, GL_FLOAT, 0, line_color);
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 12);
+		drawArrays(GL_TRIANGLE_STRIP, 12);
 	}
 }
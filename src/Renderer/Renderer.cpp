@@ -13,6 +13,7 @@
 #include "NAS2D/Common.h"
 #include "NAS2D/Timer.h"
 
+#include <algorithm>
 #include <iostream>
 
 using namespace NAS2D;
@@ -949,7 +950,7 @@ void Renderer::update()
 {
 	if (CURRENT_FADE != FADE_NONE)
 	{
-		float fade = (_TIMER.delta() * mFadeStep) * CURRENT_FADE;
+		float fade = static_cast<float>(_TIMER.preciseDelta() * mFadeStep) * CURRENT_FADE;
 
 		mCurrentFade += fade;
 
@@ -966,3 +967,68 @@ void Renderer::update()
 		drawBoxFilled(0, 0, width(), height(), mFadeColor.red(), mFadeColor.green(), mFadeColor.blue(), static_cast<int>(mCurrentFade));
 	}
 }
+
+
+/**
+ * Gets the draw statistics of the last complete frame.
+ *
+ * Statistics are updated once per frame by update() so they can be read at
+ * any point during the following frame.
+ */
+const Renderer::DrawStats& Renderer::drawStats() const
+{
+	return mDrawStats;
+}
+
+
+/**
+ * Draws the draw statistics of the last complete frame as a block of text.
+ *
+ * \param	font	Font to draw the statistics with.
+ * \param	x		X-Coordinate of the upper left corner of the overlay.
+ * \param	y		Y-Coordinate of the upper left corner of the overlay.
+ *
+ * \note	The overlay's own drawing is included in the statistics of the
+ *			frame it's drawn in.
+ */
+void Renderer::drawStatsOverlay(Font& font, float x, float y)
+{
+	const int PADDING = 4;
+
+	const std::string lines[] =
+	{
+		"Draw Calls: " + std::to_string(mDrawStats.drawCalls),
+		"Quads: " + std::to_string(mDrawStats.quads),
+		"Vertices: " + std::to_string(mDrawStats.vertices),
+		"Texture Binds: " + std::to_string(mDrawStats.textureBinds),
+		"State Changes: " + std::to_string(mDrawStats.stateChanges),
+		"Scissor Changes: " + std::to_string(mDrawStats.scissorChanges),
+		"Framebuffer Switches: " + std::to_string(mDrawStats.framebufferSwitches),
+		"Glyphs: " + std::to_string(mDrawStats.glyphs)
+	};
+
+	int width = 0;
+	for (const std::string& line : lines)
+	{
+		width = std::max(width, font.width(line));
+	}
+
+	int lineCount = static_cast<int>(sizeof(lines) / sizeof(lines[0]));
+	drawBoxFilled(x, y, static_cast<float>(width + PADDING * 2), static_cast<float>(font.height() * lineCount + PADDING * 2), 0, 0, 0, 180);
+
+	for (int i = 0; i < lineCount; ++i)
+	{
+		drawText(font, lines[i], x + PADDING, y + PADDING + static_cast<float>(font.height() * i), 255, 255, 255);
+	}
+}
+
+
+/**
+ * Sets the draw statistics of the last complete frame.
+ *
+ * Called by derived Renderers once per frame after the frame is presented.
+ */
+void Renderer::drawStats(const DrawStats& stats)
+{
+	mDrawStats = stats;
+}
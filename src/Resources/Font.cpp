@@ -9,6 +9,7 @@
 // ==================================================================================
 #include "NAS2D/Resources/Font.h"
 #include "NAS2D/Resources/FontInfo.h"
+#include "NAS2D/Resources/ResourceRegistry.h"
 
 #include "NAS2D/Exception.h"
 #include "NAS2D/Filesystem.h"
@@ -21,6 +22,7 @@
 
 #include <iostream>
 #include <math.h>
+#include <mutex>
 
 using namespace NAS2D;
 using namespace NAS2D::Exception;
@@ -37,7 +39,8 @@ const int	GLYPH_MATRIX_SIZE	= 16;
 const int	BITS_32				= 32;
 
 
-std::map<std::string, FontInfo>	FONTMAP;
+ResourceRegistry<FontInfo>	FONT_REGISTRY;
+std::mutex					TTF_MUTEX;			/*< Serializes calls into SDL_TTF. */
 
 
 extern unsigned int generateTexture(void *buffer, int bytesPerPixel, int width, int height);
@@ -45,12 +48,16 @@ extern unsigned int generateTexture(void *buffer, int bytesPerPixel, int width,
 // ==================================================================================
 // = UNEXPOSED FUNCTION PROTOTYPES
 // ==================================================================================
-bool load(const std::string& path, unsigned int ptSize);
-bool loadBitmap(const std::string& path, int glyphWidth, int glyphHeight, int glyphSpace);
-Point_2d generateGlyphMap(TTF_Font* ft, const std::string& name, unsigned int font_size);
-bool fontAlreadyLoaded(const std::string& name);
+ResourceHandle load(const std::string& path, unsigned int ptSize);
+ResourceHandle loadBitmap(const std::string& path, int glyphWidth, int glyphHeight, int glyphSpace);
+void* decodeFont(const std::string& path, unsigned int ptSize, FontInfo& info);
+void* decodeBitmapFont(const std::string& path, int glyphWidth, int glyphHeight, int glyphSpace, FontInfo& info);
+ResourceHandle registerFont(const std::string& name, FontInfo& info, void* glyphMap);
+SDL_Surface* generateGlyphMap(TTF_Font* ft, FontInfo& fontInfo);
+ResourceHandle fontAlreadyLoaded(const std::string& name);
+const FontInfo& fontInfo(const ResourceHandle& handle);
 void setupMasks(unsigned int& rmask, unsigned int& gmask, unsigned int& bmask, unsigned int& amask);
-void updateFontReferenceCount(const std::string& name);
+void updateFontReferenceCount(const ResourceHandle& handle);
 
 
 unsigned nextPowerOf2(unsigned n)
@@ -68,7 +75,8 @@ unsigned nextPowerOf2(unsigned n)
  */
 NAS2D::Font::Font(const std::string& filePath, int ptSize) :	Resource(filePath)
 {
-	loaded(::load(name(), ptSize));
+	handle(::load(name(), ptSize));
+	loaded(handle().valid());
 	name(name() + string_format("_%ipt", ptSize));
 }
 
@@ -84,7 +92,8 @@ NAS2D::Font::Font(const std::string& filePath, int ptSize) :	Resource(filePath)
  */
 NAS2D::Font::Font(const std::string& filePath, int glyphWidth, int glyphHeight, int glyphSpace) :	Resource(filePath)
 {
-	loaded(loadBitmap(filePath, glyphWidth, glyphHeight, glyphSpace));
+	handle(loadBitmap(filePath, glyphWidth, glyphHeight, glyphSpace));
+	loaded(handle().valid());
 }
 
 
@@ -102,27 +111,36 @@ NAS2D::Font::Font() :	Resource("Default Font")
  *
  * \param	rhs	Font to copy.
  */
-NAS2D::Font::Font(const Font& rhs) : Resource(rhs.name())
+NAS2D::Font::Font(const Font& rhs) : Resource(rhs)
 {
-	auto it = FONTMAP.find(name());
-	if (it != FONTMAP.end())
+	FontInfo* info = FONT_REGISTRY.get(handle());
+	if (info)
 	{
-		++it->second.ref_count;
-		loaded(rhs.loaded());
+		++info->ref_count;
 	}
 	else
 	{
+		handle(ResourceHandle());
 		loaded(false);
 	}
 }
 
 
+/**
+ * Move c'tor.
+ *
+ * \param	rhs	Font to move. Left without font data.
+ */
+NAS2D::Font::Font(Font&& rhs) noexcept : Resource(std::move(rhs))
+{}
+
+
 /**
 * D'tor
 */
 NAS2D::Font::~Font()
 {
-	updateFontReferenceCount(name());
+	updateFontReferenceCount(handle());
 }
 
 
@@ -135,15 +153,34 @@ NAS2D::Font& NAS2D::Font::operator=(const Font& rhs)
 {
 	if (this == &rhs) { return *this; }
 
-	updateFontReferenceCount(name());
+	updateFontReferenceCount(handle());
+
+	Resource::operator=(rhs);
 
-	name(rhs.name());
+	// Fonts that were never loaded (e.g., the default Font) have no handle.
+	if (!handle().valid()) { return *this; }
 
-	auto it = FONTMAP.find(name());
-	if (it == FONTMAP.end()) { throw font_bad_data(); }
+	FontInfo* info = FONT_REGISTRY.get(handle());
+	if (!info) { throw font_bad_data(); }
 
-	++it->second.ref_count;
-	loaded(rhs.loaded());
+	++info->ref_count;
+
+	return *this;
+}
+
+
+/**
+ * Move assignment operator.
+ *
+ * \param rhs Font to move. Left without font data.
+ */
+NAS2D::Font& NAS2D::Font::operator=(Font&& rhs) noexcept
+{
+	if (this == &rhs) { return *this; }
+
+	updateFontReferenceCount(handle());
+
+	Resource::operator=(std::move(rhs));
 
 	return *this;
 }
@@ -154,7 +191,7 @@ NAS2D::Font& NAS2D::Font::operator=(const Font& rhs)
  */
 const int NAS2D::Font::glyphCellWidth() const
 {
-	return FONTMAP[name()].glyph_size.x();
+	return fontInfo(handle()).glyph_size.x();
 }
 
 
@@ -163,7 +200,7 @@ const int NAS2D::Font::glyphCellWidth() const
  */
 const int NAS2D::Font::glyphCellHeight() const
 {
-	return FONTMAP[name()].glyph_size.y();
+	return fontInfo(handle()).glyph_size.y();
 }
 
 
@@ -177,7 +214,7 @@ int NAS2D::Font::width(const std::string& str) const
 	if (str.empty()) { return 0; }
 
 	int width = 0;
-	GlyphMetricsList& gml = FONTMAP[name()].metrics;
+	const GlyphMetricsList& gml = fontInfo(handle()).metrics;
 	if (gml.empty()) { return 0; }
 
 	for (size_t i = 0; i < str.size(); i++)
@@ -195,7 +232,7 @@ int NAS2D::Font::width(const std::string& str) const
  */
 int NAS2D::Font::height() const
 {
-	return FONTMAP[name()].height;
+	return fontInfo(handle()).height;
 }
 
 
@@ -204,7 +241,7 @@ int NAS2D::Font::height() const
  */
 int NAS2D::Font::ascent() const
 {
-	return FONTMAP[name()].ascent;
+	return fontInfo(handle()).ascent;
 }
 
 
@@ -213,7 +250,7 @@ int NAS2D::Font::ascent() const
  */
 int NAS2D::Font::ptSize() const
 {
-	return FONTMAP[name()].pt_size;
+	return fontInfo(handle()).pt_size;
 }
 
 
@@ -228,86 +265,155 @@ int NAS2D::Font::ptSize() const
  * \param	path	Path to the TTF or OTF font file.
  * \param	ptSize	Point size to use when loading the font.
  */
-bool load(const std::string& path, unsigned int ptSize)
+ResourceHandle load(const std::string& path, unsigned int ptSize)
 {
 	std::string fontname = path + string_format("_%ipt", ptSize);
-	if (fontAlreadyLoaded(fontname))
+	ResourceHandle handle = fontAlreadyLoaded(fontname);
+	if (handle.valid())
 	{
-		++FONTMAP[fontname].ref_count;
-		return true;
+		++FONT_REGISTRY.get(handle)->ref_count;
+		return handle;
 	}
 
-	if (TTF_WasInit() == 0)
+	FontInfo info;
+	void* glyphMap = decodeFont(path, ptSize, info);
+	if (!glyphMap)
 	{
-		if (TTF_Init() != 0)
-		{
-			std::cout << "Font::load(): " << TTF_GetError() << std::endl;
-			return false;
-		}
+		return ResourceHandle();
+	}
+
+	handle = registerFont(fontname, info, glyphMap);
+	++FONT_REGISTRY.get(handle)->ref_count;
+
+	return handle;
+}
+
+
+/**
+ * Internal function that loads a bitmap font from an file.
+ *
+ * \param	path		Path to the image file.
+ * \param	glyphWidth	Width of glyphs in the bitmap font.
+ * \param	glyphHeight	Height of the glyphs in the bitmap font.
+ * \param	glyphSpace	Spacing to use when drawing glyphs.
+ */
+ResourceHandle loadBitmap(const std::string& path, int glyphWidth, int glyphHeight, int glyphSpace)
+{
+	ResourceHandle handle = fontAlreadyLoaded(path);
+	if (handle.valid())
+	{
+		++FONT_REGISTRY.get(handle)->ref_count;
+		return handle;
 	}
 
+	FontInfo info;
+	void* glyphMap = decodeBitmapFont(path, glyphWidth, glyphHeight, glyphSpace, info);
+	if (!glyphMap)
+	{
+		return ResourceHandle();
+	}
+
+	handle = registerFont(path, info, glyphMap);
+	++FONT_REGISTRY.get(handle)->ref_count;
+
+	return handle;
+}
+
+
+/**
+ * Reads a TrueType or OpenType font from a file and renders its glyph map.
+ *
+ * Does not touch OpenGL or the font registry so it's safe to call from any
+ * thread.
+ *
+ * \param	path	Path to the TTF or OTF font file.
+ * \param	ptSize	Point size to use when loading the font.
+ * \param	info	FontInfo to fill with the font's metrics.
+ *
+ * \return	Pointer to an SDL_Surface containing the glyph map or \c nullptr on failure.
+ */
+void* decodeFont(const std::string& path, unsigned int ptSize, FontInfo& info)
+{
 	File fontBuffer = Utility<Filesystem>::get().open(path);
 	if (fontBuffer.empty())
 	{
-		return false;
+		return nullptr;
+	}
+
+	// SDL_TTF is not thread safe.
+	std::lock_guard<std::mutex> lock(TTF_MUTEX);
+
+	if (TTF_WasInit() == 0)
+	{
+		if (TTF_Init() != 0)
+		{
+			std::cout << "Font::load(): " << TTF_GetError() << std::endl;
+			return nullptr;
+		}
 	}
 
 	TTF_Font *font = TTF_OpenFontRW(SDL_RWFromConstMem(fontBuffer.raw_bytes(), static_cast<int>(fontBuffer.size())), 0, ptSize);
 	if (!font)
 	{
 		std::cout << "Font::load(): " << TTF_GetError() << std::endl;
-		return false;
+		return nullptr;
 	}
 
-	FONTMAP[fontname].height = TTF_FontHeight(font);
-	FONTMAP[fontname].ascent = TTF_FontAscent(font);
-	FONTMAP[fontname].glyph_size = generateGlyphMap(font, fontname, ptSize);
+	info.height = TTF_FontHeight(font);
+	info.ascent = TTF_FontAscent(font);
+	info.pt_size = ptSize;
+
+	SDL_Surface* glyphMap = generateGlyphMap(font, info);
 	TTF_CloseFont(font);
 
-	return true;
+	return glyphMap;
 }
 
 
 /**
- * Internal function that loads a bitmap font from an file.
+ * Reads a bitmap font from an image file and builds its glyph metrics.
+ *
+ * Does not touch OpenGL or the font registry so it's safe to call from any
+ * thread.
  *
  * \param	path		Path to the image file.
  * \param	glyphWidth	Width of glyphs in the bitmap font.
  * \param	glyphHeight	Height of the glyphs in the bitmap font.
  * \param	glyphSpace	Spacing to use when drawing glyphs.
+ * \param	info		FontInfo to fill with the font's metrics.
+ *
+ * \return	Pointer to an SDL_Surface containing the glyph map or \c nullptr on failure.
  */
-bool loadBitmap(const std::string& path, int glyphWidth, int glyphHeight, int glyphSpace)
+void* decodeBitmapFont(const std::string& path, int glyphWidth, int glyphHeight, int glyphSpace, FontInfo& info)
 {
-	if (fontAlreadyLoaded(path))
-	{
-		++FONTMAP[path].ref_count;
-		return true;
-	}
-
 	File fontBuffer = Utility<Filesystem>::get().open(path);
 	if (fontBuffer.empty())
 	{
-		return false;
+		return nullptr;
 	}
 
 	SDL_Surface* glyphMap = IMG_Load_RW(SDL_RWFromConstMem(fontBuffer.raw_bytes(), static_cast<int>(fontBuffer.size())), 0);
 	if (!glyphMap)
 	{
 		std::cout << "Font::loadBitmap(): " << SDL_GetError() << std::endl;
-		return false;
+		return nullptr;
 	}
 
 	if (glyphMap->w / GLYPH_MATRIX_SIZE != glyphWidth)
 	{
-		throw font_invalid_glyph_map(string_format("image width is %i, expected %i.", glyphMap->w, glyphWidth * GLYPH_MATRIX_SIZE));
+		int width = glyphMap->w;
+		SDL_FreeSurface(glyphMap);
+		throw font_invalid_glyph_map(string_format("image width is %i, expected %i.", width, glyphWidth * GLYPH_MATRIX_SIZE));
 	}
 
 	if (glyphMap->h / GLYPH_MATRIX_SIZE != glyphHeight)
 	{
-		throw font_invalid_glyph_map(string_format("image height is %i, expected %i.", glyphMap->h, glyphHeight * GLYPH_MATRIX_SIZE));
+		int height = glyphMap->h;
+		SDL_FreeSurface(glyphMap);
+		throw font_invalid_glyph_map(string_format("image height is %i, expected %i.", height, glyphHeight * GLYPH_MATRIX_SIZE));
 	}
 
-	GlyphMetricsList& glm = FONTMAP[path].metrics;
+	GlyphMetricsList& glm = info.metrics;
 	glm.resize(ASCII_TABLE_COUNT);
 	for (size_t i = 0; i < glm.size(); ++i)
 	{
@@ -329,17 +435,61 @@ bool loadBitmap(const std::string& path, int glyphWidth, int glyphHeight, int gl
 		}
 	}
 
-	unsigned int texture_id = generateTexture(glyphMap->pixels, glyphMap->format->BytesPerPixel, glyphMap->w, glyphMap->h);
+	info.pt_size = glyphHeight;
+	info.height = glyphHeight;
+	info.glyph_size(glyphWidth, glyphHeight);
+
+	return glyphMap;
+}
 
-	// Add generated texture id to texture ID map.
-	FONTMAP[path].texture_id = texture_id;
-	FONTMAP[path].pt_size = glyphHeight;
-	FONTMAP[path].height = glyphHeight;
-	FONTMAP[path].ref_count++;
-	FONTMAP[path].glyph_size(glyphWidth, glyphHeight);
-	SDL_FreeSurface(glyphMap);
 
-	return true;
+/**
+ * Adds a decoded font to the registry and uploads its glyph map to the GPU.
+ *
+ * The glyph map surface is freed. If a font with the same name has already been
+ * registered the existing entry is used instead. Nothing is registered if the
+ * glyph map can't be uploaded. The reference count of the entry
+ * is not changed.
+ *
+ * \param	name		Name of the font.
+ * \param	info		Metrics of the font as filled in by decodeFont() or decodeBitmapFont().
+ * \param	glyphMap	Pointer to an SDL_Surface containing the glyph map.
+ *
+ * \note	Must be called from the thread that owns the OpenGL context.
+ */
+ResourceHandle registerFont(const std::string& name, FontInfo& info, void* glyphMap)
+{
+	SDL_Surface* pixels = static_cast<SDL_Surface*>(glyphMap);
+
+	ResourceHandle handle = fontAlreadyLoaded(name);
+	if (handle.valid())
+	{
+		SDL_FreeSurface(pixels);
+		return handle;
+	}
+
+	// Upload first so that an unsupported glyph map doesn't leave an entry behind.
+	unsigned int textureId = 0;
+	try
+	{
+		textureId = generateTexture(pixels->pixels, pixels->format->BytesPerPixel, pixels->w, pixels->h);
+	}
+	catch (...)
+	{
+		SDL_FreeSurface(pixels);
+		throw;
+	}
+
+	SDL_FreeSurface(pixels);
+
+	handle = FONT_REGISTRY.insert(name);
+
+	FontInfo& record = *FONT_REGISTRY.get(handle);
+	record = info;
+	record.texture_id = textureId;
+	record.ref_count = 0;
+
+	return handle;
 }
 
 
@@ -347,12 +497,14 @@ bool loadBitmap(const std::string& path, int glyphWidth, int glyphHeight, int gl
  * Generates a glyph map of all ASCII standard characters from 0 - 255.
  *
  * Internal function used to generate a glyph texture map from an TTF_Font struct.
+ *
+ * \return	Pointer to an SDL_Surface containing the glyph map.
  */
-Point_2d generateGlyphMap(TTF_Font* ft, const std::string& name, unsigned int font_size)
+SDL_Surface* generateGlyphMap(TTF_Font* ft, FontInfo& fontInfo)
 {
 	int largest_width = 0;
 
-	GlyphMetricsList& glm = FONTMAP[name].metrics;
+	GlyphMetricsList& glm = fontInfo.metrics;
 
 	// Go through each glyph and determine how much space we need in the texture.
 	for (int i = 0; i < ASCII_TABLE_COUNT; i++)
@@ -419,15 +571,9 @@ Point_2d generateGlyphMap(TTF_Font* ft, const std::string& name, unsigned int fo
 		}
 	}
 
-	unsigned int texture_id = generateTexture(glyphMap->pixels, glyphMap->format->BytesPerPixel, glyphMap->w, glyphMap->h);
+	fontInfo.glyph_size = size;
 
-	// Add generated texture id to texture ID map.
-	FONTMAP[name].texture_id = texture_id;
-	FONTMAP[name].pt_size = font_size;
-	FONTMAP[name].ref_count++;
-	SDL_FreeSurface(glyphMap);
-
-	return size;
+	return glyphMap;
 }
 
 
@@ -436,16 +582,26 @@ Point_2d generateGlyphMap(TTF_Font* ft, const std::string& name, unsigned int fo
  * been loaded.
  *
  * \param	name	Name of the Font to check against.
+ *
+ * \return	Handle of the Font if it's loaded. An invalid handle otherwise.
  */
-bool fontAlreadyLoaded(const std::string& name)
+ResourceHandle fontAlreadyLoaded(const std::string& name)
 {
-	auto it = FONTMAP.find(name);
-	if (it != FONTMAP.end())
-	{
-		return true;
-	}
+	return FONT_REGISTRY.find(name);
+}
+
 
-	return false;
+/**
+ * Internal utility function used to get the shared data of a Font.
+ *
+ * \return	The Font's data or an empty FontInfo if the handle is invalid.
+ */
+const FontInfo& fontInfo(const ResourceHandle& handle)
+{
+	static const FontInfo EMPTY_FONT_INFO;
+
+	const FontInfo* info = FONT_REGISTRY.get(handle);
+	return info ? *info : EMPTY_FONT_INFO;
 }
 
 
@@ -469,28 +625,32 @@ void setupMasks(unsigned int& rmask, unsigned int& gmask, unsigned int& bmask, u
  * Internal function used to clean up references to fonts when the Font
  * destructor or copy assignment operators are called.
  *
- * \param	name	Name of the Font to check against.
+ * \param	handle	Handle of the Font to check against.
  */
-void updateFontReferenceCount(const std::string& name)
+void updateFontReferenceCount(const ResourceHandle& handle)
 {
-	auto it = FONTMAP.find(name);
-	if (it == FONTMAP.end())
+	// Fonts that never loaded have nothing to clean up.
+	if (!handle.valid()) { return; }
+
+	FontInfo* info = FONT_REGISTRY.get(handle);
+	if (!info)
 	{
-		std::cout << "Font '" << name << "' was not found in the resource management." << std::endl;
+		std::cout << "Font was not found in the resource management." << std::endl;
 		return;
 	}
 
-	--it->second.ref_count;
+	--info->ref_count;
 
 	// if texture id reference count is 0, delete the texture.
-	if (it->second.ref_count < 1)
+	if (info->ref_count < 1)
 	{
-		glDeleteTextures(1, &it->second.texture_id);
-		FONTMAP.erase(it);
+		glDeleteTextures(1, &info->texture_id);
+		FONT_REGISTRY.release(handle);
 	}
 
-	if (FONTMAP.empty())
+	if (FONT_REGISTRY.empty())
 	{
+		std::lock_guard<std::mutex> lock(TTF_MUTEX);
 		TTF_Quit();
 	}
 }
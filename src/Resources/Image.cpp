@@ -9,6 +9,7 @@
 // ==================================================================================
 #include "NAS2D/Resources/Image.h"
 #include "NAS2D/Resources/ImageInfo.h"
+#include "NAS2D/Resources/ResourceRegistry.h"
 
 #include "NAS2D/Exception.h"
 #include "NAS2D/Filesystem.h"
@@ -20,7 +21,6 @@
 #include <SDL_image.h>
 
 #include <iostream>
-#include <map>
 #include <string>
 
 using namespace NAS2D;
@@ -30,17 +30,23 @@ const std::string DEFAULT_IMAGE_NAME	= "Default Image";
 const std::string ARBITRARY_IMAGE_NAME	= "arbitrary_image_";
 
 
-typedef std::map<std::string, ImageInfo> TextureIdMap;
-
-TextureIdMap	IMAGE_ID_MAP;			/*< Lookup table for OpenGL Texture ID's. */
-int				IMAGE_ARBITRARY = 0;	/*< Counter for arbitrary image ID's. */
+ResourceRegistry<ImageInfo>		IMAGE_REGISTRY;			/*< Lookup table for OpenGL Texture ID's. */
+int								IMAGE_ARBITRARY = 0;	/*< Counter for arbitrary image ID's. */
 
 // ==================================================================================
 // = UNEXPOSED FUNCTION PROTOTYPES
 // ==================================================================================
-bool checkTextureId(const std::string& name);
+ResourceHandle checkTextureId(const std::string& name);
+ResourceHandle registerImage(const std::string& name, void* surface);
 unsigned int generateTexture(void *buffer, int bytesPerPixel, int width, int height);
-void updateImageReferenceCount(const std::string& name);
+void updateImageReferenceCount(const ResourceHandle& handle);
+
+bool atlasImage(ImageInfo& info, void* buffer, int bytesPerPixel, int width, int height, int pitch);
+void atlasRelease(ImageInfo& info);
+
+void cachePixels(const ResourceHandle& handle, ImageInfo& info);
+void* lockPixels(const ResourceHandle& handle, ImageInfo& info, const std::string& name);
+void freePixels(ImageInfo& info);
 
 
 /**
@@ -75,10 +81,13 @@ Image::Image(int width, int height) : Resource(ARBITRARY_IMAGE_NAME)
 	_size = std::make_pair(width, height);
 
 	// Update resource management.
-	IMAGE_ID_MAP[name()].texture_id = 0;
-	IMAGE_ID_MAP[name()].w = width;
-	IMAGE_ID_MAP[name()].h = height;
-	IMAGE_ID_MAP[name()].ref_count++;
+	handle(IMAGE_REGISTRY.insert(name()));
+
+	ImageInfo& info = *IMAGE_REGISTRY.get(handle());
+	info.texture_id = 0;
+	info.w = width;
+	info.h = height;
+	info.ref_count++;
 }
 
 
@@ -107,14 +116,22 @@ Image::Image(void* buffer, int bytesPerPixel, int width, int height) : Resource(
 	SDL_Surface* pixels = SDL_CreateRGBSurfaceFrom(buffer, width, height, bytesPerPixel * 4, 0, 0, 0, 0, SDL_BYTEORDER == SDL_BIG_ENDIAN ? 0x000000FF : 0xFF000000);
 
 	_size = std::make_pair(width, height);
-	unsigned int texture_id = generateTexture(buffer, bytesPerPixel, width, height);
 
 	// Update resource management.
-	IMAGE_ID_MAP[name()].texture_id = texture_id;
-	IMAGE_ID_MAP[name()].w = width;
-	IMAGE_ID_MAP[name()].h = height;
-	IMAGE_ID_MAP[name()].ref_count++;
-	IMAGE_ID_MAP[name()].pixels = pixels;
+	handle(IMAGE_REGISTRY.insert(name()));
+
+	ImageInfo& info = *IMAGE_REGISTRY.get(handle());
+	if (!atlasImage(info, buffer, bytesPerPixel, width, height, width * bytesPerPixel))
+	{
+		info.texture_id = generateTexture(buffer, bytesPerPixel, width, height);
+	}
+
+	info.w = width;
+	info.h = height;
+	info.ref_count++;
+	info.pixels = pixels;
+
+	cachePixels(handle(), info);
 }
 
 
@@ -123,24 +140,36 @@ Image::Image(void* buffer, int bytesPerPixel, int width, int height) : Resource(
  *
  * \param	src		Image to copy.
  */
-Image::Image(const Image &src) : Resource(src.name()), _size(src._size)
+Image::Image(const Image &src) : Resource(src), _size(src._size)
 {
 	if (!src.loaded())
 	{
 		throw image_bad_copy();
 	}
 
-	loaded(src.loaded());
-	IMAGE_ID_MAP[name()].ref_count++;
+	ImageInfo* info = IMAGE_REGISTRY.get(handle());
+	if (info) { ++info->ref_count; }
 }
 
 
+/**
+ * Move c'tor.
+ *
+ * Takes over the reference to the shared image data. Unlike copying, moving
+ * an Image that isn't loaded is allowed.
+ *
+ * \param	src		Image to move. Left without image data.
+ */
+Image::Image(Image&& src) noexcept : Resource(std::move(src)), _size(src._size)
+{}
+
+
 /**
  * D'tor
  */
 Image::~Image()
 {
-	updateImageReferenceCount(name());
+	updateImageReferenceCount(handle());
 }
 
 
@@ -153,19 +182,39 @@ Image& Image::operator=(const Image& rhs)
 {
 	if (this == &rhs) { return *this; }
 
-	updateImageReferenceCount(name());
+	updateImageReferenceCount(handle());
 
-	name(rhs.name());
+	Resource::operator=(rhs);
 	_size = rhs._size;
 
-	auto it = IMAGE_ID_MAP.find(name());
-	if (it == IMAGE_ID_MAP.end())
+	// Images without shared data (e.g., the default Image) have no handle.
+	if (!handle().valid()) { return *this; }
+
+	ImageInfo* info = IMAGE_REGISTRY.get(handle());
+	if (!info)
 	{
 		throw image_bad_data();
 	}
 
-	loaded(rhs.loaded());
-	++it->second.ref_count;
+	++info->ref_count;
+
+	return *this;
+}
+
+
+/**
+ * Move assignment operator.
+ *
+ * \param	rhs		Image to move. Left without image data.
+ */
+Image& Image::operator=(Image&& rhs) noexcept
+{
+	if (this == &rhs) { return *this; }
+
+	updateImageReferenceCount(handle());
+
+	Resource::operator=(std::move(rhs));
+	_size = rhs._size;
 
 	return *this;
 }
@@ -178,9 +227,11 @@ Image& Image::operator=(const Image& rhs)
  */
 void Image::load()
 {
-	if (checkTextureId(name()))
+	handle(checkTextureId(name()));
+	if (handle().valid())
 	{
-		_size = std::make_pair(IMAGE_ID_MAP[name()].w, IMAGE_ID_MAP[name()].h);
+		ImageInfo& info = *IMAGE_REGISTRY.get(handle());
+		_size = std::make_pair(info.w, info.h);
 		loaded(true);
 		return;
 	}
@@ -203,17 +254,11 @@ void Image::load()
 		return;
 	}
 
-	_size = std::make_pair(pixels->w, pixels->h);
-
-	unsigned int texture_id = generateTexture(pixels->pixels, pixels->format->BytesPerPixel, pixels->w, pixels->h);
+	handle(registerImage(name(), pixels));
 
-	// Add generated texture id to texture ID map.
-	IMAGE_ID_MAP[name()].texture_id = texture_id;
-	IMAGE_ID_MAP[name()].w = width();
-	IMAGE_ID_MAP[name()].h = height();
-	IMAGE_ID_MAP[name()].ref_count++;
-
-	IMAGE_ID_MAP[name()].pixels = pixels;
+	ImageInfo& info = *IMAGE_REGISTRY.get(handle());
+	_size = std::make_pair(info.w, info.h);
+	info.ref_count++;
 
 	loaded(true);
 }
@@ -250,8 +295,11 @@ Color_4ub Image::pixelColor(int x, int y) const
 		return Color_4ub(0, 0, 0, 255);
 	}
 
-	SDL_Surface* pixels = static_cast<SDL_Surface*>(IMAGE_ID_MAP[name()].pixels);
+	ImageInfo* info = IMAGE_REGISTRY.get(handle());
+	if (!info) { throw image_null_data(); }
 
+	// Pixels may have been dropped by the ImageCache and have to be read back.
+	SDL_Surface* pixels = static_cast<SDL_Surface*>(lockPixels(handle(), *info, name()));
 	if (!pixels) { throw image_null_data(); }
 
 	SDL_LockSurface(pixels);
@@ -286,6 +334,7 @@ Color_4ub Image::pixelColor(int x, int y) const
 		break;
 
 	default:	// Should never be possible.
+		SDL_UnlockSurface(pixels);
 		throw image_bad_data();
 		break;
 	}
@@ -307,40 +356,33 @@ Color_4ub Image::pixelColor(int x, int y) const
 * Internal function used to clean up references to fonts when the Image
 * destructor or copy assignment operators are called.
 *
-* \param	name	Name of the Image to check against.
+* \param	handle	Handle of the Image to check against.
 */
-void updateImageReferenceCount(const std::string& name)
+void updateImageReferenceCount(const ResourceHandle& handle)
 {
-	auto it = IMAGE_ID_MAP.find(name);
-	if (it == IMAGE_ID_MAP.end())
+	ImageInfo* info = IMAGE_REGISTRY.get(handle);
+	if (!info)
 	{
 		return;
 	}
 
-	--it->second.ref_count;
+	--info->ref_count;
 
 	// if texture id reference count is 0, delete the texture.
-	if (it->second.ref_count < 1)
+	if (info->ref_count < 1)
 	{
-		if (it->second.texture_id == 0)
-		{
-			return;
-		}
-
-		glDeleteTextures(1, &it->second.texture_id);
+		// Atlas pages are shared and only deleted once every image on them is released.
+		if (info->atlas_page >= 0) { atlasRelease(*info); }
+		else if (info->texture_id != 0) { glDeleteTextures(1, &info->texture_id); }
 
-		if (it->second.fbo_id != 0)
+		if (info->fbo_id != 0)
 		{
-			glDeleteFramebuffers(1, &it->second.fbo_id);
+			glDeleteFramebuffers(1, &info->fbo_id);
 		}
 
-		if (it->second.pixels != nullptr)
-		{
-			SDL_FreeSurface(static_cast<SDL_Surface*>(it->second.pixels));
-			it->second.pixels = nullptr;
-		}
+		freePixels(*info);
 
-		IMAGE_ID_MAP.erase(it);
+		IMAGE_REGISTRY.release(handle);
 	}
 }
 
@@ -349,19 +391,74 @@ void updateImageReferenceCount(const std::string& name)
 * Checks to see if a texture has already been generated
 * and if it has, increases the reference count.
 *
-* \return	True if texture already exists. False otherwise.
+* \return	Handle of the texture if it already exists. An invalid handle otherwise.
 */
-bool checkTextureId(const std::string& name)
+ResourceHandle checkTextureId(const std::string& name)
+{
+	ResourceHandle handle = IMAGE_REGISTRY.find(name);
+
+	if (handle.valid())
+	{
+		++IMAGE_REGISTRY.get(handle)->ref_count;
+	}
+
+	return handle;
+}
+
+
+/**
+ * Adds a decoded image to the registry and uploads it to the GPU. Small images
+ * may be packed into the ImageAtlas instead of getting a texture of their own.
+ *
+ * The registry takes ownership of the surface. If an image with the same name
+ * has already been registered the surface is freed and the existing entry is
+ * used instead. The reference count of the entry is not changed. The surface
+ * is also freed if the image can't be uploaded, in which case nothing is
+ * registered.
+ *
+ * \param	name	Name of the image.
+ * \param	surface	Pointer to an SDL_Surface with the decoded image.
+ *
+ * \note	Must be called from the thread that owns the OpenGL context.
+ */
+ResourceHandle registerImage(const std::string& name, void* surface)
 {
-	auto it = IMAGE_ID_MAP.find(name);
+	SDL_Surface* pixels = static_cast<SDL_Surface*>(surface);
 
-	if (it != IMAGE_ID_MAP.end())
+	ResourceHandle handle = IMAGE_REGISTRY.find(name);
+	if (handle.valid())
 	{
-		++IMAGE_ID_MAP[name].ref_count;
-		return true;
+		SDL_FreeSurface(pixels);
+		return handle;
 	}
 
-	return false;
+	// Upload first so that an unsupported image doesn't leave an entry behind.
+	ImageInfo record;
+	if (!atlasImage(record, pixels->pixels, pixels->format->BytesPerPixel, pixels->w, pixels->h, pixels->pitch))
+	{
+		try
+		{
+			record.texture_id = generateTexture(pixels->pixels, pixels->format->BytesPerPixel, pixels->w, pixels->h);
+		}
+		catch (...)
+		{
+			SDL_FreeSurface(pixels);
+			throw;
+		}
+	}
+
+	record.w = pixels->w;
+	record.h = pixels->h;
+	record.pixels = pixels;
+
+	handle = IMAGE_REGISTRY.insert(name);
+
+	ImageInfo& info = *IMAGE_REGISTRY.get(handle);
+	info = record;
+
+	cachePixels(handle, info);
+
+	return handle;
 }
 
 
@@ -0,0 +1,507 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright © 2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// =
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#include "NAS2D/Resources/ImageAtlas.h"
+#include "NAS2D/Resources/ImageInfo.h"
+
+#include <GL/glew.h>
+#include <SDL.h>
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+using namespace NAS2D;
+
+
+/**
+ * Padding added around every packed image. Edge pixels are extruded into the
+ * padding so that linear filtering doesn't bleed neighboring images.
+ */
+const int ATLAS_PADDING = 1;
+
+
+/**
+ * Segment of a skyline. Spans [x, x + width) at height y.
+ */
+struct SkylineNode
+{
+	SkylineNode(int _x, int _y, int _width) : x(_x), y(_y), width(_width) {}
+
+	int x;
+	int y;
+	int width;
+};
+
+
+/**
+ * A single shared texture page.
+ */
+struct AtlasPage
+{
+	AtlasPage() : texture_id(0), size(0), used_area(0), image_count(0) {}
+
+	unsigned int				texture_id;
+	int							size;
+	int							used_area;
+	int							image_count;
+	std::vector<SkylineNode>	skyline;
+};
+
+
+bool						ATLAS_ENABLED = false;
+int							ATLAS_PAGE_SIZE = 1024;
+int							ATLAS_MAX_IMAGE_SIZE = 128;
+std::vector<AtlasPage>		ATLAS_PAGES;
+
+
+// ==================================================================================
+// = UNEXPOSED FUNCTION PROTOTYPES
+// ==================================================================================
+bool atlasImage(ImageInfo& info, void* buffer, int bytesPerPixel, int width, int height, int pitch);
+void atlasRelease(ImageInfo& info);
+
+bool skylineFit(const AtlasPage& page, size_t index, int width, int height, int& y);
+bool skylineInsert(AtlasPage& page, int width, int height, int& x, int& y);
+void createPage(AtlasPage& page, int size);
+void uploadPadded(const AtlasPage& page, void* buffer, int bytesPerPixel, int width, int height, int pitch, int x, int y);
+
+
+/**
+ * C'tor
+ */
+ImageAtlas::ImageAtlas()
+{}
+
+
+/**
+ * D'tor
+ */
+ImageAtlas::~ImageAtlas()
+{}
+
+
+/**
+ * Enables or disables packing of newly loaded Images.
+ *
+ * Disabling the atlas does not move Images that are already packed.
+ */
+void ImageAtlas::enabled(bool enable)
+{
+	ATLAS_ENABLED = enable;
+}
+
+
+/**
+ * Gets whether newly loaded Images are packed into the atlas.
+ */
+bool ImageAtlas::enabled() const
+{
+	return ATLAS_ENABLED;
+}
+
+
+/**
+ * Sets the width and height in pixels of new atlas pages.
+ *
+ * \note	Existing pages keep their size.
+ */
+void ImageAtlas::pageSize(int size)
+{
+	ATLAS_PAGE_SIZE = size;
+}
+
+
+/**
+ * Gets the width and height in pixels of new atlas pages.
+ */
+int ImageAtlas::pageSize() const
+{
+	return ATLAS_PAGE_SIZE;
+}
+
+
+/**
+ * Sets the largest width or height in pixels an Image can have and still
+ * be packed into the atlas.
+ */
+void ImageAtlas::maxImageSize(int size)
+{
+	ATLAS_MAX_IMAGE_SIZE = size;
+}
+
+
+/**
+ * Gets the largest width or height in pixels an Image can have and still
+ * be packed into the atlas.
+ */
+int ImageAtlas::maxImageSize() const
+{
+	return ATLAS_MAX_IMAGE_SIZE;
+}
+
+
+/**
+ * Loads and packs a list of Images ahead of time.
+ *
+ * Images loaded by build() are kept resident until clear() is called so
+ * that their placement in the atlas remains stable.
+ *
+ * \param	imageList	List of image file paths.
+ */
+void ImageAtlas::build(const StringList& imageList)
+{
+	mImages.reserve(mImages.size() + imageList.size());
+	for (size_t i = 0; i < imageList.size(); ++i)
+	{
+		mImages.push_back(Image(imageList[i]));
+	}
+}
+
+
+/**
+ * Releases all Images kept resident by build().
+ */
+void ImageAtlas::clear()
+{
+	mImages.clear();
+}
+
+
+/**
+ * Gets the number of atlas pages.
+ */
+int ImageAtlas::pageCount() const
+{
+	return static_cast<int>(ATLAS_PAGES.size());
+}
+
+
+/**
+ * Gets the number of Images packed into a given page.
+ */
+int ImageAtlas::imageCount(int page) const
+{
+	if (page < 0 || page >= pageCount())
+	{
+		return 0;
+	}
+
+	return ATLAS_PAGES[page].image_count;
+}
+
+
+/**
+ * Gets the fraction, from 0.0 to 1.0, of a page's area used by packed Images.
+ *
+ * \note	Padding around each Image is included.
+ */
+float ImageAtlas::occupancy(int page) const
+{
+	if (page < 0 || page >= pageCount() || ATLAS_PAGES[page].size == 0)
+	{
+		return 0.0f;
+	}
+
+	const AtlasPage& p = ATLAS_PAGES[page];
+	return static_cast<float>(p.used_area) / static_cast<float>(p.size * p.size);
+}
+
+
+/**
+ * Gets the fraction, from 0.0 to 1.0, of the area of all pages used by packed Images.
+ */
+float ImageAtlas::occupancy() const
+{
+	float used = 0.0f, total = 0.0f;
+	for (size_t i = 0; i < ATLAS_PAGES.size(); ++i)
+	{
+		used += static_cast<float>(ATLAS_PAGES[i].used_area);
+		total += static_cast<float>(ATLAS_PAGES[i].size) * static_cast<float>(ATLAS_PAGES[i].size);
+	}
+
+	if (total == 0.0f) { return 0.0f; }
+
+	return used / total;
+}
+
+
+// ==================================================================================
+// = Unexposed module-level functions defined here that don't need to be part of the
+// = API interface.
+// ==================================================================================
+
+/**
+ * Attempts to pack pixel data into the atlas.
+ *
+ * On success the texture id, page and texture coordinates of \c info are
+ * updated to refer to the atlas page.
+ *
+ * \return	True if the image was packed. False if the atlas is disabled or the
+ *			image isn't suitable for packing, in which case the caller should
+ *			generate a texture for it.
+ */
+bool atlasImage(ImageInfo& info, void* buffer, int bytesPerPixel, int width, int height, int pitch)
+{
+	if (!ATLAS_ENABLED || buffer == nullptr)
+	{
+		return false;
+	}
+
+	if (bytesPerPixel != 3 && bytesPerPixel != 4)
+	{
+		return false;
+	}
+
+	int paddedWidth = width + ATLAS_PADDING * 2;
+	int paddedHeight = height + ATLAS_PADDING * 2;
+
+	if (width > ATLAS_MAX_IMAGE_SIZE || height > ATLAS_MAX_IMAGE_SIZE || paddedWidth > ATLAS_PAGE_SIZE || paddedHeight > ATLAS_PAGE_SIZE)
+	{
+		return false;
+	}
+
+	int x = 0, y = 0;
+	size_t page = 0;
+	for (; page < ATLAS_PAGES.size(); ++page)
+	{
+		// Pages released by atlasRelease() are reused before new ones are made.
+		if (ATLAS_PAGES[page].texture_id == 0)
+		{
+			createPage(ATLAS_PAGES[page], ATLAS_PAGE_SIZE);
+		}
+
+		if (skylineInsert(ATLAS_PAGES[page], paddedWidth, paddedHeight, x, y))
+		{
+			break;
+		}
+	}
+
+	if (page == ATLAS_PAGES.size())
+	{
+		ATLAS_PAGES.push_back(AtlasPage());
+		createPage(ATLAS_PAGES.back(), ATLAS_PAGE_SIZE);
+		skylineInsert(ATLAS_PAGES.back(), paddedWidth, paddedHeight, x, y);
+	}
+
+	AtlasPage& p = ATLAS_PAGES[page];
+	uploadPadded(p, buffer, bytesPerPixel, width, height, pitch, x, y);
+
+	p.used_area += paddedWidth * paddedHeight;
+	++p.image_count;
+
+	float size = static_cast<float>(p.size);
+
+	info.texture_id = p.texture_id;
+	info.atlas_page = static_cast<int>(page);
+	info.u0 = (x + ATLAS_PADDING) / size;
+	info.v0 = (y + ATLAS_PADDING) / size;
+	info.u1 = (x + ATLAS_PADDING + width) / size;
+	info.v1 = (y + ATLAS_PADDING + height) / size;
+
+	return true;
+}
+
+
+/**
+ * Releases an image's space in the atlas.
+ *
+ * Space is reclaimed once every image on the page has been released, at which
+ * point the page's texture is deleted.
+ */
+void atlasRelease(ImageInfo& info)
+{
+	if (info.atlas_page < 0 || info.atlas_page >= static_cast<int>(ATLAS_PAGES.size()))
+	{
+		return;
+	}
+
+	AtlasPage& p = ATLAS_PAGES[info.atlas_page];
+	p.used_area -= (info.w + ATLAS_PADDING * 2) * (info.h + ATLAS_PADDING * 2);
+	--p.image_count;
+
+	if (p.image_count < 1)
+	{
+		glDeleteTextures(1, &p.texture_id);
+		p = AtlasPage();
+	}
+
+	info.texture_id = 0;
+	info.atlas_page = -1;
+	info.u0 = 0.0f; info.v0 = 0.0f;
+	info.u1 = 1.0f; info.v1 = 1.0f;
+}
+
+
+/**
+ * Creates an empty page and its texture.
+ */
+void createPage(AtlasPage& page, int size)
+{
+	page = AtlasPage();
+	page.size = size;
+	page.skyline.push_back(SkylineNode(0, 0, size));
+
+	GLenum textureFormat = SDL_BYTEORDER == SDL_BIG_ENDIAN ? GL_BGRA : GL_RGBA;
+
+	glGenTextures(1, &page.texture_id);
+	glBindTexture(GL_TEXTURE_2D, page.texture_id);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, textureFormat, GL_UNSIGNED_BYTE, nullptr);
+}
+
+
+/**
+ * Checks whether a rectangle fits on the skyline starting at a given node.
+ *
+ * \param	y	Set to the height the rectangle would be placed at.
+ */
+bool skylineFit(const AtlasPage& page, size_t index, int width, int height, int& y)
+{
+	int x = page.skyline[index].x;
+	if (x + width > page.size)
+	{
+		return false;
+	}
+
+	int widthLeft = width;
+	y = page.skyline[index].y;
+
+	while (widthLeft > 0)
+	{
+		y = std::max(y, page.skyline[index].y);
+		if (y + height > page.size)
+		{
+			return false;
+		}
+
+		widthLeft -= page.skyline[index].width;
+		++index;
+	}
+
+	return true;
+}
+
+
+/**
+ * Finds a place for a rectangle using the skyline bottom-left heuristic and
+ * updates the skyline.
+ *
+ * \return	True if the rectangle was placed. False if the page is full.
+ */
+bool skylineInsert(AtlasPage& page, int width, int height, int& x, int& y)
+{
+	int bestTop = INT_MAX;
+	int bestWidth = INT_MAX;
+	size_t bestIndex = page.skyline.size();
+
+	for (size_t i = 0; i < page.skyline.size(); ++i)
+	{
+		int top = 0;
+		if (!skylineFit(page, i, width, height, top))
+		{
+			continue;
+		}
+
+		if (top + height < bestTop || (top + height == bestTop && page.skyline[i].width < bestWidth))
+		{
+			bestTop = top + height;
+			bestWidth = page.skyline[i].width;
+			bestIndex = i;
+			x = page.skyline[i].x;
+			y = top;
+		}
+	}
+
+	if (bestIndex == page.skyline.size())
+	{
+		return false;
+	}
+
+	page.skyline.insert(page.skyline.begin() + bestIndex, SkylineNode(x, y + height, width));
+
+	// Shrink or remove the nodes now covered by the new one.
+	for (size_t i = bestIndex + 1; i < page.skyline.size(); ++i)
+	{
+		SkylineNode& previous = page.skyline[i - 1];
+		SkylineNode& node = page.skyline[i];
+
+		if (node.x >= previous.x + previous.width)
+		{
+			break;
+		}
+
+		int shrink = previous.x + previous.width - node.x;
+		node.x += shrink;
+		node.width -= shrink;
+
+		if (node.width > 0)
+		{
+			break;
+		}
+
+		page.skyline.erase(page.skyline.begin() + i);
+		--i;
+	}
+
+	// Merge neighbors at the same height.
+	for (size_t i = 0; i + 1 < page.skyline.size(); ++i)
+	{
+		if (page.skyline[i].y == page.skyline[i + 1].y)
+		{
+			page.skyline[i].width += page.skyline[i + 1].width;
+			page.skyline.erase(page.skyline.begin() + i + 1);
+			--i;
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * Uploads pixel data into a page at x, y with its edge pixels extruded into
+ * the surrounding padding.
+ */
+void uploadPadded(const AtlasPage& page, void* buffer, int bytesPerPixel, int width, int height, int pitch, int x, int y)
+{
+	int paddedWidth = width + ATLAS_PADDING * 2;
+	int paddedHeight = height + ATLAS_PADDING * 2;
+
+	std::vector<Uint8> padded(paddedWidth * paddedHeight * 4);
+	const Uint8* source = static_cast<const Uint8*>(buffer);
+
+	for (int row = 0; row < paddedHeight; ++row)
+	{
+		int sourceRow = clamp(row - ATLAS_PADDING, 0, height - 1);
+		for (int col = 0; col < paddedWidth; ++col)
+		{
+			int sourceCol = clamp(col - ATLAS_PADDING, 0, width - 1);
+
+			const Uint8* src = source + sourceRow * pitch + sourceCol * bytesPerPixel;
+			Uint8* dst = &padded[(row * paddedWidth + col) * 4];
+
+			dst[0] = src[0];
+			dst[1] = src[1];
+			dst[2] = src[2];
+			dst[3] = bytesPerPixel == 4 ? src[3] : 255;
+		}
+	}
+
+	GLenum textureFormat = SDL_BYTEORDER == SDL_BIG_ENDIAN ? GL_BGRA : GL_RGBA;
+
+	glBindTexture(GL_TEXTURE_2D, page.texture_id);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, paddedWidth, paddedHeight, textureFormat, GL_UNSIGNED_BYTE, &padded[0]);
+}
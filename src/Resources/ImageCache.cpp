@@ -0,0 +1,403 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright © 2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// =
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#include "NAS2D/Resources/ImageCache.h"
+#include "NAS2D/Resources/ImageInfo.h"
+#include "NAS2D/Resources/ResourceRegistry.h"
+
+#include "NAS2D/Filesystem.h"
+#include "NAS2D/Utility.h"
+
+#include <GL/glew.h>
+#include <SDL.h>
+#include <SDL_image.h>
+
+#include <map>
+
+using namespace NAS2D;
+
+
+extern ResourceRegistry<ImageInfo> IMAGE_REGISTRY;
+
+
+ImageCache::PixelPolicy							PIXEL_POLICY = ImageCache::PIXELS_KEEP;
+size_t											PIXEL_CACHE_BUDGET = 64 * 1024 * 1024;
+size_t											PIXEL_RESIDENT_BYTES[ImageCache::PIXEL_POLICY_COUNT] = { 0 };
+unsigned int									PIXEL_RELOAD_COUNT = 0;
+unsigned int									PIXEL_EVICTION_COUNT = 0;
+
+unsigned long long								PIXEL_STAMP = 0;	/*< Incremented every time cached pixels are used. */
+std::map<unsigned long long, ResourceHandle>	PIXEL_LRU;			/*< Cached images ordered from least to most recently used. */
+
+
+// ==================================================================================
+// = UNEXPOSED FUNCTION PROTOTYPES
+// ==================================================================================
+void cachePixels(const ResourceHandle& handle, ImageInfo& info);
+void* lockPixels(const ResourceHandle& handle, ImageInfo& info, const std::string& name);
+void freePixels(ImageInfo& info);
+
+void residePixels(const ResourceHandle& handle, ImageInfo& info, SDL_Surface* pixels);
+void evictPixels(const ImageInfo& keep);
+SDL_Surface* readFilePixels(const ImageInfo& info, const std::string& name);
+SDL_Surface* readTexturePixels(const ImageInfo& info);
+
+
+/**
+ * C'tor
+ */
+ImageCache::ImageCache()
+{}
+
+
+/**
+ * D'tor
+ */
+ImageCache::~ImageCache()
+{}
+
+
+/**
+ * Sets the policy used for Images loaded from now on.
+ */
+void ImageCache::policy(PixelPolicy policy)
+{
+	PIXEL_POLICY = policy;
+}
+
+
+/**
+ * Gets the policy used for newly loaded Images.
+ */
+ImageCache::PixelPolicy ImageCache::policy() const
+{
+	return PIXEL_POLICY;
+}
+
+
+/**
+ * Sets the maximum number of bytes of pixels kept by Images loaded with the
+ * PIXELS_CACHE policy. Defaults to 64 MiB.
+ *
+ * Least recently used pixels are evicted right away if the cache is larger
+ * than the new budget.
+ */
+void ImageCache::budget(size_t bytes)
+{
+	PIXEL_CACHE_BUDGET = bytes;
+	evictPixels(ImageInfo());
+}
+
+
+/**
+ * Gets the maximum number of bytes of pixels kept by Images loaded with the
+ * PIXELS_CACHE policy.
+ */
+size_t ImageCache::budget() const
+{
+	return PIXEL_CACHE_BUDGET;
+}
+
+
+/**
+ * Gets the number of bytes of pixels held by Images loaded with a given policy.
+ */
+size_t ImageCache::residentBytes(PixelPolicy policy) const
+{
+	if (policy < 0 || policy >= PIXEL_POLICY_COUNT)
+	{
+		return 0;
+	}
+
+	return PIXEL_RESIDENT_BYTES[policy];
+}
+
+
+/**
+ * Gets the number of bytes of pixels held by all Images.
+ */
+size_t ImageCache::residentBytes() const
+{
+	size_t total = 0;
+	for (int i = 0; i < PIXEL_POLICY_COUNT; ++i)
+	{
+		total += PIXEL_RESIDENT_BYTES[i];
+	}
+
+	return total;
+}
+
+
+/**
+ * Gets the number of times pixels had to be read back from disk or the GPU.
+ */
+unsigned int ImageCache::reloadCount() const
+{
+	return PIXEL_RELOAD_COUNT;
+}
+
+
+/**
+ * Gets the number of times pixels were evicted from the cache to stay within
+ * budget().
+ */
+unsigned int ImageCache::evictionCount() const
+{
+	return PIXEL_EVICTION_COUNT;
+}
+
+
+// ==================================================================================
+// = Unexposed module-level functions defined here that don't need to be part of the
+// = API interface.
+// ==================================================================================
+
+/**
+ * Applies the current policy to the pixels of a newly loaded image.
+ *
+ * \note	Called after the pixels have been uploaded to the GPU.
+ */
+void cachePixels(const ResourceHandle& handle, ImageInfo& info)
+{
+	info.pixel_policy = PIXEL_POLICY;
+
+	SDL_Surface* pixels = static_cast<SDL_Surface*>(info.pixels);
+	info.pixels = nullptr;
+
+	if (!pixels)
+	{
+		return;
+	}
+
+	if (info.pixel_policy == ImageCache::PIXELS_DISCARD)
+	{
+		SDL_FreeSurface(pixels);
+		return;
+	}
+
+	residePixels(handle, info, pixels);
+}
+
+
+/**
+ * Makes sure the pixels of an image are available, reading them back if needed.
+ *
+ * Pixels of images with the PIXELS_DISCARD policy are moved into the cache once
+ * they've been read back. Images that are sampled once are usually sampled
+ * again, e.g. for hit testing, and reading them back for every pixel is slow.
+ *
+ * \return	Pointer to an SDL_Surface or \c nullptr if the pixels can't be read back.
+ */
+void* lockPixels(const ResourceHandle& handle, ImageInfo& info, const std::string& name)
+{
+	if (info.pixels)
+	{
+		if (info.pixel_policy == ImageCache::PIXELS_CACHE)
+		{
+			PIXEL_LRU.erase(info.pixel_stamp);
+			info.pixel_stamp = ++PIXEL_STAMP;
+			PIXEL_LRU[info.pixel_stamp] = handle;
+		}
+
+		return info.pixels;
+	}
+
+	SDL_Surface* pixels = readFilePixels(info, name);
+	if (!pixels)
+	{
+		pixels = readTexturePixels(info);
+	}
+
+	if (!pixels)
+	{
+		return nullptr;
+	}
+
+	++PIXEL_RELOAD_COUNT;
+
+	if (info.pixel_policy == ImageCache::PIXELS_DISCARD)
+	{
+		info.pixel_policy = ImageCache::PIXELS_CACHE;
+	}
+
+	residePixels(handle, info, pixels);
+
+	return info.pixels;
+}
+
+
+/**
+ * Frees the pixels of an image. Used when an image is released or when its
+ * texture has been drawn to and the pixels are out of date.
+ */
+void freePixels(ImageInfo& info)
+{
+	if (!info.pixels)
+	{
+		return;
+	}
+
+	if (info.pixel_policy == ImageCache::PIXELS_CACHE)
+	{
+		PIXEL_LRU.erase(info.pixel_stamp);
+	}
+
+	PIXEL_RESIDENT_BYTES[info.pixel_policy] -= info.pixel_bytes;
+
+	SDL_FreeSurface(static_cast<SDL_Surface*>(info.pixels));
+	info.pixels = nullptr;
+	info.pixel_bytes = 0;
+	info.pixel_stamp = 0;
+}
+
+
+/**
+ * Makes pixels resident for an image and accounts for them. Cached pixels
+ * evict older pixels if the cache goes over budget.
+ */
+void residePixels(const ResourceHandle& handle, ImageInfo& info, SDL_Surface* pixels)
+{
+	info.pixels = pixels;
+	info.pixel_bytes = static_cast<size_t>(pixels->pitch) * static_cast<size_t>(pixels->h);
+	PIXEL_RESIDENT_BYTES[info.pixel_policy] += info.pixel_bytes;
+
+	if (info.pixel_policy == ImageCache::PIXELS_CACHE)
+	{
+		info.pixel_stamp = ++PIXEL_STAMP;
+		PIXEL_LRU[info.pixel_stamp] = handle;
+		evictPixels(info);
+	}
+}
+
+
+/**
+ * Evicts least recently used pixels until the cache is within budget.
+ *
+ * \param	keep	Image whose pixels must not be evicted.
+ */
+void evictPixels(const ImageInfo& keep)
+{
+	auto it = PIXEL_LRU.begin();
+	while (PIXEL_RESIDENT_BYTES[ImageCache::PIXELS_CACHE] > PIXEL_CACHE_BUDGET && it != PIXEL_LRU.end())
+	{
+		ImageInfo* info = IMAGE_REGISTRY.get(it->second);
+		++it;
+
+		if (!info || info == &keep)
+		{
+			continue;
+		}
+
+		freePixels(*info);
+		++PIXEL_EVICTION_COUNT;
+	}
+}
+
+
+/**
+ * Reads the pixels of an image back from the file it was loaded from.
+ *
+ * \return	Pointer to an SDL_Surface or \c nullptr if the image didn't come
+ *			from a file or its texture has been drawn to since.
+ */
+SDL_Surface* readFilePixels(const ImageInfo& info, const std::string& name)
+{
+	if (info.fbo_id != 0 || !Utility<Filesystem>::get().exists(name))
+	{
+		return nullptr;
+	}
+
+	File file = Utility<Filesystem>::get().open(name);
+	if (file.empty())
+	{
+		return nullptr;
+	}
+
+	SDL_Surface* pixels = IMG_Load_RW(SDL_RWFromConstMem(file.raw_bytes(), static_cast<int>(file.size())), 0);
+	if (pixels && (pixels->w != info.w || pixels->h != info.h))
+	{
+		SDL_FreeSurface(pixels);
+		return nullptr;
+	}
+
+	return pixels;
+}
+
+
+/**
+ * Reads the pixels of an image back from its texture.
+ *
+ * Works for images packed into an ImageAtlas page as well. Only the image's own
+ * rectangle is read, through a temporary framebuffer, instead of the whole page.
+ *
+ * \return	Pointer to a 32-bit RGBA SDL_Surface or \c nullptr if the image has
+ *			no texture.
+ */
+SDL_Surface* readTexturePixels(const ImageInfo& info)
+{
+	if (info.texture_id == 0 || info.w < 1 || info.h < 1)
+	{
+		return nullptr;
+	}
+
+	GLint textureWidth = 0, textureHeight = 0;
+	glBindTexture(GL_TEXTURE_2D, info.texture_id);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &textureWidth);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &textureHeight);
+
+	int x = static_cast<int>(info.u0 * textureWidth + 0.5f);
+	int y = static_cast<int>(info.v0 * textureHeight + 0.5f);
+	if (x + info.w > textureWidth || y + info.h > textureHeight)
+	{
+		return nullptr;
+	}
+
+	SDL_Surface* pixels = nullptr;
+	if (SDL_BYTEORDER == SDL_LIL_ENDIAN)
+	{
+		pixels = SDL_CreateRGBSurface(0, info.w, info.h, 32, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+	}
+	else
+	{
+		pixels = SDL_CreateRGBSurface(0, info.w, info.h, 32, 0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff);
+	}
+
+	if (!pixels)
+	{
+		return nullptr;
+	}
+
+	GLint previousFramebuffer = 0;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+	GLuint framebuffer = 0;
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, info.texture_id, 0);
+
+	bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	if (complete)
+	{
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glPixelStorei(GL_PACK_ROW_LENGTH, pixels->pitch / 4);
+		glReadPixels(x, y, info.w, info.h, GL_RGBA, GL_UNSIGNED_BYTE, pixels->pixels);
+		glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+	glDeleteFramebuffers(1, &framebuffer);
+
+	if (!complete)
+	{
+		SDL_FreeSurface(pixels);
+		return nullptr;
+	}
+
+	return pixels;
+}
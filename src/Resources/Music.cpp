@@ -9,6 +9,7 @@
 // ==================================================================================
 #include "NAS2D/Resources/Music.h"
 #include "NAS2D/Resources/MusicInfo.h"
+#include "NAS2D/Resources/ResourceRegistry.h"
 
 #include "NAS2D/Filesystem.h"
 #include "NAS2D/Utility.h"
@@ -21,9 +22,10 @@
 
 using namespace NAS2D;
 
-std::map<std::string, MusicInfo>	MUSIC_REF_MAP;		/*< Lookup table for music resource references. */
+ResourceRegistry<MusicInfo>	MUSIC_REGISTRY;		/*< Lookup table for music resource references. */
 
-void updateMusicReferenceCount(const std::string& name);
+ResourceHandle registerMusic(const std::string& name, void* rwops);
+void updateMusicReferenceCount(const ResourceHandle& handle);
 
 /**
  * Default c'tor.
@@ -46,18 +48,27 @@ Music::Music(const std::string& filePath):	Resource(filePath)
 /**
  * Copy c'tor.
  */
-Music::Music(const Music& rhs): Resource(rhs.name())
+Music::Music(const Music& rhs): Resource(rhs)
 {
-	auto it = MUSIC_REF_MAP.find(name());
-	if (it != MUSIC_REF_MAP.end())
+	MusicInfo* info = MUSIC_REGISTRY.get(handle());
+	if (info)
 	{
-		it->second.ref_count++;
+		info->ref_count++;
+	}
+	else
+	{
+		handle(ResourceHandle());
 	}
-
-	loaded(rhs.loaded());
 }
 
 
+/**
+ * Move c'tor.
+ */
+Music::Music(Music&& rhs) noexcept: Resource(std::move(rhs))
+{}
+
+
 /**
  * Copy operator.
  */
@@ -65,18 +76,18 @@ Music& Music::operator=(const Music& rhs)
 {
 	if (this == &rhs) { return *this; }
 
-	updateMusicReferenceCount(name());
+	updateMusicReferenceCount(handle());
 
-	name(rhs.name());
+	Resource::operator=(rhs);
 
-	auto it = MUSIC_REF_MAP.find(name());
-	if (it != MUSIC_REF_MAP.end())
+	MusicInfo* info = MUSIC_REGISTRY.get(handle());
+	if (info)
 	{
-		it->second.ref_count++;
-		loaded(rhs.loaded());
+		info->ref_count++;
 	}
 	else
 	{
+		handle(ResourceHandle());
 		loaded(false);
 	}
 
@@ -84,12 +95,27 @@ Music& Music::operator=(const Music& rhs)
 }
 
 
+/**
+ * Move operator.
+ */
+Music& Music::operator=(Music&& rhs) noexcept
+{
+	if (this == &rhs) { return *this; }
+
+	updateMusicReferenceCount(handle());
+
+	Resource::operator=(std::move(rhs));
+
+	return *this;
+}
+
+
 /**
  * D'tor.
  */
 Music::~Music()
 {
-	updateMusicReferenceCount(name());
+	updateMusicReferenceCount(handle());
 }
 
 
@@ -100,31 +126,29 @@ Music::~Music()
  */
 void Music::load()
 {
-	if (MUSIC_REF_MAP.find(name()) != MUSIC_REF_MAP.end())
+	ResourceHandle existing = MUSIC_REGISTRY.find(name());
+	if (existing.valid())
 	{
-		MUSIC_REF_MAP.find(name())->second.ref_count++;
+		MUSIC_REGISTRY.get(existing)->ref_count++;
+		handle(existing);
 		loaded(true);
 		return;
 	}
 
-	File* file = new File(Utility<Filesystem>::get().open(name()));
-	if (file->empty())
+	// Music is streamed from the Filesystem instead of being loaded into memory.
+	void* rwops = Utility<Filesystem>::get().openStream(name()).rwops();
+	if (!rwops)
 	{
-		delete file;
 		return;
 	}
 
-	Mix_Music* music = Mix_LoadMUS_RW(SDL_RWFromConstMem(file->raw_bytes(), static_cast<int>(file->size())), 0);
-	if (!music)
+	handle(registerMusic(name(), rwops));
+	if (!handle().valid())
 	{
-		std::cout << "Music::load(): " << Mix_GetError() << std::endl;
 		return;
 	}
 
-	auto& record = MUSIC_REF_MAP[name()];
-	record.buffer = file;
-	record.music = music;
-	record.ref_count++;
+	MUSIC_REGISTRY.get(handle())->ref_count++;
 
 	loaded(true);
 }
@@ -135,35 +159,69 @@ void Music::load()
 // = API interface.
 // ==================================================================================
 
+/**
+ * Opens a music stream and adds it to the registry.
+ *
+ * The music takes ownership of the SDL_RWops which is closed when the music is
+ * freed, if the stream can't be opened or if music with the same name has
+ * already been registered. The reference count of the entry is not changed.
+ *
+ * \param	name	Name of the music.
+ * \param	rwops	Pointer to an SDL_RWops to stream the music data from.
+ *
+ * \return	Handle of the music or an invalid handle on failure.
+ */
+ResourceHandle registerMusic(const std::string& name, void* rwops)
+{
+	SDL_RWops* rw = static_cast<SDL_RWops*>(rwops);
+
+	ResourceHandle handle = MUSIC_REGISTRY.find(name);
+	if (handle.valid())
+	{
+		SDL_RWclose(rw);
+		return handle;
+	}
+
+	Mix_Music* music = Mix_LoadMUS_RW(rw, 1);
+	if (!music)
+	{
+		std::cout << "Music::load(): " << Mix_GetError() << std::endl;
+		return ResourceHandle();
+	}
+
+	handle = MUSIC_REGISTRY.insert(name);
+
+	MusicInfo& record = *MUSIC_REGISTRY.get(handle);
+	record.music = music;
+
+	return handle;
+}
+
+
 /**
 * Internal function used to clean up references to fonts when the Music
 * destructor or copy assignment operators are called.
 *
-* \param	name	Name of the Music to check against.
+* \param	handle	Handle of the Music to check against.
 */
-void updateMusicReferenceCount(const std::string& name)
+void updateMusicReferenceCount(const ResourceHandle& handle)
 {
-	auto it = MUSIC_REF_MAP.find(name);
-	if (it == MUSIC_REF_MAP.end())
+	MusicInfo* info = MUSIC_REGISTRY.get(handle);
+	if (!info)
 	{
 		return;
 	}
 
-	--it->second.ref_count;
+	--info->ref_count;
 
 	// No more references to this resource.
-	if (it->second.ref_count < 1)
+	if (info->ref_count < 1)
 	{
-		if (it->second.music)
-		{
-			Mix_FreeMusic(static_cast<Mix_Music*>(it->second.music));
-		}
-
-		if (it->second.buffer)
+		if (info->music)
 		{
-			delete static_cast<File*>(it->second.buffer);
+			Mix_FreeMusic(static_cast<Mix_Music*>(info->music));
 		}
 
-		MUSIC_REF_MAP.erase(it);
+		MUSIC_REGISTRY.release(handle);
 	}
 }
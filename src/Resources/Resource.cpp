@@ -15,7 +15,7 @@ using namespace NAS2D;
 /**
  * Default c'tor.
  */
-Resource::Resource():	mResourceName("Default Resource"),
+Resource::Resource():	mResourceName(std::make_shared<const std::string>("Default Resource")),
 						mIsLoaded(false)
 {}
 
@@ -25,11 +25,75 @@ Resource::Resource():	mResourceName("Default Resource"),
  * 
  * \param filePath Sets the name of the Resource to \c filePath.
  */
-Resource::Resource(const std::string& filePath):	mResourceName(filePath),
+Resource::Resource(const std::string& filePath):	mResourceName(std::make_shared<const std::string>(filePath)),
 													mIsLoaded(false)								
 {}
 
 
+/**
+ * Copy c'tor.
+ *
+ * Copies the name, handle and loaded state of a Resource. The name is shared
+ * instead of copied.
+ *
+ * \note	Derived types are responsible for referencing the shared data
+ *			identified by the handle.
+ */
+Resource::Resource(const Resource& rhs):	mResourceName(rhs.mResourceName),
+											mHandle(rhs.mHandle),
+											mIsLoaded(rhs.mIsLoaded)
+{}
+
+
+/**
+ * Move c'tor.
+ *
+ * Takes over the handle of a Resource. The moved from Resource keeps its name
+ * but is left unloaded and without a handle so it no longer references the
+ * shared data.
+ */
+Resource::Resource(Resource&& rhs) noexcept:	mResourceName(rhs.mResourceName),
+												mHandle(rhs.mHandle),
+												mIsLoaded(rhs.mIsLoaded)
+{
+	rhs.mHandle = ResourceHandle();
+	rhs.mIsLoaded = false;
+}
+
+
+/**
+ * Copy assignment operator.
+ *
+ * \see Resource(const Resource&)
+ */
+Resource& Resource::operator=(const Resource& rhs)
+{
+	mResourceName = rhs.mResourceName;
+	mHandle = rhs.mHandle;
+	mIsLoaded = rhs.mIsLoaded;
+
+	return *this;
+}
+
+
+/**
+ * Move assignment operator.
+ *
+ * \see Resource(Resource&&)
+ */
+Resource& Resource::operator=(Resource&& rhs) noexcept
+{
+	mResourceName = rhs.mResourceName;
+	mHandle = rhs.mHandle;
+	mIsLoaded = rhs.mIsLoaded;
+
+	rhs.mHandle = ResourceHandle();
+	rhs.mIsLoaded = false;
+
+	return *this;
+}
+
+
 /**
  * D'tor
  */
@@ -42,7 +106,7 @@ Resource::~Resource()
  */
 const std::string& Resource::name() const
 {
-	return mResourceName;
+	return *mResourceName;
 }
 
 
@@ -51,7 +115,7 @@ const std::string& Resource::name() const
  */
 void Resource::name(const std::string& name)
 {
-	mResourceName = name;
+	mResourceName = std::make_shared<const std::string>(name);
 }
 
 
@@ -76,3 +140,27 @@ void Resource::loaded(bool loaded)
 {
 	mIsLoaded = loaded;
 }
+
+
+/**
+ * Gets the handle to the Resource's shared data.
+ *
+ * \note	Resources that don't share data across instances always
+ *			return an invalid handle.
+ */
+const ResourceHandle& Resource::handle() const
+{
+	return mHandle;
+}
+
+
+/**
+ * Sets the handle to the Resource's shared data.
+ *
+ * \note	This is an internal function only and is provided for use
+ *			by derived Resource types.
+ */
+void Resource::handle(const ResourceHandle& handle)
+{
+	mHandle = handle;
+}
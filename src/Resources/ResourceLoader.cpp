@@ -0,0 +1,596 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright © 2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// =
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#include "NAS2D/Resources/ResourceLoader.h"
+#include "NAS2D/Resources/FontInfo.h"
+
+#include "NAS2D/Common.h"
+#include "NAS2D/Filesystem.h"
+#include "NAS2D/Profiler.h"
+#include "NAS2D/Utility.h"
+
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_mixer.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+using namespace NAS2D;
+
+
+const unsigned int DEFAULT_UPLOAD_BUDGET = 4;
+
+
+// ==================================================================================
+// = UNEXPOSED FUNCTION PROTOTYPES
+// ==================================================================================
+extern ResourceHandle registerImage(const std::string& name, void* surface);
+
+extern void* decodeFont(const std::string& path, unsigned int ptSize, FontInfo& info);
+extern void* decodeBitmapFont(const std::string& path, int glyphWidth, int glyphHeight, int glyphSpace, FontInfo& info);
+extern ResourceHandle registerFont(const std::string& name, FontInfo& info, void* glyphMap);
+
+extern ResourceHandle registerMusic(const std::string& name, void* rwops);
+
+
+/**
+ * A single resource load request.
+ */
+struct ResourceLoader::Job
+{
+	enum JobType
+	{
+		JOB_IMAGE,
+		JOB_FONT,
+		JOB_BITMAP_FONT,
+		JOB_MUSIC,
+		JOB_SOUND
+	};
+
+	Job(JobType _type, const std::string& _path) : type(_type), path(_path), ptSize(0), glyphWidth(0), glyphHeight(0), glyphSpace(0), data(nullptr) {}
+
+	JobType			type;
+	std::string		path;
+
+	int				ptSize;
+	int				glyphWidth, glyphHeight, glyphSpace;
+
+	FontInfo		fontInfo;
+	void*			data;		/**< Decoded data. SDL_Surface, SDL_RWops or Mix_Chunk depending on type. \c nullptr if decoding failed. */
+};
+
+
+/**
+ * C'tor.
+ */
+ResourceLoader::ResourceLoader() :	mStopping(false),
+									mThreadCount(std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1)),
+									mUploadBudget(DEFAULT_UPLOAD_BUDGET),
+									mTotal(0),
+									mCompleted(0)
+{}
+
+
+/**
+ * D'tor.
+ *
+ * Stops the worker threads and discards any resources that haven't finished
+ * loading.
+ */
+ResourceLoader::~ResourceLoader()
+{
+	stopWorkers();
+
+	for (auto job : mJobs) { delete job; }
+	for (auto job : mDone) { discard(*job); delete job; }
+
+	clear();
+}
+
+
+/**
+ * Sets the number of worker threads used to read and decode files.
+ *
+ * Defaults to one less than the number of hardware threads available with a
+ * minimum of one.
+ *
+ * \note	Workers that are already running finish the file they're working on
+ *			before being stopped.
+ */
+void ResourceLoader::threadCount(int count)
+{
+	stopWorkers();
+	mThreadCount = std::max(1, count);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (!mJobs.empty()) { startWorkers(); }
+}
+
+
+/**
+ * Gets the number of worker threads used to read and decode files.
+ */
+int ResourceLoader::threadCount() const
+{
+	return mThreadCount;
+}
+
+
+/**
+ * Sets the maximum time, in milliseconds, that update() spends finishing loaded
+ * resources each frame. At least one resource is finished per call regardless
+ * of the budget.
+ *
+ * Defaults to 4 milliseconds.
+ */
+void ResourceLoader::uploadBudget(unsigned int ms)
+{
+	mUploadBudget = ms;
+}
+
+
+/**
+ * Gets the maximum time, in milliseconds, that update() spends finishing loaded
+ * resources each frame.
+ */
+unsigned int ResourceLoader::uploadBudget() const
+{
+	return mUploadBudget;
+}
+
+
+/**
+ * Queues an Image to be loaded in the background.
+ *
+ * \param	filePath	Path to an image file.
+ */
+void ResourceLoader::loadImage(const std::string& filePath)
+{
+	queue(new Job(Job::JOB_IMAGE, filePath));
+}
+
+
+/**
+ * Queues a TrueType or OpenType Font to be loaded in the background.
+ *
+ * \param	filePath	Path to a font file.
+ * \param	ptSize		Point size of the font. Defaults to 12pt.
+ */
+void ResourceLoader::loadFont(const std::string& filePath, int ptSize)
+{
+	Job* job = new Job(Job::JOB_FONT, filePath);
+	job->ptSize = ptSize;
+	queue(job);
+}
+
+
+/**
+ * Queues a bitmap Font to be loaded in the background.
+ *
+ * \param	filePath	Path to a font file.
+ * \param	glyphWidth	Width of glyphs in the bitmap font.
+ * \param	glyphHeight	Height of the glyphs in the bitmap font.
+ * \param	glyphSpace	Spacing to use when drawing glyphs.
+ */
+void ResourceLoader::loadFont(const std::string& filePath, int glyphWidth, int glyphHeight, int glyphSpace)
+{
+	Job* job = new Job(Job::JOB_BITMAP_FONT, filePath);
+	job->glyphWidth = glyphWidth;
+	job->glyphHeight = glyphHeight;
+	job->glyphSpace = glyphSpace;
+	queue(job);
+}
+
+
+/**
+ * Queues Music to be loaded in the background.
+ *
+ * \param	filePath	Path to a music file.
+ */
+void ResourceLoader::loadMusic(const std::string& filePath)
+{
+	queue(new Job(Job::JOB_MUSIC, filePath));
+}
+
+
+/**
+ * Queues a Sound to be loaded in the background.
+ *
+ * \param	filePath	Path to a sound file.
+ */
+void ResourceLoader::loadSound(const std::string& filePath)
+{
+	queue(new Job(Job::JOB_SOUND, filePath));
+}
+
+
+/**
+ * Finishes loading resources that have been decoded by the worker threads.
+ *
+ * Called once per frame by the Game loop. Spends at most uploadBudget()
+ * milliseconds before returning.
+ */
+void ResourceLoader::update()
+{
+	NAS2D_PROFILE_ZONE("ResourceLoader::update");
+
+	if (finished())
+	{
+		return;
+	}
+
+	unsigned int start = SDL_GetTicks();
+	while (true)
+	{
+		Job* job = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (mDone.empty()) { return; }
+
+			job = mDone.front();
+			mDone.pop_front();
+		}
+
+		finish(job);
+
+		if (SDL_GetTicks() - start >= mUploadBudget)
+		{
+			return;
+		}
+	}
+}
+
+
+/**
+ * Blocks until every queued resource has finished loading.
+ */
+void ResourceLoader::wait()
+{
+	while (!finished())
+	{
+		Job* job = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mDoneCondition.wait(lock, [this] { return !mDone.empty(); });
+
+			job = mDone.front();
+			mDone.pop_front();
+		}
+
+		finish(job);
+	}
+}
+
+
+/**
+ * Releases all resources kept resident by the ResourceLoader.
+ *
+ * Resources that are still being loaded are not affected.
+ */
+void ResourceLoader::clear()
+{
+	mImages.clear();
+	mFonts.clear();
+	mMusic.clear();
+
+	for (auto sound : mSounds) { delete sound; }
+	mSounds.clear();
+}
+
+
+/**
+ * Gets the number of resources that have been requested but haven't finished
+ * loading.
+ */
+int ResourceLoader::pending() const
+{
+	return mTotal - mCompleted;
+}
+
+
+/**
+ * Gets the number of resources that have finished loading since the
+ * ResourceLoader was last idle.
+ */
+int ResourceLoader::completed() const
+{
+	return mCompleted;
+}
+
+
+/**
+ * Gets the progress of the current set of load requests.
+ *
+ * \return	Value between 0.0f and 1.0f. 1.0f if there is nothing to load.
+ */
+float ResourceLoader::progress() const
+{
+	if (mTotal == 0)
+	{
+		return 1.0f;
+	}
+
+	return static_cast<float>(mCompleted) / static_cast<float>(mTotal);
+}
+
+
+/**
+ * Gets whether all requested resources have finished loading.
+ */
+bool ResourceLoader::finished() const
+{
+	return pending() == 0;
+}
+
+
+/**
+ * Signal emitted on the main thread when an Image has finished loading.
+ */
+ResourceLoader::ImageLoadedCallback& ResourceLoader::imageLoaded()
+{
+	return mImageLoaded;
+}
+
+
+/**
+ * Signal emitted on the main thread when a Font has finished loading.
+ */
+ResourceLoader::FontLoadedCallback& ResourceLoader::fontLoaded()
+{
+	return mFontLoaded;
+}
+
+
+/**
+ * Signal emitted on the main thread when Music has finished loading.
+ */
+ResourceLoader::MusicLoadedCallback& ResourceLoader::musicLoaded()
+{
+	return mMusicLoaded;
+}
+
+
+/**
+ * Signal emitted on the main thread when a Sound has finished loading.
+ */
+ResourceLoader::SoundLoadedCallback& ResourceLoader::soundLoaded()
+{
+	return mSoundLoaded;
+}
+
+
+/**
+ * Hands a Job to the worker threads.
+ */
+void ResourceLoader::queue(Job* job)
+{
+	// Start counting again once a previous set of requests has finished.
+	if (finished())
+	{
+		mTotal = 0;
+		mCompleted = 0;
+	}
+
+	++mTotal;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	mJobs.push_back(job);
+
+	if (mWorkers.empty()) { startWorkers(); }
+
+	mJobCondition.notify_one();
+}
+
+
+/**
+ * Finishes loading a decoded Job on the main thread and emits the matching
+ * signal.
+ *
+ * Resources that failed to decode are loaded synchronously instead so that
+ * errors are reported the same way as when loading them directly.
+ */
+void ResourceLoader::finish(Job* job)
+{
+	// Loading synchronously may throw, don't leak the Job or stall progress if it does.
+	std::unique_ptr<Job> owner(job);
+	++mCompleted;
+
+	switch (job->type)
+	{
+	case Job::JOB_IMAGE:
+	{
+		if (job->data) { registerImage(job->path, job->data); }
+
+		Image image(job->path);
+		mImages.push_back(image);
+		mImageLoaded(image);
+		break;
+	}
+	case Job::JOB_FONT:
+	{
+		if (job->data) { registerFont(job->path + string_format("_%ipt", job->ptSize), job->fontInfo, job->data); }
+
+		Font font(job->path, job->ptSize);
+		mFonts.push_back(font);
+		mFontLoaded(font);
+		break;
+	}
+	case Job::JOB_BITMAP_FONT:
+	{
+		if (job->data) { registerFont(job->path, job->fontInfo, job->data); }
+
+		Font font(job->path, job->glyphWidth, job->glyphHeight, job->glyphSpace);
+		mFonts.push_back(font);
+		mFontLoaded(font);
+		break;
+	}
+	case Job::JOB_MUSIC:
+	{
+		if (job->data) { registerMusic(job->path, job->data); }
+
+		Music music(job->path);
+		mMusic.push_back(music);
+		mMusicLoaded(music);
+		break;
+	}
+	case Job::JOB_SOUND:
+	{
+		Sound* sound = job->data ? new Sound(job->path, job->data) : new Sound(job->path);
+		mSounds.push_back(sound);
+		mSoundLoaded(*sound);
+		break;
+	}
+	}
+}
+
+
+/**
+ * Starts the worker threads.
+ *
+ * \note	Must be called with mMutex locked.
+ */
+void ResourceLoader::startWorkers()
+{
+	// Initialize image decoders up front, IMG_Init() is not thread safe.
+	IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG | IMG_INIT_TIF);
+
+	mStopping = false;
+	for (int i = 0; i < mThreadCount; ++i)
+	{
+		mWorkers.push_back(std::thread(&ResourceLoader::work, this));
+	}
+}
+
+
+/**
+ * Stops the worker threads and waits for them to exit. Queued Jobs are kept.
+ */
+void ResourceLoader::stopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+
+	mJobCondition.notify_all();
+
+	for (auto& worker : mWorkers) { worker.join(); }
+	mWorkers.clear();
+}
+
+
+/**
+ * Worker thread loop.
+ */
+void ResourceLoader::work()
+{
+	while (true)
+	{
+		Job* job = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mJobCondition.wait(lock, [this] { return mStopping || !mJobs.empty(); });
+			if (mStopping) { return; }
+
+			job = mJobs.front();
+			mJobs.pop_front();
+		}
+
+		decode(*job);
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mDone.push_back(job);
+		}
+
+		mDoneCondition.notify_one();
+	}
+}
+
+
+/**
+ * Reads and decodes the data of a Job. Called from the worker threads.
+ *
+ * \note	Nothing here may touch OpenGL or the resource registries.
+ */
+void ResourceLoader::decode(Job& job)
+{
+	NAS2D_PROFILE_ZONE("ResourceLoader::decode");
+
+	try
+	{
+		switch (job.type)
+		{
+		case Job::JOB_IMAGE:
+		{
+			File file = Utility<Filesystem>::get().open(job.path);
+			if (file.empty()) { return; }
+
+			job.data = IMG_Load_RW(SDL_RWFromConstMem(file.raw_bytes(), static_cast<int>(file.size())), 0);
+			break;
+		}
+		case Job::JOB_FONT:
+			job.data = decodeFont(job.path, job.ptSize, job.fontInfo);
+			break;
+
+		case Job::JOB_BITMAP_FONT:
+			job.data = decodeBitmapFont(job.path, job.glyphWidth, job.glyphHeight, job.glyphSpace, job.fontInfo);
+			break;
+
+		case Job::JOB_MUSIC:
+			job.data = Utility<Filesystem>::get().openStream(job.path).rwops();
+			break;
+
+		case Job::JOB_SOUND:
+		{
+			File file = Utility<Filesystem>::get().open(job.path);
+			if (file.empty()) { return; }
+
+			job.data = Mix_LoadWAV_RW(SDL_RWFromConstMem(file.raw_bytes(), static_cast<int>(file.size())), 0);
+			break;
+		}
+		}
+	}
+	catch (std::exception& e)
+	{
+		// The resource is loaded again on the main thread which reports the error.
+		std::cout << "ResourceLoader: '" << job.path << "': " << e.what() << std::endl;
+		job.data = nullptr;
+	}
+}
+
+
+/**
+ * Frees the decoded data of a Job that will never be finished.
+ */
+void ResourceLoader::discard(Job& job)
+{
+	if (!job.data) { return; }
+
+	switch (job.type)
+	{
+	case Job::JOB_IMAGE:
+	case Job::JOB_FONT:
+	case Job::JOB_BITMAP_FONT:
+		SDL_FreeSurface(static_cast<SDL_Surface*>(job.data));
+		break;
+
+	case Job::JOB_MUSIC:
+		SDL_RWclose(static_cast<SDL_RWops*>(job.data));
+		break;
+
+	case Job::JOB_SOUND:
+		Mix_FreeChunk(static_cast<Mix_Chunk*>(job.data));
+		break;
+	}
+
+	job.data = nullptr;
+}
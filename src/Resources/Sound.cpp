@@ -37,6 +37,21 @@ _chunk(nullptr)
 }
 
 
+/**
+ * C'tor.
+ *
+ * Takes ownership of an already decoded sound.
+ *
+ * \param	filePath	File path the sound was loaded from.
+ * \param	chunk		Pointer to a Mix_Chunk.
+ */
+Sound::Sound(const std::string& filePath, void* chunk):	Resource(filePath),
+_chunk(chunk)
+{
+	loaded(_chunk != nullptr);
+}
+
+
 /**
  * D'tor.
  */
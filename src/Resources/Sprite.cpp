@@ -10,7 +10,10 @@
 
 #include "NAS2D/Resources/Sprite.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
 
 using namespace std;
 using namespace NAS2D;
@@ -21,6 +24,25 @@ const string DEFAULT_ACTION("default");
 
 const int FRAME_PAUSE = -1;
 
+bool SPRITE_STREAMING_LOAD = false;
+bool SPRITE_COMPILED_CACHE = false;
+
+const string SPRITE_COMPILED_EXTENSION(".compiled");
+const char SPRITE_COMPILED_MAGIC[] = { 'N', 'S', 'P', 'C' };
+const uint32_t SPRITE_COMPILED_FORMAT = 1;
+
+
+// ==================================================================================
+// = UNEXPOSED FUNCTION PROTOTYPES
+// ==================================================================================
+uint64_t sourceHash(const File& file);
+
+void writeInt(string& buffer, uint32_t value);
+void writeString(string& buffer, const string& value);
+
+bool readInt(const char*& p, const char* end, uint32_t& value);
+bool readString(const char*& p, const char* end, string& value);
+
 
 // Adds a row/name tag to the end of messages.
 string endTag(int row, const std::string& name)
@@ -29,6 +51,43 @@ string endTag(int row, const std::string& name)
 }
 
 
+/**
+ * Values read from a <frame> tag before they're validated.
+ */
+struct Sprite::FrameDefinition
+{
+	FrameDefinition(int row) : delay(0), x(0), y(0), width(0), height(0), anchorX(0), anchorY(0), row(row) {}
+
+	std::string		sheetId;
+
+	int				delay;
+	int				x, y;
+	int				width, height;
+	int				anchorX, anchorY;
+
+	int				row;		/**< Row of the <frame> tag (for error information). */
+};
+
+
+/**
+ * Imagesheets and actions of a sprite definition file.
+ *
+ * Definitions don't change once they're loaded and are shared by every Sprite
+ * loaded from the same file.
+ */
+struct Sprite::SpriteDefinition
+{
+	SpriteDefinition() {}
+
+	SheetList		imageSheets;	/**< Imagesheets */
+	ActionList		actions;		/**< A list of Actions and their associated Frames. */
+
+private:
+	SpriteDefinition(const SpriteDefinition&);				// Frames point into imageSheets.
+	SpriteDefinition& operator=(const SpriteDefinition&);	// Frames point into imageSheets.
+};
+
+
 /**
  * Default c'tor.
  * 
@@ -37,7 +96,8 @@ string endTag(int row, const std::string& name)
  * \warning	Generally speaking, Sprites should not be instantiated
  *			with the default c'tor.
  */
-Sprite::Sprite():	mSpriteName("Default Constructed"),
+Sprite::Sprite():	mDefinition(std::make_shared<SpriteDefinition>()),
+					mSpriteName("Default Constructed"),
 					mCurrentAction(DEFAULT_ACTION),
 					mCurrentFrame(0),
 					mColor(COLOR_NORMAL),
@@ -52,6 +112,9 @@ Sprite::Sprite():	mSpriteName("Default Constructed"),
  * C'tor.
  *
  * \param filePath	File path of the Sprite definition file.
+ *
+ * \note	The definition file is only loaded if no other Sprite loaded from
+ *			the same file still exists.
  */
 Sprite::Sprite(const std::string& filePath):	mSpriteName(filePath),
 												mCurrentAction(DEFAULT_ACTION),
@@ -60,15 +123,32 @@ Sprite::Sprite(const std::string& filePath):	mSpriteName(filePath),
 												mRotationAngle(0.0f),
 												mPaused(false)
 {
-	processXml(filePath);
+	std::weak_ptr<SpriteDefinition>& cached = definitionCache()[filePath];
+
+	mDefinition = cached.lock();
+	if (mDefinition)
+	{
+		return;
+	}
+
+	mDefinition = std::make_shared<SpriteDefinition>();
+	cached = mDefinition;
+
+	if (SPRITE_COMPILED_CACHE)
+	{
+		processCompiled(filePath);
+	}
+	else
+	{
+		processXml(filePath);
+	}
 }
 
 
 /**
  * Copy C'tor
  */
-Sprite::Sprite(const Sprite &sprite):	mImageSheets(sprite.mImageSheets),
-										mActions(sprite.mActions),
+Sprite::Sprite(const Sprite &sprite):	mDefinition(sprite.mDefinition),
 										mSpriteName(sprite.mSpriteName),
 										mCurrentAction(sprite.mCurrentAction),
 										mCurrentFrame(sprite.mCurrentFrame),
@@ -83,8 +163,7 @@ Sprite::Sprite(const Sprite &sprite):	mImageSheets(sprite.mImageSheets),
  */
 Sprite& Sprite::operator=(const Sprite &rhs)
 {
-	mImageSheets	= rhs.mImageSheets;
-	mActions		= rhs.mActions;
+	mDefinition		= rhs.mDefinition;
 	mSpriteName		= rhs.mSpriteName;
 	mCurrentAction	= rhs.mCurrentAction;
 	mCurrentFrame	= rhs.mCurrentFrame;
@@ -111,8 +190,8 @@ void Sprite::play(const std::string& action)
 {
 	// Set the current frame list to the defined action. If action
 	// isn't found, set to default and reset frame counter.
-	ActionList::iterator actionIt = mActions.find(toLowercase(action));
-	if (actionIt == mActions.end())
+	ActionList::const_iterator actionIt = mDefinition->actions.find(toLowercase(action));
+	if (actionIt == mDefinition->actions.end())
 	{
 		cout << "Named action '" << action << "' is not defined in '" << name() << "'." << endl;
 		mCurrentAction = DEFAULT_ACTION;
@@ -160,12 +239,13 @@ void Sprite::resume()
  */
 void Sprite::skip(int frames)
 {
-	if (mActions.find(toLowercase(mCurrentAction)) == mActions.end())
+	ActionList::const_iterator actionIt = mDefinition->actions.find(mCurrentAction);
+	if (actionIt == mDefinition->actions.end())
 	{
 		return;
 	}
 
-	mCurrentFrame = frames % mActions[mCurrentAction].size();
+	mCurrentFrame = frames % actionIt->second.size();
 }
 
 
@@ -177,18 +257,19 @@ void Sprite::skip(int frames)
  */
 void Sprite::update(float x, float y)
 {
-	SpriteFrame frame = mActions[mCurrentAction][mCurrentFrame];
+	const FrameList& frames = currentFrames();
+	const SpriteFrame& frame = frames[mCurrentFrame];
 
 	if (!mPaused && (frame.frameDelay() != FRAME_PAUSE))
 	{
-		while (frame.frameDelay() > 0 && static_cast<int>(mTimer.accumulator()) >= frame.frameDelay())
+		while (frame.frameDelay() > 0 && mTimer.preciseAccumulator() >= frame.frameDelay())
 		{
 			mTimer.adjust_accumulator(frame.frameDelay());
 			mCurrentFrame++;
 		}
 
 		// Check that our frame count is within bounds.
-		if (mCurrentFrame >= mActions[mCurrentAction].size())
+		if (mCurrentFrame >= frames.size())
 		{
 			mCurrentFrame = 0;
 			mFrameCallback();		// Notifiy any frame listeners that the animation sequence has completed.
@@ -199,7 +280,7 @@ void Sprite::update(float x, float y)
 		mFrameCallback();
 	}
 
-	Utility<Renderer>::get().drawSubImageRotated(mImageSheets[frame.sheetId()], x - frame.anchorX(), y - frame.anchorY(), static_cast<float>(frame.x()), static_cast<float>(frame.y()), static_cast<float>(frame.width()), static_cast<float>(frame.height()), mRotationAngle, mColor);
+	Utility<Renderer>::get().drawSubImageRotated(frame.sheet(), x - frame.anchorX(), y - frame.anchorY(), static_cast<float>(frame.x()), static_cast<float>(frame.y()), static_cast<float>(frame.width()), static_cast<float>(frame.height()), mRotationAngle, mColor);
 }
 
 
@@ -234,7 +315,7 @@ StringList Sprite::actions()
 {
 	StringList list;
 
-	for (auto it = mActions.begin(); it != mActions.end(); ++it)
+	for (auto it = mDefinition->actions.begin(); it != mDefinition->actions.end(); ++it)
 	{
 		list.push_back(it->first);
 	}
@@ -249,7 +330,7 @@ StringList Sprite::actions()
 void Sprite::incrementFrame()
 {
 	++mCurrentFrame;
-	if (mCurrentFrame >= mActions[mCurrentAction].size())
+	if (mCurrentFrame >= currentFrames().size())
 	{
 		mCurrentFrame = 0;
 	}
@@ -263,13 +344,255 @@ void Sprite::decrementFrame()
 {
 	if (mCurrentFrame == 0)
 	{
-		mCurrentFrame = mActions[mCurrentAction].size();
+		mCurrentFrame = currentFrames().size();
 	}
 
 	--mCurrentFrame;
 }
 
 
+/**
+ * Sets whether Sprites read their definition files with an XmlReader instead
+ * of building an XmlDocument. Off by default.
+ *
+ * \note	Only affects Sprites constructed after the call.
+ */
+void Sprite::streamingLoad(bool enabled)
+{
+	SPRITE_STREAMING_LOAD = enabled;
+}
+
+
+/**
+ * Gets whether Sprites read their definition files with an XmlReader.
+ */
+bool Sprite::streamingLoad()
+{
+	return SPRITE_STREAMING_LOAD;
+}
+
+
+/**
+ * Sets whether Sprites keep a compiled, binary copy of their definition files.
+ * Off by default.
+ *
+ * When enabled, the first time a sprite definition is loaded the resulting
+ * actions, frames and imagesheet paths are written to a file with the same
+ * name as the definition plus a '.compiled' extension in the write directory.
+ * Later loads read the compiled file instead of parsing and validating the XML.
+ * Compiled files store a hash of the definition they were built from and are
+ * rebuilt when the definition changes.
+ *
+ * \note	Only affects Sprites constructed after the call.
+ */
+void Sprite::compiledCache(bool enabled)
+{
+	SPRITE_COMPILED_CACHE = enabled;
+}
+
+
+/**
+ * Gets whether Sprites keep a compiled copy of their definition files.
+ */
+bool Sprite::compiledCache()
+{
+	return SPRITE_COMPILED_CACHE;
+}
+
+
+/**
+ * Loads a Sprite from its compiled definition file, compiling the XML
+ * definition first if there is no compiled file or it's out of date.
+ *
+ * \param filePath	File path of the sprite XML definition file.
+ */
+void Sprite::processCompiled(const std::string& filePath)
+{
+	Filesystem& fs = Utility<Filesystem>::get();
+
+	if (!fs.exists(filePath))
+	{
+		processXml(filePath);
+		return;
+	}
+
+	uint64_t hash = sourceHash(fs.open(filePath));
+	string compiledPath = filePath + SPRITE_COMPILED_EXTENSION;
+
+	if (fs.exists(compiledPath) && readCompiled(fs.open(compiledPath), hash))
+	{
+		return;
+	}
+
+	processXml(filePath);
+	writeCompiled(compiledPath, hash);
+}
+
+
+/**
+ * Reads a compiled sprite definition.
+ *
+ * \param file	Compiled sprite definition.
+ * \param hash	Hash of the XML definition the compiled definition must match.
+ *
+ * \return	False if the compiled definition is malformed, out of date or
+ *			references an imagesheet that can't be loaded or that no longer
+ *			fits its frames. The Sprite is left unchanged in that case.
+ */
+bool Sprite::readCompiled(const File& file, unsigned long long hash)
+{
+	const char* p = file.raw_bytes();
+	const char* end = p + file.size();
+
+	if (file.size() < sizeof(SPRITE_COMPILED_MAGIC) + 12 || !std::equal(SPRITE_COMPILED_MAGIC, SPRITE_COMPILED_MAGIC + sizeof(SPRITE_COMPILED_MAGIC), p))
+	{
+		return false;
+	}
+	p += sizeof(SPRITE_COMPILED_MAGIC);
+
+	uint32_t format = 0, hashLow = 0, hashHigh = 0;
+	readInt(p, end, format);
+	readInt(p, end, hashLow);
+	readInt(p, end, hashHigh);
+	if (format != SPRITE_COMPILED_FORMAT || ((static_cast<uint64_t>(hashHigh) << 32) | hashLow) != hash)
+	{
+		return false;
+	}
+
+	Filesystem& fs = Utility<Filesystem>::get();
+
+	SheetList sheets;
+	vector<Image*> sheetIndex;
+
+	uint32_t count = 0;
+	if (!readInt(p, end, count)) { return false; }
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		string id, path;
+		if (!readString(p, end, id) || !readString(p, end, path) || !fs.exists(path))
+		{
+			return false;
+		}
+
+		Image& image = sheets[id];
+		image = Image(path);
+		if (!image.loaded())
+		{
+			return false;
+		}
+
+		sheetIndex.push_back(&image);
+	}
+
+	ActionList actions;
+
+	if (!readInt(p, end, count)) { return false; }
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		string action;
+		uint32_t frameCount = 0;
+		// The XML loader never makes an action without frames and Sprite relies on that.
+		if (!readString(p, end, action) || !readInt(p, end, frameCount) || frameCount == 0 || static_cast<size_t>(end - p) / 32 < frameCount)
+		{
+			return false;
+		}
+
+		FrameList& frameList = actions[action];
+		frameList.reserve(frameCount);
+		for (uint32_t j = 0; j < frameCount; ++j)
+		{
+			uint32_t sheet = 0, values[7] = {};
+			readInt(p, end, sheet);
+			for (auto& value : values) { readInt(p, end, value); }
+
+			int x = static_cast<int32_t>(values[0]), y = static_cast<int32_t>(values[1]);
+			int width = static_cast<int32_t>(values[2]), height = static_cast<int32_t>(values[3]);
+
+			// Imagesheets can change without the definition changing. Written so that
+			// a corrupt file can't overflow the sums.
+			if (sheet >= sheetIndex.size() || x < 0 || y < 0 || width < 1 || height < 1 || x > sheetIndex[sheet]->width() - width || y > sheetIndex[sheet]->height() - height)
+			{
+				return false;
+			}
+
+			frameList.push_back(SpriteFrame(*sheetIndex[sheet], x, y, width, height, static_cast<int32_t>(values[4]), static_cast<int32_t>(values[5]), static_cast<int32_t>(values[6])));
+		}
+	}
+
+	// Swapping keeps the frames' pointers to their imagesheets valid.
+	mDefinition->imageSheets.swap(sheets);
+	mDefinition->actions.swap(actions);
+
+	return true;
+}
+
+
+/**
+ * Writes a compiled definition of the Sprite.
+ *
+ * Sprites that failed to load any of their imagesheets aren't compiled so that
+ * errors in their definitions keep being reported.
+ *
+ * \param filePath	File path of the compiled definition.
+ * \param hash		Hash of the XML definition the Sprite was built from.
+ */
+void Sprite::writeCompiled(const std::string& filePath, unsigned long long hash)
+{
+	Filesystem& fs = Utility<Filesystem>::get();
+
+	string buffer(SPRITE_COMPILED_MAGIC, sizeof(SPRITE_COMPILED_MAGIC));
+	writeInt(buffer, SPRITE_COMPILED_FORMAT);
+	writeInt(buffer, static_cast<uint32_t>(hash));
+	writeInt(buffer, static_cast<uint32_t>(hash >> 32));
+
+	map<const Image*, uint32_t> sheetIndex;
+
+	writeInt(buffer, static_cast<uint32_t>(mDefinition->imageSheets.size()));
+	for (const auto& sheet : mDefinition->imageSheets)
+	{
+		if (!sheet.second.loaded() || !fs.exists(sheet.second.name()))
+		{
+			return;
+		}
+
+		uint32_t index = static_cast<uint32_t>(sheetIndex.size());
+		sheetIndex[&sheet.second] = index;
+
+		writeString(buffer, sheet.first);
+		writeString(buffer, sheet.second.name());
+	}
+
+	writeInt(buffer, static_cast<uint32_t>(mDefinition->actions.size()));
+	for (const auto& action : mDefinition->actions)
+	{
+		writeString(buffer, action.first);
+		writeInt(buffer, static_cast<uint32_t>(action.second.size()));
+		for (const auto& frame : action.second)
+		{
+			writeInt(buffer, sheetIndex[&frame.sheet()]);
+			writeInt(buffer, static_cast<uint32_t>(frame.x()));
+			writeInt(buffer, static_cast<uint32_t>(frame.y()));
+			writeInt(buffer, static_cast<uint32_t>(frame.width()));
+			writeInt(buffer, static_cast<uint32_t>(frame.height()));
+			writeInt(buffer, static_cast<uint32_t>(frame.anchorX()));
+			writeInt(buffer, static_cast<uint32_t>(frame.anchorY()));
+			writeInt(buffer, static_cast<uint32_t>(frame.frameDelay()));
+		}
+	}
+
+	string directory = fs.workingPath(filePath);
+	if (!directory.empty() && !fs.isDirectory(directory))
+	{
+		fs.makeDirectory(directory);
+	}
+
+	if (!fs.write(File(std::move(buffer), filePath)))
+	{
+		cout << "Unable to write compiled sprite '" << filePath << "'." << endl;
+	}
+}
+
+
 /**
  * Parses a Sprite XML Definition File.
  *
@@ -277,6 +600,12 @@ void Sprite::decrementFrame()
  */
 void Sprite::processXml(const std::string& filePath)
 {
+	if (SPRITE_STREAMING_LOAD)
+	{
+		processXmlStream(filePath);
+		return;
+	}
+
 	Filesystem& fs = Utility<Filesystem>::get();
 
 	if (!fs.exists(filePath))
@@ -299,8 +628,12 @@ void Sprite::processXml(const std::string& filePath)
 	XmlDocument docXml;
 	XmlElement *xmlRootElement = nullptr;
 
+	// The document is discarded once the sprite is built, allocate it all at once
+	// and leave strings in the file's buffer.
+	docXml.arenaAllocation(true);
+
 	// Load the XML document and handle any errors if occuring
-	docXml.parse(xmlFile.raw_bytes());
+	docXml.parse(xmlFile);
 	if (docXml.error())
 	{
 		cout << "Malformed XML. Row: " << docXml.errorRow() << " Column: " << docXml.errorCol() << ": " << docXml.errorDesc() << " (" << name() << ")" << endl;
@@ -320,13 +653,13 @@ void Sprite::processXml(const std::string& filePath)
 
 		// Get the Sprite version.
 		XmlAttribute* version = xmlRootElement->firstAttribute();
-		if (!version || version->value().empty())
+		if (!version || version->valueView().empty())
 		{
 			cout << "Root element in sprite file '" << filePath << "' doesn't define a version." << endl;
 			addDefaultAction();
 			return;
 		}
-		else if (version && version->value() != SPRITE_VERSION)
+		else if (version && version->valueView() != SPRITE_VERSION)
 		{
 			cout << "Sprite version mismatch (" << versionString() << ") in '" << filePath << "'. Expected (" << SPRITE_VERSION << ")." << endl;
 			addDefaultAction();
@@ -343,6 +676,175 @@ void Sprite::processXml(const std::string& filePath)
 }
 
 
+/**
+ * Parses a Sprite XML Definition File with an XmlReader instead of building
+ * an XmlDocument.
+ *
+ * Imagesheet and action definitions are collected as the file is read and
+ * processed afterward so imagesheets can still appear anywhere in the file.
+ *
+ * \param filePath	File path of the sprite XML definition file.
+ */
+void Sprite::processXmlStream(const std::string& filePath)
+{
+	Filesystem& fs = Utility<Filesystem>::get();
+
+	if (!fs.exists(filePath))
+	{
+		cout << "Sprite file '" << filePath << "' doesn't exist." << endl;
+		addDefaultAction();
+		return;
+	}
+
+	FileStream stream = fs.openStream(filePath);
+	if (stream.size() == 0)
+	{
+		cout << "Sprite file '" << filePath << "' is empty." << endl;
+		addDefaultAction();
+		return;
+	}
+
+	struct SheetDefinition { string id, src; int row; };
+	struct ActionDefinition { string name; int row; vector<FrameDefinition> frames; };
+
+	vector<SheetDefinition> sheets;
+	vector<ActionDefinition> actions;
+
+	XmlReader reader(stream);
+
+	bool foundRoot = false, inRoot = false;
+	ActionDefinition* action = nullptr;
+	while (reader.read())
+	{
+		if (reader.type() == XmlReader::XML_READER_END_ELEMENT)
+		{
+			if (reader.depth() == 0) { inRoot = false; }
+			else if (reader.depth() == 1) { action = nullptr; }
+			continue;
+		}
+
+		if (reader.depth() == 0)
+		{
+			if (reader.type() != XmlReader::XML_READER_START_ELEMENT || reader.name() != "sprite" || foundRoot)
+			{
+				continue;
+			}
+
+			// Get the Sprite version.
+			if (reader.attributeValue(0).empty())
+			{
+				cout << "Root element in sprite file '" << filePath << "' doesn't define a version." << endl;
+				addDefaultAction();
+				return;
+			}
+			else if (reader.attributeValue(0) != SPRITE_VERSION)
+			{
+				cout << "Sprite version mismatch (" << versionString() << ") in '" << filePath << "'. Expected (" << SPRITE_VERSION << ")." << endl;
+				addDefaultAction();
+				return;
+			}
+
+			foundRoot = inRoot = true;
+		}
+		else if (inRoot && reader.depth() == 1 && reader.type() == XmlReader::XML_READER_START_ELEMENT)
+		{
+			if (reader.name() == "imagesheet")
+			{
+				SheetDefinition sheet = { string(), string(), reader.row() };
+				for (int i = 0; i < reader.attributeCount(); ++i)
+				{
+					if (caseInsensitiveEqual(reader.attributeName(i), "id")) { sheet.id = reader.attributeValue(i); }
+					else if (caseInsensitiveEqual(reader.attributeName(i), "src")) { sheet.src = reader.attributeValue(i); }
+				}
+
+				sheets.push_back(sheet);
+			}
+			else if (caseInsensitiveEqual(reader.name(), "action"))
+			{
+				actions.push_back(ActionDefinition());
+				action = &actions.back();
+				action->row = reader.row();
+
+				for (int i = 0; i < reader.attributeCount(); ++i)
+				{
+					if (caseInsensitiveEqual(reader.attributeName(i), "name")) { action->name = reader.attributeValue(i); }
+				}
+			}
+		}
+		else if (action && reader.depth() == 2)
+		{
+			if (reader.type() == XmlReader::XML_READER_START_ELEMENT && reader.name() == "frame")
+			{
+				FrameDefinition frame(reader.row());
+				for (int i = 0; i < reader.attributeCount(); ++i)
+				{
+					if (!frameAttribute(frame, reader.attributeName(i), reader.attributeValue(i)))
+					{
+						std::cout << "Unexpected attribute '" << reader.attributeName(i) << "' found on row " << frame.row << std::endl;
+					}
+				}
+
+				action->frames.push_back(frame);
+			}
+			else
+			{
+				const string& tag = reader.type() == XmlReader::XML_READER_TEXT ? reader.text() : reader.name();
+				cout << "Unexpected tag '<" << tag << ">'." << endTag(reader.row(), name()) << endl;
+			}
+		}
+	}
+
+	if (reader.error())
+	{
+		cout << "Malformed XML. Row: " << reader.errorRow() << " Column: " << reader.errorCol() << ": " << reader.errorDesc() << " (" << name() << ")" << endl;
+		addDefaultAction();
+		return;
+	}
+
+	if (!foundRoot)
+	{
+		cout << "Specified file '" << filePath << "' doesn't contain a <sprite> tag." << endl;
+		addDefaultAction();
+		return;
+	}
+
+	for (const auto& sheet : sheets)
+	{
+		if (sheet.id.empty())
+		{
+			cout << "Zero-length 'id' value in Imagesheet definition." << endTag(sheet.row, name()) << endl;
+			continue;
+		}
+
+		if (sheet.src.empty())
+		{
+			cout << "Zero-length 'src' value in Imagesheet definition." << endTag(sheet.row, name()) << endl;
+			continue;
+		}
+
+		addImageSheet(sheet.id, sheet.src, sheet.row);
+	}
+
+	for (const auto& definition : actions)
+	{
+		if (definition.name.empty())
+		{
+			cout << "Zero-length 'name' value in Action definition." << endTag(definition.row, name()) << endl;
+			continue;
+		}
+
+		if (mDefinition->actions.find(toLowercase(definition.name)) == mDefinition->actions.end())
+		{
+			addAction(definition.name, definition.frames);
+		}
+		else
+		{
+			cout << "Redefinition of action '" << definition.name << "'. First definition will be used." << endTag(definition.row, name()) << endl;
+		}
+	}
+}
+
+
 /**
  * Iterates through all elements of a Sprite XML definition looking
  * for 'imagesheet' elements and processes them.
@@ -359,13 +861,14 @@ void Sprite::processImageSheets(void* root)
 	string id, src;
 	while ((node = e->iterateChildren(node)))
 	{
-		if (node->value() == "imagesheet" && node->toElement())
+		if (node->valueView() == "imagesheet" && node->toElement())
 		{
 			XmlAttribute* attribute = node->toElement()->firstAttribute();
 			while (attribute)
 			{
-				if (toLowercase(attribute->name()) == "id") { id = attribute->value(); }
-				else if (toLowercase(attribute->name()) == "src") { src = attribute->value(); }
+				const XmlString& value = attribute->valueView();
+				if (attribute->nameView().equals("id", true)) { id.assign(value.data(), value.size()); }
+				else if (attribute->nameView().equals("src", true)) { src.assign(value.data(), value.size()); }
 
 				attribute = attribute->next();
 			}
@@ -382,7 +885,7 @@ void Sprite::processImageSheets(void* root)
 				continue;
 			}
 
-			addImageSheet(id, src, node);
+			addImageSheet(id, src, node->row());
 		}
 	}
 }
@@ -396,30 +899,30 @@ void Sprite::processImageSheets(void* root)
  * 
  * \param	id		String ID for the image sheet.
  * \param	src		Image sheet file path.
- * \param	node	XML Node (for error information).
+ * \param	row		Row of the imagesheet definition (for error information).
  */
-void Sprite::addImageSheet(const std::string& id, const std::string& src, void* node)
+void Sprite::addImageSheet(const std::string& id, const std::string& src, int row)
 {
 	Filesystem& fs = Utility<Filesystem>::get();
 
 	// Search for an image sheet with 'id'. If not found, add it.
-	if (mImageSheets.find(toLowercase(id)) == mImageSheets.end())
+	if (mDefinition->imageSheets.find(toLowercase(id)) == mDefinition->imageSheets.end())
 	{
 		string imagePath = fs.workingPath(mSpriteName);
 		imagePath += src;
 		if (!fs.exists(imagePath))
 		{
 			cout << "Couldn't find '" << imagePath << "' defined in sprite file '" << name() << "'." << endl;
-			mImageSheets[toLowercase(id)]; // Add a default image
+			mDefinition->imageSheets[toLowercase(id)]; // Add a default image
 		}
 		else
 		{
-			mImageSheets[id] = Image(imagePath);
+			mDefinition->imageSheets[id] = Image(imagePath);
 		}
 	}
 	else
 	{
-		cout << "Image-sheet redefinition '" << id << "'." << endTag(static_cast<XmlNode*>(node)->row(), name()) << ". Imagesheet ignored." << endl;
+		cout << "Image-sheet redefinition '" << id << "'." << endTag(row, name()) << ". Imagesheet ignored." << endl;
 	}
 }
 
@@ -438,14 +941,14 @@ void Sprite::processActions(void* root)
 	XmlNode* node = nullptr;
 	while ((node = element->iterateChildren(node)))
 	{
-		if (toLowercase(node->value()) == "action" && node->toElement())
+		if (node->valueView().equals("action", true) && node->toElement())
 		{
 
 			string action_name;
 			XmlAttribute* attribute = node->toElement()->firstAttribute();
 			while (attribute)
 			{
-				if (toLowercase(attribute->name()) == "name")
+				if (attribute->nameView().equals("name", true))
 				{
 					action_name = attribute->value();
 				}
@@ -459,7 +962,7 @@ void Sprite::processActions(void* root)
 				continue;
 			}
 
-			if (mActions.find(toLowercase(action_name)) == mActions.end())
+			if (mDefinition->actions.find(toLowercase(action_name)) == mDefinition->actions.end())
 			{
 				processFrames(action_name, node);
 			}
@@ -479,94 +982,136 @@ void Sprite::processFrames(const std::string& action, void* _node)
 {
 	XmlNode* node = static_cast<XmlNode*>(_node);
 
-	FrameList frameList;
+	std::vector<FrameDefinition> frames;
 
 	XmlNode* frame = nullptr;
 	while ((frame = node->iterateChildren(frame)))
 	{
 		int currentRow = frame->row();
 
-		if (frame->value() == "frame" && frame->toElement())
+		if (frame->valueView() == "frame" && frame->toElement())
 		{
-			string sheetId;
-			int delay = 0;
-			int x = 0, y = 0;
-			int width = 0, height = 0;
-			int anchorx = 0, anchory = 0;
+			FrameDefinition definition(currentRow);
 
 			XmlAttribute* attribute = frame->toElement()->firstAttribute();
 			while (attribute)
 			{
-				if (toLowercase(attribute->name()) == "sheetid") { sheetId = attribute->value(); }
-				else if (toLowercase(attribute->name()) == "delay") { attribute->queryIntValue(delay); }
-				else if (toLowercase(attribute->name()) == "x") { attribute->queryIntValue(x); }
-				else if (toLowercase(attribute->name()) == "y") { attribute->queryIntValue(y); }
-				else if (toLowercase(attribute->name()) == "width") { attribute->queryIntValue(width); }
-				else if (toLowercase(attribute->name()) == "height") { attribute->queryIntValue(height); }
-				else if (toLowercase(attribute->name()) == "anchorx") { attribute->queryIntValue(anchorx); }
-				else if (toLowercase(attribute->name()) == "anchory") { attribute->queryIntValue(anchory); }
-				else { std::cout << "Unexpected attribute '" << attribute->name() << "' found on row " << currentRow << std::endl; }
+				if (!frameAttribute(definition, attribute->nameView(), attribute->valueView()))
+				{
+					std::cout << "Unexpected attribute '" << attribute->nameView() << "' found on row " << currentRow << std::endl;
+				}
 
 				attribute = attribute->next();
 			}
 
-			if (!validateSheetId(sheetId, currentRow))
-			{
-				continue;
-			}
+			frames.push_back(definition);
+		}
+		else
+		{
+			cout << "Unexpected tag '<" << frame->valueView() << ">'." << endTag(currentRow, name()) << endl;
+		}
+	}
 
-			// X-Coordinate
-			if ( x < 0 || x > mImageSheets.find(sheetId)->second.width())
-			{
-				cout << "Value 'x' is out of bounds." << endTag(currentRow, name()) << endl;
-				continue;
-			}
+	addAction(action, frames);
+}
 
-			// Y-Coordinate
-			if (y < 0 || y > mImageSheets.find(sheetId)->second.height())
-			{
-				cout << "Value 'y' is out of bounds." << endTag(currentRow, name()) << endl;
-				continue;
-			}
 
-			// Width
-			if (width < 1)
-			{
-				width = 1;
-				cout << "'width' value must be greater than 0." << endTag(currentRow, name()) << endl;
-				continue;
-			}
-			else if (x + width > mImageSheets.find(sheetId)->second.width())
-			{
-				cout << "'x' + 'width' value exceeds dimensions of specified imagesheet." << endTag(currentRow, name()) << endl;
-				continue;
-			}
+/**
+ * Sets a value of a frame definition from an attribute of a <frame> tag.
+ *
+ * Takes XmlStrings so attributes of a parsed document can be read without
+ * copying them. Strings from an XmlReader convert implicitly.
+ *
+ * \return	False if the attribute isn't a frame attribute.
+ */
+bool Sprite::frameAttribute(FrameDefinition& frame, const XmlString& name, const XmlString& value)
+{
+	int* field = nullptr;
+	if (name.equals("sheetid", true)) { frame.sheetId.assign(value.data(), value.size()); return true; }
+	else if (name.equals("delay", true)) { field = &frame.delay; }
+	else if (name.equals("x", true)) { field = &frame.x; }
+	else if (name.equals("y", true)) { field = &frame.y; }
+	else if (name.equals("width", true)) { field = &frame.width; }
+	else if (name.equals("height", true)) { field = &frame.height; }
+	else if (name.equals("anchorx", true)) { field = &frame.anchorX; }
+	else if (name.equals("anchory", true)) { field = &frame.anchorY; }
+	else { return false; }
+
+	try
+	{
+		*field = std::stoi(std::string(value.data(), value.size()));
+	}
+	catch (const std::invalid_argument&)
+	{}
+
+	return true;
+}
 
-			// Height
-			if (height < 1)
-			{
-				height = 1;
-				cout << "'height' value must be greater than 0." << endTag(currentRow, name()) << endl;
-				continue;
-			}
-			else if (y + height > mImageSheets.find(sheetId)->second.height())
-			{
-				cout << "'y' + 'height' value exceeds dimensions of specified imagesheet." << endTag(currentRow, name()) << endl;
-				continue;
-			}
 
-			frameList.push_back(SpriteFrame(sheetId, x, y, width, height, anchorx, anchory, delay));
+/**
+ * Validates a list of frame definitions and adds the valid frames to the
+ * action container as an action.
+ */
+void Sprite::addAction(const std::string& action, const std::vector<FrameDefinition>& frames)
+{
+	FrameList frameList;
+
+	for (const auto& frame : frames)
+	{
+		int currentRow = frame.row;
+
+		if (!validateSheetId(frame.sheetId, currentRow))
+		{
+			continue;
 		}
-		else
+
+		Image& sheet = mDefinition->imageSheets.find(frame.sheetId)->second;
+
+		// X-Coordinate
+		if (frame.x < 0 || frame.x > sheet.width())
+		{
+			cout << "Value 'x' is out of bounds." << endTag(currentRow, name()) << endl;
+			continue;
+		}
+
+		// Y-Coordinate
+		if (frame.y < 0 || frame.y > sheet.height())
+		{
+			cout << "Value 'y' is out of bounds." << endTag(currentRow, name()) << endl;
+			continue;
+		}
+
+		// Width
+		if (frame.width < 1)
 		{
-			cout << "Unexpected tag '<" << frame->value() << ">'." << endTag(currentRow, name()) << endl;
+			cout << "'width' value must be greater than 0." << endTag(currentRow, name()) << endl;
+			continue;
 		}
+		else if (frame.x + frame.width > sheet.width())
+		{
+			cout << "'x' + 'width' value exceeds dimensions of specified imagesheet." << endTag(currentRow, name()) << endl;
+			continue;
+		}
+
+		// Height
+		if (frame.height < 1)
+		{
+			cout << "'height' value must be greater than 0." << endTag(currentRow, name()) << endl;
+			continue;
+		}
+		else if (frame.y + frame.height > sheet.height())
+		{
+			cout << "'y' + 'height' value exceeds dimensions of specified imagesheet." << endTag(currentRow, name()) << endl;
+			continue;
+		}
+
+		frameList.push_back(SpriteFrame(sheet, frame.x, frame.y, frame.width, frame.height, frame.anchorX, frame.anchorY, frame.delay));
 	}
 
 	// Add the frame list to the action container.
 	if (frameList.size() > 0)
 	{
-		mActions[toLowercase(action)] = frameList;
+		mDefinition->actions[toLowercase(action)] = frameList;
 	}
 	else
 	{
@@ -582,12 +1127,12 @@ bool Sprite::validateSheetId(const std::string& sheetId, int row)
 		cout << "Frame definition has a zero-length 'sheetid' value. Frame is being ignored." << endTag(row, name()) << endl;
 		return false;
 	}
-	else if (mImageSheets.find(sheetId) == mImageSheets.end())
+	else if (mDefinition->imageSheets.find(sheetId) == mDefinition->imageSheets.end())
 	{
 		cout << "Frame definition references an undefined imagesheet '" << sheetId << "'." << endTag(row, name()) << endl;
 		return false;
 	}
-	else if (!mImageSheets.find(sheetId)->second.loaded())
+	else if (!mDefinition->imageSheets.find(sheetId)->second.loaded())
 	{
 		cout << "Frame definition references an imagesheet that failed to load." << endTag(row, name()) << endl;
 		return false;
@@ -605,20 +1150,57 @@ bool Sprite::validateSheetId(const std::string& sheetId, int row)
  */
 void Sprite::addDefaultAction()
 {
-	if (mActions.find("default") == mActions.end())
+	if (mDefinition->actions.find("default") == mDefinition->actions.end())
 	{
-		mImageSheets["default"];	// Adds a default sheet. //-V607
+		Image& sheet = mDefinition->imageSheets["default"];	// Adds a default sheet.
 
-		int width = mImageSheets["default"].width();
-		int height = mImageSheets["default"].height();
+		int width = sheet.width();
+		int height = sheet.height();
 
 		FrameList frameList;
-		frameList.push_back(SpriteFrame("default", 0, 0, width, height, width / 2, height / 2, -1));
-		mActions["default"] = frameList;
+		frameList.push_back(SpriteFrame(sheet, 0, 0, width, height, width / 2, height / 2, -1));
+		mDefinition->actions["default"] = frameList;
 	}
 }
 
 
+/**
+ * Gets the frames of the current action.
+ */
+const Sprite::FrameList& Sprite::currentFrames() const
+{
+	return mDefinition->actions.at(mCurrentAction);
+}
+
+
+/**
+ * Finds the frames of an action in a sprite definition.
+ *
+ * \param	definition	Sprite definition to search.
+ * \param	action		Lowercase name of the action.
+ *
+ * \return	Pointer to the frames of the action or \c nullptr if the action isn't defined.
+ */
+const Sprite::FrameList* Sprite::findAction(const SpriteDefinition& definition, const std::string& action)
+{
+	ActionList::const_iterator it = definition.actions.find(action);
+	return it == definition.actions.end() ? nullptr : &it->second;
+}
+
+
+/**
+ * Gets the cache of loaded sprite definitions keyed by file path.
+ *
+ * Definitions are only held weakly and are freed along with the last Sprite
+ * that uses them.
+ */
+Sprite::DefinitionCache& Sprite::definitionCache()
+{
+	static DefinitionCache cache;
+	return cache;
+}
+
+
 /**
  * Gets the width of the Sprite.
  * 
@@ -628,7 +1210,7 @@ void Sprite::addDefaultAction()
  */
 int Sprite::width()
 {
-	return mActions[mCurrentAction][mCurrentFrame].width();
+	return currentFrames()[mCurrentFrame].width();
 }
 
 
@@ -641,7 +1223,7 @@ int Sprite::width()
  */
 int Sprite::height()
 {
-	return mActions[mCurrentAction][mCurrentFrame].height();
+	return currentFrames()[mCurrentFrame].height();
 }
 
 
@@ -654,7 +1236,7 @@ int Sprite::height()
  */
 int Sprite::originX(int x)
 {
-	return x - mActions[mCurrentAction][mCurrentFrame].anchorX();
+	return x - currentFrames()[mCurrentFrame].anchorX();
 }
 
 
@@ -667,7 +1249,7 @@ int Sprite::originX(int x)
  */
 int Sprite::originY(int y)
 {
-	return y - mActions[mCurrentAction][mCurrentFrame].anchorY();
+	return y - currentFrames()[mCurrentFrame].anchorY();
 }
 
 
@@ -679,7 +1261,7 @@ int Sprite::originY(int y)
 /**
  * Constructor
  *
- * \param	sId	Sprite sheet ID.
+ * \param	sheet	Sprite sheet. Must outlive the spriteFrame.
  * \param	x	X-Coordinte of the area to copy from the source Image object.
  * \param	y	Y-Coordinte of the area to copy from the source Image object.
  * \param	w	Width of the area to copy from the source Image object.
@@ -688,7 +1270,7 @@ int Sprite::originY(int y)
  * \param	aY	Y-Axis of the Anchor Point for this spriteFrame.
  * \param	d	Length of time milliseconds to display this spriteFrame during animation playback.
  */
-Sprite::SpriteFrame::SpriteFrame(const std::string& sId, int x, int y, int w, int h, int aX, int aY, int d):	mSheetId(sId),
+Sprite::SpriteFrame::SpriteFrame(Image& sheet, int x, int y, int w, int h, int aX, int aY, int d):	mSheet(&sheet),
 																												mFrameDelay(d),
 																												mAnchorX(aX),
 																												mAnchorY(aY),
@@ -699,7 +1281,7 @@ Sprite::SpriteFrame::SpriteFrame(const std::string& sId, int x, int y, int w, in
 /**
  * Copy C'tor
  */
-Sprite::SpriteFrame::SpriteFrame(const SpriteFrame &sf):	mSheetId(sf.mSheetId),
+Sprite::SpriteFrame::SpriteFrame(const SpriteFrame &sf):	mSheet(sf.mSheet),
 															mFrameDelay(sf.mFrameDelay),
 															mAnchorX(sf.mAnchorX),
 															mAnchorY(sf.mAnchorY),
@@ -712,7 +1294,7 @@ Sprite::SpriteFrame::SpriteFrame(const SpriteFrame &sf):	mSheetId(sf.mSheetId),
  */
 Sprite::SpriteFrame& Sprite::SpriteFrame::operator=(const SpriteFrame &rhs)
 {
-	mSheetId = rhs.mSheetId;
+	mSheet = rhs.mSheet;
 	mFrameDelay = rhs.mFrameDelay;
 	mAnchorX = rhs.mAnchorX;
 	mAnchorY = rhs.mAnchorY;
@@ -721,3 +1303,79 @@ Sprite::SpriteFrame& Sprite::SpriteFrame::operator=(const SpriteFrame &rhs)
 	return *this;
 }
 
+
+// ==================================================================================
+// = Unexposed module-level functions defined here that don't need to be part of the
+// = API interface.
+// ==================================================================================
+
+/**
+ * Computes a 64-bit FNV-1a hash of the contents of a file.
+ */
+uint64_t sourceHash(const File& file)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(file.raw_bytes());
+	for (size_t i = 0; i < file.size(); ++i)
+	{
+		hash ^= p[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+
+/**
+ * Appends a little endian 32-bit integer to a buffer.
+ */
+void writeInt(string& buffer, uint32_t value)
+{
+	char bytes[4] = { static_cast<char>(value & 0xFF), static_cast<char>((value >> 8) & 0xFF), static_cast<char>((value >> 16) & 0xFF), static_cast<char>((value >> 24) & 0xFF) };
+	buffer.append(bytes, 4);
+}
+
+
+/**
+ * Appends a length prefixed string to a buffer.
+ */
+void writeString(string& buffer, const string& value)
+{
+	writeInt(buffer, static_cast<uint32_t>(value.size()));
+	buffer += value;
+}
+
+
+/**
+ * Reads a little endian 32-bit integer and advances \c p past it.
+ *
+ * \return	False if there aren't enough bytes left.
+ */
+bool readInt(const char*& p, const char* end, uint32_t& value)
+{
+	if (end - p < 4) { return false; }
+
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(p);
+	value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+	p += 4;
+
+	return true;
+}
+
+
+/**
+ * Reads a length prefixed string and advances \c p past it.
+ *
+ * \return	False if there aren't enough bytes left.
+ */
+bool readString(const char*& p, const char* end, string& value)
+{
+	uint32_t size = 0;
+	if (!readInt(p, end, size) || static_cast<size_t>(end - p) < size) { return false; }
+
+	value.assign(p, size);
+	p += size;
+
+	return true;
+}
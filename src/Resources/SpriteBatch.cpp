@@ -0,0 +1,274 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright © 2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// =
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#include "NAS2D/Resources/SpriteBatch.h"
+
+#include "NAS2D/Renderer/Renderer.h"
+#include "NAS2D/Utility.h"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace NAS2D;
+
+
+/**
+ * C'tor
+ */
+SpriteBatch::SpriteBatch()
+{}
+
+
+/**
+ * D'tor
+ */
+SpriteBatch::~SpriteBatch()
+{}
+
+
+/**
+ * Adds a sprite instance to the SpriteBatch.
+ *
+ * \param	sprite	Sprite to take the definition, current action, frame, color,
+ *					rotation and paused state from.
+ * \param	x		X-Coordinate to draw the instance at.
+ * \param	y		Y-Coordinate to draw the instance at.
+ *
+ * \return	Index of the instance.
+ */
+size_t SpriteBatch::add(const Sprite& sprite, float x, float y)
+{
+	mDefinitions.push_back(sprite.mDefinition);
+	mFrames.push_back(&sprite.currentFrames());
+	mCurrentFrame.push_back(static_cast<unsigned int>(sprite.mCurrentFrame));
+	mAccumulator.push_back(0);
+	mPaused.push_back(sprite.mPaused);
+
+	mX.push_back(x);
+	mY.push_back(y);
+	mRotation.push_back(sprite.mRotationAngle);
+	mColor.push_back(sprite.mColor);
+
+	return mFrames.size() - 1;
+}
+
+
+/**
+ * Removes a sprite instance from the SpriteBatch.
+ *
+ * \note	The last instance is moved into the removed instance's place and
+ *			takes over its index.
+ */
+void SpriteBatch::remove(size_t index)
+{
+	size_t last = mFrames.size() - 1;
+	if (index != last)
+	{
+		mDefinitions[index] = mDefinitions[last];
+		mFrames[index] = mFrames[last];
+		mCurrentFrame[index] = mCurrentFrame[last];
+		mAccumulator[index] = mAccumulator[last];
+		mPaused[index] = mPaused[last];
+
+		mX[index] = mX[last];
+		mY[index] = mY[last];
+		mRotation[index] = mRotation[last];
+		mColor[index] = mColor[last];
+	}
+
+	mDefinitions.pop_back();
+	mFrames.pop_back();
+	mCurrentFrame.pop_back();
+	mAccumulator.pop_back();
+	mPaused.pop_back();
+
+	mX.pop_back();
+	mY.pop_back();
+	mRotation.pop_back();
+	mColor.pop_back();
+}
+
+
+/**
+ * Removes all sprite instances from the SpriteBatch.
+ */
+void SpriteBatch::clear()
+{
+	mDefinitions.clear();
+	mFrames.clear();
+	mCurrentFrame.clear();
+	mAccumulator.clear();
+	mPaused.clear();
+
+	mX.clear();
+	mY.clear();
+	mRotation.clear();
+	mColor.clear();
+}
+
+
+/**
+ * Gets the number of sprite instances in the SpriteBatch.
+ */
+size_t SpriteBatch::size() const
+{
+	return mFrames.size();
+}
+
+
+/**
+ * Plays an action animation on a sprite instance.
+ *
+ * \param	index	Index of the instance.
+ * \param	action	Name of the action. Actions are not case sensitive.
+ *
+ * \note	If the named action doesn't exist, a warning message will be written
+ *			to the log and the instance is left unchanged.
+ */
+void SpriteBatch::play(size_t index, const std::string& action)
+{
+	const Sprite::FrameList* frames = Sprite::findAction(*mDefinitions[index], toLowercase(action));
+	if (!frames)
+	{
+		std::cout << "Named action '" << action << "' is not defined for sprite instance " << index << "." << std::endl;
+		return;
+	}
+
+	mFrames[index] = frames;
+	mCurrentFrame[index] = 0;
+	mAccumulator[index] = 0;
+	mPaused[index] = false;
+}
+
+
+/**
+ * Pauses animation of a sprite instance.
+ */
+void SpriteBatch::pause(size_t index)
+{
+	mPaused[index] = true;
+}
+
+
+/**
+ * Resumes animation of a sprite instance.
+ */
+void SpriteBatch::resume(size_t index)
+{
+	mPaused[index] = false;
+}
+
+
+/**
+ * Sets the coordinates a sprite instance is drawn at.
+ */
+void SpriteBatch::position(size_t index, float x, float y)
+{
+	mX[index] = x;
+	mY[index] = y;
+}
+
+
+/**
+ * Sets the angle of rotation, in degrees, of a sprite instance.
+ */
+void SpriteBatch::rotation(size_t index, float angle)
+{
+	mRotation[index] = angle;
+}
+
+
+/**
+ * Sets the color of a sprite instance.
+ */
+void SpriteBatch::color(size_t index, const Color_4ub& color)
+{
+	mColor[index] = color;
+}
+
+
+/**
+ * Advances the animation of all sprite instances by the time that has passed
+ * since the last call.
+ */
+void SpriteBatch::update()
+{
+	update(mTimer.delta());
+}
+
+
+/**
+ * Advances the animation of all sprite instances.
+ *
+ * \param	delta	Time, in milliseconds, to advance by.
+ */
+void SpriteBatch::update(unsigned int delta)
+{
+	size_t count = mFrames.size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (mPaused[i])
+		{
+			continue;
+		}
+
+		const Sprite::FrameList& frames = *mFrames[i];
+		unsigned int frame = mCurrentFrame[i];
+		int delay = frames[frame].frameDelay();
+
+		// Frames with no delay are held until the action changes.
+		if (delay <= 0)
+		{
+			continue;
+		}
+
+		unsigned int accumulator = mAccumulator[i] + delta;
+		while (delay > 0 && accumulator >= static_cast<unsigned int>(delay))
+		{
+			accumulator -= delay;
+			if (++frame >= frames.size())
+			{
+				frame = 0;
+			}
+
+			delay = frames[frame].frameDelay();
+		}
+
+		mCurrentFrame[i] = frame;
+		mAccumulator[i] = accumulator;
+	}
+}
+
+
+/**
+ * Draws all sprite instances grouped by imagesheet.
+ */
+void SpriteBatch::draw()
+{
+	size_t count = mFrames.size();
+
+	mDrawOrder.resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Sprite::SpriteFrame& frame = (*mFrames[i])[mCurrentFrame[i]];
+		mDrawOrder[i] = DrawKey(frame.sheet().handle().index, static_cast<unsigned int>(i));
+	}
+
+	// Keys are unique so this keeps the order instances were added in within a sheet.
+	std::sort(mDrawOrder.begin(), mDrawOrder.end());
+
+	Renderer& renderer = Utility<Renderer>::get();
+	for (const DrawKey& key : mDrawOrder)
+	{
+		size_t i = key.second;
+		const Sprite::SpriteFrame& frame = (*mFrames[i])[mCurrentFrame[i]];
+
+		renderer.drawSubImageRotated(frame.sheet(), mX[i] - frame.anchorX(), mY[i] - frame.anchorY(), static_cast<float>(frame.x()), static_cast<float>(frame.y()), static_cast<float>(frame.width()), static_cast<float>(frame.height()), mRotation[i], mColor[i]);
+	}
+}
@@ -10,7 +10,9 @@
 
 #include "NAS2D/StateManager.h"
 #include "NAS2D/Mixer/Mixer.h"
+#include "NAS2D/Profiler.h"
 
+#include <cmath>
 #include <iostream>
 
 using namespace std;
@@ -73,6 +75,10 @@ void StateManager::setState(State* state)
 	mActiveState->initialize();
 
 	mActive = true;
+
+	// Time spent in the previous State isn't simulated by the new one.
+	mTimer.delta();
+	mStepAccumulator = 0.0;
 }
 
 
@@ -82,8 +88,15 @@ void StateManager::setState(State* state)
  */
 bool StateManager::update()
 {
+	NAS2D_PROFILE_ZONE("StateManager::update");
+
 	if (mActiveState)
 	{
+		if (mStepsPerSecond > 0)
+		{
+			fixedUpdate();
+		}
+
 		State* nextState = mActiveState->update();
 
 		if (!nextState)
@@ -106,6 +119,39 @@ bool StateManager::update()
 }
 
 
+/**
+ * Calls the active State's fixedUpdate() once for every fixed step that has
+ * passed since the last frame and sets its interpolation value.
+ *
+ * At most mMaxStepsPerFrame steps are run each frame. Time beyond that is
+ * dropped so that a long frame can't cause a growing backlog of updates.
+ */
+void StateManager::fixedUpdate()
+{
+	NAS2D_PROFILE_ZONE("StateManager::fixedUpdate");
+
+	double stepLength = 1000.0 / mStepsPerSecond;
+	float step = 1.0f / mStepsPerSecond;
+
+	mStepAccumulator += mTimer.preciseDelta();
+
+	unsigned int steps = 0;
+	while (mStepAccumulator >= stepLength && steps < mMaxStepsPerFrame)
+	{
+		mActiveState->fixedUpdate(step);
+		mStepAccumulator -= stepLength;
+		++steps;
+	}
+
+	if (mStepAccumulator >= stepLength)
+	{
+		mStepAccumulator = std::fmod(mStepAccumulator, stepLength);
+	}
+
+	mActiveState->mInterpolation = static_cast<float>(mStepAccumulator / stepLength);
+}
+
+
 /**
  * Called when a quit event is raised.
  * 
@@ -135,3 +181,38 @@ void StateManager::forceStopAudio(bool b)
 {
 	mForceStopAudio = b;
 }
+
+
+/**
+ * Sets whether the StateManager runs the active State at a fixed timestep.
+ *
+ * \param	stepsPerSecond		Number of times per second to call State::fixedUpdate().
+ *								0 turns fixed timestep updates off. Default is 0.
+ * \param	maxStepsPerFrame	Maximum number of times State::fixedUpdate() is called
+ *								in a single frame. When a frame takes longer than this
+ *								many steps the extra time is dropped and the simulation
+ *								falls behind real time instead of spiraling. Default is 5.
+ */
+void StateManager::fixedTimestep(unsigned int stepsPerSecond, unsigned int maxStepsPerFrame)
+{
+	mStepsPerSecond = stepsPerSecond;
+	mMaxStepsPerFrame = maxStepsPerFrame > 0 ? maxStepsPerFrame : 1;
+
+	mTimer.delta();
+	mStepAccumulator = 0.0;
+
+	if (mActiveState && mStepsPerSecond == 0)
+	{
+		mActiveState->mInterpolation = 1.0f;
+	}
+}
+
+
+/**
+ * Gets the number of fixed updates per second or 0 if the StateManager isn't
+ * running at a fixed timestep.
+ */
+unsigned int StateManager::fixedTimestep() const
+{
+	return mStepsPerSecond;
+}
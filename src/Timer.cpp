@@ -14,12 +14,20 @@
 
 using namespace NAS2D;
 
+
+// ==================================================================================
+// = UNEXPOSED FUNCTION PROTOTYPES
+// ==================================================================================
+double countsToMilliseconds(Uint64 counts);
+
+
 /**
  * C'tor
  */
-Timer::Timer():	mCurrentTick(0),
-				mLastTick(0),
-				mAccumulator(0)
+Timer::Timer():	mCurrentTick(SDL_GetPerformanceCounter()),
+				mLastTick(mCurrentTick),
+				mDeltaRemainder(0.0),
+				mAccumulator(0.0)
 {
 }
 
@@ -33,14 +41,18 @@ unsigned int Timer::tick() const
 
 
 /**
- * Gets the difference in time since the last call to delta().
+ * Gets the difference in time, in whole milliseconds, since the last call to
+ * delta().
+ *
+ * The fraction of a millisecond that isn't reported is added to the next call.
  */
 unsigned int Timer::delta()
 {
-	mLastTick = mCurrentTick;
-	mCurrentTick = SDL_GetTicks();
+	double elapsed = preciseDelta() + mDeltaRemainder;
+	unsigned int milliseconds = static_cast<unsigned int>(elapsed);
+	mDeltaRemainder = elapsed - milliseconds;
 
-	return mCurrentTick - mLastTick;
+	return milliseconds;
 }
 
 
@@ -51,9 +63,7 @@ unsigned int Timer::delta()
  */
 unsigned int Timer::accumulator()
 {
-	mAccumulator += delta();
-
-	return mAccumulator;
+	return static_cast<unsigned int>(preciseAccumulator());
 }
 
 
@@ -68,11 +78,66 @@ void Timer::adjust_accumulator(unsigned int a)
 }
 
 
+/**
+ * Gets the current tick in milliseconds with sub-millisecond precision.
+ *
+ * \note	Unlike tick(), the value isn't relative to when the application
+ *			started. Only differences between values are meaningful.
+ */
+double Timer::preciseTick() const
+{
+	return countsToMilliseconds(SDL_GetPerformanceCounter());
+}
+
+
+/**
+ * Gets the difference in time, in milliseconds, since the last call to
+ * delta() or preciseDelta().
+ */
+double Timer::preciseDelta()
+{
+	mLastTick = mCurrentTick;
+	mCurrentTick = SDL_GetPerformanceCounter();
+
+	return countsToMilliseconds(mCurrentTick - mLastTick);
+}
+
+
+/**
+ * Updates the Accumulator value.
+ *
+ * \return	Returns the accumulator value in milliseconds with sub-millisecond
+ *			precision.
+ */
+double Timer::preciseAccumulator()
+{
+	mAccumulator += preciseDelta();
+
+	return mAccumulator;
+}
+
+
 /**
  * Resets the accumulator and updates the tick counter.
  */
 void Timer::reset()
 {
-	delta();
-	mAccumulator = 0;
+	preciseDelta();
+	mDeltaRemainder = 0.0;
+	mAccumulator = 0.0;
+}
+
+
+// ==================================================================================
+// = Unexposed module-level functions defined here that don't need to be part of the
+// = API interface.
+// ==================================================================================
+
+/**
+ * Converts a performance counter value to milliseconds.
+ */
+double countsToMilliseconds(Uint64 counts)
+{
+	static const double COUNTS_PER_MILLISECOND = static_cast<double>(SDL_GetPerformanceFrequency()) / 1000.0;
+	return static_cast<double>(counts) / COUNTS_PER_MILLISECOND;
 }
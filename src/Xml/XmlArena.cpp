@@ -0,0 +1,126 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright  2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// = 
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#include "NAS2D/Xml/XmlArena.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace NAS2D::Xml;
+
+/**
+ * C'tor
+ *
+ * \param blockSize	Size, in bytes, of the blocks memory is allocated from.
+ */
+XmlArena::XmlArena(size_t blockSize) :	_cursor(nullptr),
+										_remaining(0),
+										_blockSize(blockSize),
+										_size(0),
+										_lastOwner(0)
+{}
+
+
+/**
+ * D'tor
+ *
+ * Frees all memory allocated by the arena.
+ */
+XmlArena::~XmlArena()
+{
+	for (auto& block : _blocks)
+	{
+		delete[] block.begin;
+	}
+}
+
+
+/**
+ * Allocates memory from the arena.
+ *
+ * \param size		Number of bytes to allocate.
+ * \param alignment	Alignment of the memory. Must be a power of two no larger
+ *					than \c alignof(std::max_align_t). Strings use 1.
+ *
+ * \return	Pointer to memory with the requested alignment.
+ */
+void* XmlArena::allocate(size_t size, size_t alignment)
+{
+	size_t padding = (0 - reinterpret_cast<size_t>(_cursor)) & (alignment - 1);
+
+	if (size + padding > _remaining)
+	{
+		// Oversized requests get a block of their own. New blocks are aligned for any type.
+		size_t blockSize = std::max(size, _blockSize);
+		Block block = { new char[blockSize], nullptr };
+		block.end = block.begin + blockSize;
+
+		_blocks.insert(std::upper_bound(_blocks.begin(), _blocks.end(), block, [](const Block& a, const Block& b) { return std::less<const char*>()(a.begin, b.begin); }), block);
+		_cursor = block.begin;
+		_remaining = blockSize;
+		_size += blockSize;
+		padding = 0;
+	}
+
+	void* p = _cursor + padding;
+	_cursor += size + padding;
+	_remaining -= size + padding;
+
+	return p;
+}
+
+
+/**
+ * Gets whether a pointer points into memory allocated from the arena.
+ */
+bool XmlArena::owns(const void* p) const
+{
+	const char* address = static_cast<const char*>(p);
+
+	// Nodes tend to be freed in the order they were allocated so the block that
+	// owned the last address is checked before searching.
+	if (_lastOwner < _blocks.size() && contains(_blocks[_lastOwner], address))
+	{
+		return true;
+	}
+
+	// First block that starts after the address. The one before it is the only candidate.
+	auto it = std::upper_bound(_blocks.begin(), _blocks.end(), address, [](const char* a, const Block& b) { return std::less<const char*>()(a, b.begin); });
+	if (it == _blocks.begin())
+	{
+		return false;
+	}
+
+	--it;
+	if (!contains(*it, address))
+	{
+		return false;
+	}
+
+	_lastOwner = it - _blocks.begin();
+	return true;
+}
+
+
+/**
+ * Gets whether an address falls within a block.
+ */
+bool XmlArena::contains(const Block& block, const char* address)
+{
+	return !std::less<const char*>()(address, block.begin) && std::less<const char*>()(address, block.end);
+}
+
+
+/**
+ * Gets the total number of bytes reserved by the arena.
+ */
+size_t XmlArena::size() const
+{
+	return _size;
+}
@@ -9,9 +9,11 @@
 // ==================================================================================
 // = Originally based on TinyXML. See Xml.h for additional details.
 // ==================================================================================
+#include <cstring>
 #include <stdexcept>
 
 #include "NAS2D/Xml/XmlAttribute.h"
+#include "NAS2D/Xml/XmlAttributeSet.h"
 
 using namespace std;
 using namespace NAS2D::Xml;
@@ -21,6 +23,7 @@ using namespace NAS2D::Xml;
  */
 XmlAttribute::XmlAttribute() :	XmlBase(),
 								_document(nullptr),
+								_set(nullptr),
 								_prev(nullptr),
 								_next(nullptr)
 {}
@@ -36,6 +39,7 @@ XmlAttribute::XmlAttribute() :	XmlBase(),
  */
 XmlAttribute::XmlAttribute(const std::string &name, std::string &value) :	XmlBase(),
 																			_document(nullptr),
+																			_set(nullptr),
 																			_name(name),
 																			_value(value),
 																			_prev(nullptr),
@@ -104,7 +108,7 @@ XmlAttribute* XmlAttribute::previous()
  */
 void XmlAttribute::write(std::string& buf, int) const
 {
-	if (_value.find('\"') == std::string::npos)
+	if (!memchr(_value.data(), '\"', _value.size()))
 	{
 		buf += _name;
 		buf += "=\"";
@@ -156,7 +160,7 @@ void XmlAttribute::doubleValue(double d)
  */
 int XmlAttribute::intValue() const
 {
-	return std::stoi(_value);
+	return std::stoi(std::string(_value.data(), _value.size()));
 }
 
 
@@ -173,7 +177,7 @@ int XmlAttribute::intValue() const
  */
 double XmlAttribute::doubleValue() const
 {
-	return std::stof(_value);
+	return std::stof(std::string(_value.data(), _value.size()));
 }
 
 
@@ -191,7 +195,7 @@ XmlAttribute::QueryResult XmlAttribute::queryIntValue(int& i) const
 {
 	try
 	{
-		i = std::stoi(_value);
+		i = std::stoi(std::string(_value.data(), _value.size()));
 	}
 	catch (std::invalid_argument)
 	{
@@ -216,7 +220,7 @@ XmlAttribute::QueryResult XmlAttribute::queryDoubleValue(double& d) const
 {
 	try
 	{
-		d = std::stod(_value);
+		d = std::stod(std::string(_value.data(), _value.size()));
 	}
 	catch (std::invalid_argument)
 	{
@@ -231,10 +235,14 @@ XmlAttribute::QueryResult XmlAttribute::queryDoubleValue(double& d) const
  * Gets the name of the Attribute.
  *
  * \return	Returns a \c std::string containing the name of the attribute.
+ *
+ * \note	Names of attributes parsed into an arena are copied into a
+ *			\c std::string the first time this is called. Use nameView()
+ *			to read them without a copy.
  */
 const std::string& XmlAttribute::name() const
 {
-	return _name;
+	return _name.str();
 }
 
 
@@ -243,9 +251,31 @@ const std::string& XmlAttribute::name() const
  *
  * \return	Returns a \c std::string containing the value of the attribute.
  *
+ * \note	Values of attributes parsed into an arena are copied into a
+ *			\c std::string the first time this is called. Use valueView()
+ *			to read them without a copy.
+ *
  * \see	XmlAttribute::intValue(), XmlAttribute::doubleValue()
  */
 const std::string& XmlAttribute::value() const
+{
+	return _value.str();
+}
+
+
+/**
+ * Gets the name of the Attribute without copying it into a \c std::string.
+ */
+const XmlString& XmlAttribute::nameView() const
+{
+	return _name;
+}
+
+
+/**
+ * Gets the value of the Attribute without copying it into a \c std::string.
+ */
+const XmlString& XmlAttribute::valueView() const
 {
 	return _value;
 }
@@ -258,6 +288,13 @@ const std::string& XmlAttribute::value() const
  */
 void XmlAttribute::name(const std::string& name)
 {
+	// The set indexes attributes by name.
+	if (_set)
+	{
+		_set->rename(this, name);
+		return;
+	}
+
 	_name = name;
 }
 
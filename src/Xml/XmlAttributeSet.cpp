@@ -11,8 +11,42 @@
 // ==================================================================================
 #include "NAS2D/Xml/XmlAttributeSet.h"
 
+#include <algorithm>
+
 using namespace NAS2D::Xml;
 
+/**
+ * Number of attributes a set can hold before lookups switch from a linear
+ * scan to a hash table.
+ */
+const size_t XML_ATTRIBUTE_TABLE_THRESHOLD = 16;
+
+
+/**
+ * Hashes an attribute name. Works on the characters directly so names that
+ * are views don't have to be copied into a std::string first.
+ */
+size_t hashAttributeName(const char* name, size_t length)
+{
+	// FNV-1a
+	size_t hash = 2166136261u;
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash = (hash ^ static_cast<unsigned char>(name[i])) * 16777619u;
+	}
+
+	return hash;
+}
+
+
+/**
+ * Hashes the name of an attribute.
+ */
+size_t hashAttributeName(const XmlString& name)
+{
+	return hashAttributeName(name.data(), name.size());
+}
+
 
 /**
  * Default c'tor.
@@ -41,6 +75,21 @@ void XmlAttributeSet::add(XmlAttribute* attribute)
 
 	sentinel._prev->_next = attribute;
 	sentinel._prev = attribute;
+
+	attribute->_set = this;
+	_index.push_back(attribute);
+
+	if (!_table.empty())
+	{
+		_table.insert(std::make_pair(hashAttributeName(attribute->_name), attribute));
+	}
+	else if (_index.size() > XML_ATTRIBUTE_TABLE_THRESHOLD)
+	{
+		for (auto indexed : _index)
+		{
+			_table.insert(std::make_pair(hashAttributeName(indexed->_name), indexed));
+		}
+	}
 }
 
 
@@ -55,6 +104,10 @@ void XmlAttributeSet::remove(XmlAttribute* attribute)
 	{
 		if (node == attribute)
 		{
+			tableRemove(attribute);
+			_index.erase(std::find(_index.begin(), _index.end(), attribute));
+			attribute->_set = nullptr;
+
 			node->_prev->_next = node->_next;
 			node->_next->_prev = node->_prev;
 			node->_next = nullptr;
@@ -66,15 +119,106 @@ void XmlAttributeSet::remove(XmlAttribute* attribute)
 }
 
 
+/**
+ * Removes and deletes every attribute in the set.
+ *
+ * \param arena	Arena of the document the attributes belong to, if any.
+ */
+void XmlAttributeSet::clear(XmlArena* arena)
+{
+	XmlAttribute* node = sentinel._next;
+	while (node != &sentinel)
+	{
+		XmlAttribute* next = node->_next;
+
+		node->_set = nullptr;
+		node->_next = nullptr;
+		node->_prev = nullptr;
+		XmlBase::destroy(node, arena);
+
+		node = next;
+	}
+
+	sentinel._next = &sentinel;
+	sentinel._prev = &sentinel;
+
+	_index.clear();
+	_table.clear();
+}
+
+
+/**
+ * Finds an attribute by name.
+ *
+ * Small sets are scanned linearly. Sets with more than XML_ATTRIBUTE_TABLE_THRESHOLD
+ * attributes are looked up by the hash of the name.
+ *
+ * \return	Pointer to the attribute or \c nullptr if the set doesn't contain it.
+ */
 XmlAttribute* XmlAttributeSet::find(const std::string& name) const
+{
+	return find(name.data(), name.size());
+}
+
+
+/**
+ * Finds an attribute by name.
+ *
+ * \return	Pointer to the attribute or \c nullptr if the set doesn't contain it.
+ */
+XmlAttribute* XmlAttributeSet::find(const XmlString& name) const
+{
+	return find(name.data(), name.size());
+}
+
+
+/**
+ * Finds an attribute by a name that's \c length characters long.
+ */
+XmlAttribute* XmlAttributeSet::find(const char* name, size_t length) const
+{
+	if (_table.empty())
+	{
+		for (auto attribute : _index)
+		{
+			if (attribute->_name.equalsRun(name, length))
+			{
+				return attribute;
+			}
+		}
+
+		return nullptr;
+	}
+
+	auto range = _table.equal_range(hashAttributeName(name, length));
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (it->second->_name.equalsRun(name, length))
+		{
+			return it->second;
+		}
+	}
+
+	return nullptr;
+}
+
+
+/**
+ * Finds an attribute by name ignoring case. "Case", "caSe", "CASE", etc.
+ * will all be viewed as identical.
+ *
+ * \return	Pointer to the first matching attribute or \c nullptr if the set doesn't contain it.
+ */
+XmlAttribute* XmlAttributeSet::findNoCase(const std::string& name) const
 {
 	for (XmlAttribute* node = sentinel._next; node != &sentinel; node = node->_next)
 	{
-		if (node->_name == name)
+		if (node->_name.equals(name, true))
 		{
 			return node;
 		}
 	}
+
 	return nullptr;
 }
 
@@ -91,3 +235,40 @@ XmlAttribute* XmlAttributeSet::findOrCreate(const std::string& _name)
 
 	return attrib;
 }
+
+
+/**
+ * Renames an attribute in the set and keeps the hash table up to date.
+ */
+void XmlAttributeSet::rename(XmlAttribute* attribute, const std::string& name)
+{
+	tableRemove(attribute);
+	attribute->_name = name;
+
+	if (!_table.empty())
+	{
+		_table.insert(std::make_pair(hashAttributeName(attribute->_name), attribute));
+	}
+}
+
+
+/**
+ * Removes an attribute from the hash table.
+ */
+void XmlAttributeSet::tableRemove(XmlAttribute* attribute)
+{
+	if (_table.empty())
+	{
+		return;
+	}
+
+	auto range = _table.equal_range(hashAttributeName(attribute->_name));
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (it->second == attribute)
+		{
+			_table.erase(it);
+			return;
+		}
+	}
+}
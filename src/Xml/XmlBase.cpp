@@ -10,6 +10,7 @@
 // = Originally based on TinyXML. See Xml.h for additional details.
 // ==================================================================================
 #include "NAS2D/Xml/Xml.h"
+#include "NAS2D/Xml/XmlArena.h"
 
 using namespace NAS2D::Xml;
 
@@ -39,6 +40,28 @@ void fillErrorTable()
 }
 
 
+/**
+ * Destroys a node or attribute.
+ *
+ * Objects the parser placed in an XmlArena only have their destructor run.
+ * Their memory is released with the arena. Anything else was allocated with
+ * \c new and is deleted.
+ *
+ * \param base		Object to destroy. May be \c nullptr.
+ * \param arena	Arena of the document the object belongs to or \c nullptr.
+ */
+void XmlBase::destroy(XmlBase* base, XmlArena* arena)
+{
+	if (arena && arena->owns(base))
+	{
+		base->~XmlBase();
+		return;
+	}
+
+	delete base;
+}
+
+
 /**
  * Get the row of the node in the document.
  *
@@ -63,7 +63,9 @@ void XmlComment::write(std::string& buf, int depth) const
 		buf += "\t";
 	}
 
-	buf += "<!--" + _value + "-->";
+	buf += "<!--";
+	buf += _value;
+	buf += "-->";
 }
 
 
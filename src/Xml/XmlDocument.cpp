@@ -10,6 +10,7 @@
 // = Originally based on TinyXML. See Xml.h for additional details.
 // ==================================================================================
 #include "NAS2D/Xml/XmlDocument.h"
+#include "NAS2D/Xml/XmlArena.h"
 
 using namespace NAS2D::Xml;
 
@@ -18,7 +19,9 @@ using namespace NAS2D::Xml;
  */
 XmlDocument::XmlDocument() :	XmlNode(XmlNode::XML_DOCUMENT),
 								_errorId(0),
-								_error(false)							
+								_error(false),
+								_arenaAllocation(false),
+								_arena(nullptr)
 {
 	clearError();
 }
@@ -31,7 +34,9 @@ XmlDocument::XmlDocument() :	XmlNode(XmlNode::XML_DOCUMENT),
  */
 XmlDocument::XmlDocument(const std::string& documentName) :	XmlNode(XmlNode::XML_DOCUMENT),
 															_errorId(0),
-															_error(false)
+															_error(false),
+															_arenaAllocation(false),
+															_arena(nullptr)
 {
 	_value = documentName;
 	clearError();
@@ -43,12 +48,25 @@ XmlDocument::XmlDocument(const std::string& documentName) :	XmlNode(XmlNode::XML
  * 
  * \param copy XmlDocument to copy.
  */
-XmlDocument::XmlDocument(const XmlDocument& copy) : XmlNode(XmlNode::XML_DOCUMENT)
+XmlDocument::XmlDocument(const XmlDocument& copy) :	XmlNode(XmlNode::XML_DOCUMENT),
+													_arenaAllocation(copy._arenaAllocation),
+													_arena(nullptr)
 {
 	copy.copyTo(this);
 }
 
 
+/**
+ * D'tor
+ */
+XmlDocument::~XmlDocument()
+{
+	// Nodes may live in the arena so they have to go first.
+	clear();
+	delete _arena;
+}
+
+
 /**
  * Copy assignment operator.
  * 
@@ -133,6 +151,33 @@ void XmlDocument::clearError()
 }
 
 
+/**
+ * Sets whether nodes, attributes and strings created by parse() are allocated
+ * from an arena owned by the document instead of the heap.
+ *
+ * Arena allocation replaces thousands of small allocations with a few large ones
+ * and frees everything at once when the document is destroyed. Disabled by default.
+ *
+ * \warning	Nodes allocated from the arena must not outlive the document. Don't
+ *			link them into another document; use insertEndChild() to copy them
+ *			instead.
+ */
+void XmlDocument::arenaAllocation(bool enabled)
+{
+	_arenaAllocation = enabled;
+}
+
+
+/**
+ * Gets whether parse() allocates nodes and attributes from an arena owned by
+ * the document.
+ */
+bool XmlDocument::arenaAllocation() const
+{
+	return _arenaAllocation;
+}
+
+
 /**
  * If an error occurs, Error will be set to true. Also,
  * 	- The ErrorId() will contain the integer identifier of the error (not generally useful)
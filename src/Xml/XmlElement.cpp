@@ -52,12 +52,7 @@ XmlElement::~XmlElement()
 void XmlElement::clearThis()
 {
 	clear();
-	while (attributeSet.first())
-	{
-		XmlAttribute* node = attributeSet.first();
-		attributeSet.remove(node);
-		delete node;
-	}
+	attributeSet.clear(arena());
 }
 
 
@@ -74,13 +69,28 @@ std::string XmlElement::attribute(const std::string& name) const
 	const XmlAttribute* node = attributeSet.find(name);
 	if (node)
 	{
-		return node->value();
+		return std::string(node->valueView().data(), node->valueView().size());
 	}
 
 	return "";
 }
 
 
+/**
+ * Finds an attribute matching 'name'.
+ *
+ * \param name			Name of the attribute to find.
+ * \param ignoreCase	Whether to ignore case when comparing names. Doesn't
+ *						allocate any strings.
+ *
+ * \returns Pointer to the attribute or nullptr if the attribute wasn't found.
+ */
+const XmlAttribute* XmlElement::findAttribute(const std::string& name, bool ignoreCase) const
+{
+	return ignoreCase ? attributeSet.findNoCase(name) : attributeSet.find(name);
+}
+
+
 /**
  * Sets a value to a named attribute.
  * 
@@ -149,7 +159,8 @@ void XmlElement::write(std::string& buf, int depth) const
 		buf += "\t";
 	}
 
-	buf += "<" + _value;
+	buf += "<";
+	buf += _value;
 
 	const XmlAttribute* attrib;
 	for (attrib = attributeSet.first(); attrib; attrib = attrib->next())
@@ -167,7 +178,9 @@ void XmlElement::write(std::string& buf, int depth) const
 	{
 		buf += ">";
 		_firstChild->write(buf, depth + 1);
-		buf += "</" + _value + ">";
+		buf += "</";
+		buf += _value;
+		buf += ">";
 	}
 	else
 	{
@@ -187,7 +200,9 @@ void XmlElement::write(std::string& buf, int depth) const
 			buf += "\t";
 		}
 
-		buf += "</" + _value + ">";
+		buf += "</";
+		buf += _value;
+		buf += ">";
 	}
 }
 
@@ -234,7 +249,7 @@ bool XmlElement::accept(void* visitor) const
  */
 XmlNode* XmlElement::clone() const
 {
-	XmlElement* clone = new XmlElement(value());
+	XmlElement* clone = new XmlElement("");
 	if (!clone)
 	{
 		return nullptr;
@@ -256,7 +271,7 @@ void XmlElement::removeAttribute(const std::string& name)
 	if (node)
 	{
 		attributeSet.remove(node);
-		delete node;
+		destroy(node, arena());
 	}
 }
 
@@ -11,6 +11,8 @@
 // ==================================================================================
 #include "NAS2D/Xml/XmlMemoryBuffer.h"
 
+#include "NAS2D/FileStream.h"
+
 #include "NAS2D/Xml/XmlAttribute.h"
 #include "NAS2D/Xml/XmlAttributeSet.h"
 #include "NAS2D/Xml/XmlComment.h"
@@ -22,30 +24,86 @@
 using namespace NAS2D::Xml;
 
 
-inline void indent(int depth, const std::string& indent, std::string& buffer)
+/**
+ * Estimates the number of bytes XmlMemoryBuffer will write for the children
+ * of a node. Entities aren't accounted for so the estimate may be a little low.
+ */
+size_t estimateSize(const XmlNode* node, int depth, size_t indent, size_t lineBreak)
 {
-	for (int i = 0; i < depth; ++i)
+	size_t size = 0;
+	for (const XmlNode* child = node->firstChild(); child; child = child->nextSibling())
 	{
-		buffer += indent;
+		// Indent, value, markup and line break.
+		size += depth * indent + child->valueView().size() + lineBreak + 12;
+
+		const XmlElement* element = child->toElement();
+		if (!element)
+		{
+			continue;
+		}
+
+		for (const XmlAttribute* attribute = element->firstAttribute(); attribute; attribute = attribute->next())
+		{
+			size += attribute->nameView().size() + attribute->valueView().size() + 4;
+		}
+
+		if (element->firstChild())
+		{
+			size += depth * indent + element->valueView().size() + lineBreak + 3;
+			size += estimateSize(element, depth + 1, indent, lineBreak);
+		}
 	}
+
+	return size;
 }
 
 
-inline void line_break(const std::string& linebreak, std::string& buffer)
+XmlMemoryBuffer::XmlMemoryBuffer() : depth(0), _indent("\t"), _lineBreak("\n"), _stream(nullptr), _chunkSize(0), _written(0), _error(false)
+{}
+
+
+/**
+ * C'tor
+ *
+ * \param stream		FileStream to write the document to. Must be opened with
+ *						Filesystem::openWriteStream() and outlive the XmlMemoryBuffer.
+ * \param chunkSize	Size, in bytes, the buffer can grow to before it's written
+ *						to the stream.
+ */
+XmlMemoryBuffer::XmlMemoryBuffer(FileStream& stream, size_t chunkSize) :	depth(0),
+																			_indent("\t"),
+																			_lineBreak("\n"),
+																			_stream(&stream),
+																			_chunkSize(chunkSize),
+																			_written(0),
+																			_error(false)
 {
-	buffer += linebreak;
+	_buffer.reserve(_chunkSize + _chunkSize / 4);
 }
 
 
-XmlMemoryBuffer::XmlMemoryBuffer() : depth(0), _indent("\t"), _lineBreak("\n")
-{}
+bool XmlMemoryBuffer::visitEnter(const XmlDocument& doc)
+{
+	if (!_stream)
+	{
+		reserve(_buffer.size() + estimateSize(&doc, 0, _indent.size(), _lineBreak.size()));
+	}
+
+	return true;
+}
+
+
+bool XmlMemoryBuffer::visitExit(const XmlDocument& doc)
+{
+	return flush();
+}
 
 
 bool XmlMemoryBuffer::visitEnter(const XmlElement& element, const XmlAttribute* firstAttribute)
 {
-	indent(depth, _indent, _buffer);
+	indent();
 	_buffer += "<";
-	_buffer += element.value();
+	_buffer += element.valueView();
 
 	for (const XmlAttribute* attrib = firstAttribute; attrib; attrib = attrib->next())
 	{
@@ -56,15 +114,15 @@ bool XmlMemoryBuffer::visitEnter(const XmlElement& element, const XmlAttribute*
 	if (!element.firstChild())
 	{
 		_buffer += " />";
-		line_break(_lineBreak, _buffer);
+		lineBreak();
 	}
 	else
 	{
 		_buffer += ">";
-		line_break(_lineBreak, _buffer);
+		lineBreak();
 	}
 	++depth;
-	return true;
+	return !_error;
 }
 
 
@@ -73,13 +131,13 @@ bool XmlMemoryBuffer::visitExit(const XmlElement& element)
 	--depth;
 	if (element.firstChild())
 	{
-		indent(depth, _indent, _buffer);
+		indent();
 		_buffer += "</";
-		_buffer += element.value();
+		_buffer += element.valueView();
 		_buffer += ">";
-		line_break(_lineBreak, _buffer);
+		lineBreak();
 	}
-	return true;
+	return !_error;
 }
 
 
@@ -87,52 +145,140 @@ bool XmlMemoryBuffer::visit(const XmlText& text)
 {
 	if (text.CDATA())
 	{
-		indent(depth, _indent, _buffer);
+		indent();
 		_buffer += "<![CDATA[";
-		_buffer += text.value();
+		_buffer += text.valueView();
 		_buffer += "]]>";
-		line_break(_lineBreak, _buffer);
+		lineBreak();
 	}
 	else
 	{
-		indent(depth, _indent, _buffer);
-		std::string str;
-		_buffer += text.value();
-		line_break(_lineBreak, _buffer);
+		indent();
+		_buffer += text.valueView();
+		lineBreak();
 	}
-	return true;
+	return !_error;
 }
 
 
 bool XmlMemoryBuffer::visit(const XmlComment& comment)
 {
-	indent(depth, _indent, _buffer);
+	indent();
 	_buffer += "<!--";
-	_buffer += comment.value();
+	_buffer += comment.valueView();
 	_buffer += "-->";
-	line_break(_lineBreak, _buffer);
-	return true;
+	lineBreak();
+	return !_error;
 }
 
 
 bool XmlMemoryBuffer::visit(const XmlUnknown& unknown)
 {
-	indent(depth, _indent, _buffer);
+	indent();
 	_buffer += "<";
-	_buffer += unknown.value();
+	_buffer += unknown.valueView();
 	_buffer += ">";
-	line_break(_lineBreak, _buffer);
-	return true;
+	lineBreak();
+	return !_error;
 }
 
 
+/**
+ * Gets the size of the document written so far, including anything already
+ * written to a stream.
+ */
 size_t XmlMemoryBuffer::size()
 {
-	return _buffer.size();
+	return _written + _buffer.size();
 }
 
 
+/**
+ * Gets the buffer.
+ *
+ * \note	When writing to a stream, only holds what hasn't been written to
+ *			the stream yet.
+ */
 const std::string& XmlMemoryBuffer::buffer()
 {
 	return _buffer;
 }
+
+
+/**
+ * Reserves memory for the buffer. Documents are reserved for automatically
+ * when they're visited so this is only needed when visiting single elements.
+ */
+void XmlMemoryBuffer::reserve(size_t size)
+{
+	_buffer.reserve(size);
+}
+
+
+/**
+ * Writes the buffer to the stream and empties it. Does nothing when not
+ * writing to a stream.
+ *
+ * \return	False if writing to the stream failed.
+ */
+bool XmlMemoryBuffer::flush()
+{
+	if (!_stream || _error || _buffer.empty())
+	{
+		return !_error;
+	}
+
+	if (_stream->write(_buffer.data(), _buffer.size()) != _buffer.size())
+	{
+		_error = true;
+		return false;
+	}
+
+	_written += _buffer.size();
+	_buffer.clear();
+
+	return true;
+}
+
+
+/**
+ * Gets whether writing to the stream failed.
+ */
+bool XmlMemoryBuffer::error() const
+{
+	return _error;
+}
+
+
+/**
+ * Writes the indent for the current depth.
+ */
+void XmlMemoryBuffer::indent()
+{
+	if (_indent.size() == 1)
+	{
+		_buffer.append(depth, _indent[0]);
+	}
+	else
+	{
+		for (int i = 0; i < depth; ++i)
+		{
+			_buffer += _indent;
+		}
+	}
+}
+
+
+/**
+ * Ends a line. Flushes the buffer to the stream once it has grown past the
+ * chunk size.
+ */
+void XmlMemoryBuffer::lineBreak()
+{
+	_buffer += _lineBreak;
+
+	if (_stream && _buffer.size() >= _chunkSize)
+	{
+		flush();
+	}
+}
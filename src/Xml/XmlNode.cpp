@@ -51,15 +51,7 @@ XmlNode::XmlNode(NodeType type) :	XmlBase(),
  */
 XmlNode::~XmlNode()
 {
-	XmlNode* node = _firstChild;
-	XmlNode* temp = nullptr;
-
-	while (node)
-	{
-		temp = node;
-		node = node->_next;
-		delete temp;
-	}
+	clear();
 }
 
 
@@ -69,7 +61,7 @@ XmlNode::~XmlNode()
  */
 void XmlNode::copyTo(XmlNode* target) const
 {
-	target->value(_value);
+	target->_value = _value;
 	target->location = location;
 }
 
@@ -103,13 +95,41 @@ void XmlNode::value(const std::string& value)
  * \li <b>Text:</b> the Text string.
  * 
  * \returns	The value of the node.
+ *
+ * \note	Values of nodes parsed into an arena are copied into a
+ *			\c std::string the first time this is called. Use valueView()
+ *			to read them without a copy.
  */
 const std::string& XmlNode::value() const
+{
+	return _value.str();
+}
+
+
+/**
+ * Gets the value of the node without copying it into a \c std::string.
+ *
+ * \see	XmlNode::value() for the meanings of 'value'.
+ */
+const XmlString& XmlNode::valueView() const
 {
 	return _value;
 }
 
 
+/**
+ * Gets the arena of the document the node belongs to.
+ *
+ * \returns	The arena or \c nullptr if the node isn't in a document or the
+ *			document doesn't have an arena.
+ */
+XmlArena* XmlNode::arena() const
+{
+	const XmlDocument* doc = document();
+	return doc ? doc->_arena : nullptr;
+}
+
+
 /**
  * Delete all the children of this node. Does not affect 'this'.
  */
@@ -117,12 +137,13 @@ void XmlNode::clear()
 {
 	XmlNode* node = _firstChild;
 	XmlNode* temp = nullptr;
+	XmlArena* memory = node ? arena() : nullptr;
 
 	while (node)
 	{
 		temp = node;
 		node = node->_next;
-		delete temp;
+		destroy(temp, memory);
 	}
 
 	_firstChild = nullptr;
@@ -302,7 +323,7 @@ XmlNode* XmlNode::replaceChild(XmlNode* replaceThis, const XmlNode& withThis)
 	if (replaceThis->_prev) { replaceThis->_prev->_next = node; }
 	else { _firstChild = node; }
 
-	delete replaceThis;
+	destroy(replaceThis, arena());
 	node->_parent = this;
 	return node;
 }
@@ -327,7 +348,7 @@ bool XmlNode::removeChild(XmlNode* node)
 	if (node->_prev) { node->_prev->_next = node->_next; }
 	else { _firstChild = node->_next; }
 
-	delete node;
+	destroy(node, arena());
 	return true;
 }
 
@@ -347,7 +368,7 @@ const XmlNode* XmlNode::firstChild(const std::string& value) const
 	const XmlNode* node = nullptr;
 	for (node = _firstChild; node; node = node->_next)
 	{
-		if (node->value() == value)
+		if (node->_value == value)
 		{
 			return node;
 		}
@@ -371,7 +392,7 @@ const XmlNode* XmlNode::lastChild(const std::string& value) const
 	const XmlNode* node = nullptr;
 	for (node = _lastChild; node; node = node->_prev)
 	{
-		if (node->value() == value)
+		if (node->_value == value)
 		{
 			return node;
 		}
@@ -505,7 +526,7 @@ const XmlNode* XmlNode::nextSibling(const std::string& value) const
 	const XmlNode* node = nullptr;
 	for (node = _next; node; node = node->_next)
 	{
-		if (node->value() == value)
+		if (node->_value == value)
 		{
 			return node;
 		}
@@ -531,7 +552,7 @@ const XmlNode* XmlNode::previousSibling(const std::string& value) const
 	const XmlNode* node = nullptr;
 	for (node = _prev; node; node = node->_prev)
 	{
-		if (node->value() == value)
+		if (node->_value == value)
 		{
 			return node;
 		}
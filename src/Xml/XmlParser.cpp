@@ -31,13 +31,17 @@
 // = 3. This notice may not be removed or altered from any source distribution.
 // ==================================================================================
 #include "NAS2D/Xml/Xml.h"
+#include "NAS2D/Xml/XmlArena.h"
+#include "NAS2D/Profiler.h"
 
 #include <assert.h>
 #include <stddef.h>
 #include <cctype>
 #include <fstream>
 #include <cstring>
+#include <new>
 #include <string>
+#include <utility>
 
 
 //#define DEBUG_PARSER
@@ -103,9 +107,11 @@ class XmlParsingData
 public:
 	void stamp(const char* now);
 	const std::pair<int, int>& cursor() const { return _cursor; }
+	XmlArena* arena() const { return _arena; }
+	bool inSitu() const { return _inSitu; }
 
 private:
-	XmlParsingData(const char* start, int row, int col) : _stamp(start), _cursor(row, col)
+	XmlParsingData(const char* start, int row, int col, XmlArena* arena, bool inSitu) : _stamp(start), _cursor(row, col), _arena(arena), _inSitu(inSitu)
 	{
 		assert(start);
 	}
@@ -113,9 +119,139 @@ private:
 private:
 	const char*			_stamp;
 	std::pair<int, int>	_cursor;
+	XmlArena*			_arena;		/**< Arena to allocate parsed nodes from or \c nullptr to use the heap. */
+	bool				_inSitu;	/**< Strings may refer to the source buffer, which outlives the document's nodes. */
 };
 
 
+/**
+ * Gets the arena nodes should be allocated from while parsing.
+ *
+ * \param data	Pointer to the XmlParsingData passed to parse() functions. May be \c nullptr.
+ */
+XmlArena* parsingArena(void* data)
+{
+	return data ? static_cast<XmlParsingData*>(data)->arena() : nullptr;
+}
+
+
+/**
+ * Creates a node or attribute while parsing. Documents parsed with an arena
+ * get it placed in the arena, otherwise it's allocated with \c new.
+ *
+ * \param data	Pointer to the XmlParsingData passed to parse() functions. May be \c nullptr.
+ * \param args	Arguments for the constructor.
+ */
+template <typename T, typename... Args>
+T* create(void* data, Args&&... args)
+{
+	XmlArena* arena = parsingArena(data);
+	if (arena)
+	{
+		return new (arena->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	return new T(std::forward<Args>(args)...);
+}
+
+
+/**
+ * Copies characters into an XmlString. With an arena the copy goes in the
+ * arena, otherwise the XmlString gets a \c std::string of its own.
+ *
+ * \note	Strings short enough to fit in the small string buffer of a
+ *			\c std::string are never put in the arena. They don't touch the
+ *			heap either way and the copy would only waste arena space.
+ *
+ * \param arena	Arena of the document being parsed. May be \c nullptr.
+ */
+void copyString(XmlString& string, const char* begin, size_t length, XmlArena* arena)
+{
+	static const size_t SMALL_STRING_CAPACITY = std::string().capacity();
+
+	if (!arena || length <= SMALL_STRING_CAPACITY)
+	{
+		string.assign(begin, length);
+		return;
+	}
+
+	char* copy = static_cast<char*>(arena->allocate(length, 1));
+	memcpy(copy, begin, length);
+	string.view(copy, length);
+}
+
+
+/**
+ * Stores characters read from the source buffer in an XmlString. Documents
+ * parsed in situ refer to the characters where they are, others get a copy.
+ *
+ * \param string	XmlString to store the characters in.
+ * \param begin	First character to store.
+ * \param length	Number of characters to store.
+ * \param data		Pointer to the XmlParsingData passed to parse() functions. May be \c nullptr.
+ *
+ * \see copyString()
+ */
+void storeString(XmlString& string, const char* begin, size_t length, void* data)
+{
+	if (data && static_cast<XmlParsingData*>(data)->inSitu())
+	{
+		string.view(begin, length);
+		return;
+	}
+
+	copyString(string, begin, length, parsingArena(data));
+}
+
+
+/**
+ * Stores text that had to be decoded in an XmlString. Decoded text isn't in
+ * the source buffer so it's copied even when parsing in situ.
+ *
+ * \see copyString()
+ */
+void storeString(XmlString& string, std::string&& text, void* data)
+{
+	XmlArena* arena = parsingArena(data);
+	if (!arena)
+	{
+		string.assign(std::move(text));
+		return;
+	}
+
+	copyString(string, text.data(), text.size(), arena);
+}
+
+
+/**
+ * Finds the next occurrence of an end tag.
+ *
+ * \param p				Where to start looking.
+ * \param endTag		Tag to look for. Must not be empty.
+ * \param ignoreCase	Whether to ignore case in the end tag.
+ *
+ * \return	Pointer to the start of the end tag or to the terminating null
+ *			character if the end tag wasn't found.
+ */
+const char* XmlBase::findEndTag(const char* p, const char* endTag, bool ignoreCase)
+{
+	assert(p);
+	assert(endTag && *endTag);
+
+	const int first = ignoreCase ? tolower(static_cast<unsigned char>(*endTag)) : *endTag;
+	for (; *p; ++p)
+	{
+		const int c = ignoreCase ? tolower(static_cast<unsigned char>(*p)) : *p;
+		if (c == first && stringEqual(p, endTag, ignoreCase))
+		{
+			break;
+		}
+	}
+
+	return p;
+}
+
+
 void XmlParsingData::stamp(const char* now)
 {
 	assert(now);
@@ -243,15 +379,11 @@ bool XmlBase::streamTo(std::istream& in, int character, std::string& tag)
 
 
 /**
- * Reads an XML name into the string provided. Returns a pointer just past
- * the last character of the name, or null if the function encounters an error.
+ * Finds the end of an XML name. Returns a pointer just past the last character
+ * of the name, or null if \c p isn't at the start of a name.
  */
-const char* XmlBase::readName(const char* p, std::string& name)
+const char* XmlBase::skipName(const char* p)
 {
-	// One of TinyXML's more performance demanding functions. Try to keep the memory overhead down. The
-	// "assign" optimization removes over 10% of the execution time. <-- I want to evaluate that statement.
-
-	name.clear();
 	assert(p);
 
 	// Names start with letters or underscores. Of course, in unicode,
@@ -262,7 +394,6 @@ const char* XmlBase::readName(const char* p, std::string& name)
 	// tell namespaces from names.)
 	if (p && *p && (isAlpha((unsigned char)*p) || *p == '_'))
 	{
-		const char* start = p;
 		while (p && *p && (isAlphaNum((unsigned char)*p)
 			|| *p == '_'
 			|| *p == '-'
@@ -272,11 +403,6 @@ const char* XmlBase::readName(const char* p, std::string& name)
 			++p;
 		}
 
-		if (p - start > 0)
-		{
-			name.assign(start, p - start);
-		}
-
 		return p;
 	}
 
@@ -284,6 +410,48 @@ const char* XmlBase::readName(const char* p, std::string& name)
 }
 
 
+/**
+ * Reads an XML name into the string provided. Returns a pointer just past
+ * the last character of the name, or null if the function encounters an error.
+ */
+const char* XmlBase::readName(const char* p, std::string& name)
+{
+	name.clear();
+
+	const char* end = skipName(p);
+	if (end)
+	{
+		name.assign(p, end - p);
+	}
+
+	return end;
+}
+
+
+/**
+ * Reads an XML name into an XmlString.
+ *
+ * \param p		Start of the name.
+ * \param name	XmlString to store the name in.
+ * \param data	XmlParsingData used to find the arena to store the name in. May be \c nullptr.
+ *
+ * \return	Pointer just past the last character of the name, or null if the
+ *			function encounters an error.
+ */
+const char* XmlBase::readName(const char* p, XmlString& name, void* data)
+{
+	name.clear();
+
+	const char* end = skipName(p);
+	if (end)
+	{
+		storeString(name, p, end - p, data);
+	}
+
+	return end;
+}
+
+
 /**
  * If an entity has been found, transform it into a character.
  */
@@ -471,16 +639,33 @@ bool XmlBase::stringEqual(const char* p, const char* tag, bool ignoreCase)
  */
 const char* XmlBase::readText(const char* p, std::string* text, bool trimWhiteSpace, const char* endTag, bool caseInsensitive)
 {
-	*text = ""; // certain tags always keep whitespace
+	// Text is copied straight out of the source buffer a run at a time instead of
+	// character by character. Entities are only decoded where a run hits an '&'.
+	text->clear(); // certain tags always keep whitespace
+
 	if (!trimWhiteSpace	|| !condenseWhiteSpace)	// if true, whitespace is always kept
 	{
 		// Keep all the white space.
-		while (p && *p && !stringEqual(p, endTag, caseInsensitive))
+		const char* end = p ? findEndTag(p, endTag, caseInsensitive) : nullptr;
+		while (p && p < end)
 		{
+			const char* entityStart = static_cast<const char*>(memchr(p, '&', end - p));
+			if (!entityStart)
+			{
+				text->append(p, end - p);
+				p = end;
+				break;
+			}
+
+			text->append(p, entityStart - p);
+
 			int len;
-			char cArr[4] = { 0, 0, 0, 0 };
-			p = getChar(p, cArr, &len);
-			text->append(cArr, len);
+			char value = 0;
+			p = getEntity(entityStart, &value, &len);
+			text->append(&value, len);
+
+			// Malformed entities can run past the end tag.
+			if (p && p > end) { end = findEndTag(p, endTag, caseInsensitive); }
 		}
 	}
 	else
@@ -489,38 +674,41 @@ const char* XmlBase::readText(const char* p, std::string* text, bool trimWhiteSp
 
 		// Remove leading white space:
 		p = skipWhiteSpace(p);
-		while (p && *p && !stringEqual(p, endTag, caseInsensitive))
+		const char* end = p ? findEndTag(p, endTag, caseInsensitive) : nullptr;
+		while (p && p < end)
 		{
-			if (*p == '\r' || *p == '\n')
+			if (white_space(*p))
 			{
 				whitespace = true;
 				++p;
+				continue;
 			}
-			else if (white_space(*p))
+
+			// If we've found whitespace, add it before the
+			// new character. Any whitespace just becomes a space.
+			if (whitespace)
+			{
+				(*text) += ' ';
+				whitespace = false;
+			}
+
+			const char* run = p;
+			while (p < end && *p != '&' && !white_space(*p))
 			{
-				whitespace = true;
 				++p;
 			}
-			else
+
+			text->append(run, p - run);
+
+			if (p < end && *p == '&')
 			{
-				// If we've found whitespace, add it before the
-				// new character. Any whitespace just becomes a space.
-				if (whitespace)
-				{
-					(*text) += ' ';
-					whitespace = false;
-				}
 				int len;
-				char cArr[4] = { 0, 0, 0, 0 };
-				p = getChar(p, cArr, &len);
-				if (len == 1)
-				{
-					(*text) += cArr[0];	// more efficient
-				}
-				else
-				{
-					text->append(cArr, len);
-				}
+				char value = 0;
+				p = getEntity(p, &value, &len);
+				text->append(&value, len);
+
+				// Malformed entities can run past the end tag.
+				if (p && p > end) { end = findEndTag(p, endTag, caseInsensitive); }
 			}
 		}
 	}
@@ -534,6 +722,63 @@ const char* XmlBase::readText(const char* p, std::string* text, bool trimWhiteSp
 }
 
 
+/**
+ * Reads text into an XmlString. Works like readText() but text that can be
+ * used exactly as it appears in the source buffer, which is most of it, is
+ * stored without being built up a run at a time. Only text that contains
+ * entities or white space to condense is decoded.
+ *
+ * \param data	XmlParsingData used to find the arena to store the text in. May be \c nullptr.
+ */
+const char* XmlBase::readText(const char* p, XmlString& text, bool trimWhiteSpace, const char* endTag, bool caseInsensitive, void* data)
+{
+	const bool condense = trimWhiteSpace && condenseWhiteSpace;
+
+	const char* start = condense ? skipWhiteSpace(p) : p;
+
+	// Look for the end tag and for anything that has to be decoded in one pass.
+	const int first = caseInsensitive ? tolower(static_cast<unsigned char>(*endTag)) : *endTag;
+	bool verbatim = start != nullptr;
+	const char* end = start;
+	for (; verbatim && *end; ++end)
+	{
+		const int c = caseInsensitive ? tolower(static_cast<unsigned char>(*end)) : *end;
+		if (c == first && stringEqual(end, endTag, caseInsensitive))
+		{
+			break;
+		}
+
+		// Condensed text keeps single spaces between words and nothing else.
+		if (*end == '&' || (condense && white_space(*end) && (*end != ' ' || end == start || white_space(*(end - 1)))))
+		{
+			verbatim = false;
+		}
+	}
+
+	if (verbatim && condense && end != start && white_space(*(end - 1)))
+	{
+		verbatim = false;
+	}
+
+	if (!verbatim)
+	{
+		std::string decoded;
+		p = readText(p, &decoded, trimWhiteSpace, endTag, caseInsensitive);
+		storeString(text, std::move(decoded), data);
+		return p;
+	}
+
+	storeString(text, start, end - start, data);
+
+	if (*end)
+	{
+		end += strlen(endTag);
+	}
+
+	return *end ? end : nullptr;
+}
+
+
 void XmlDocument::streamIn(std::istream& in, std::string& tag)
 {
 	// The basic issue with a document is that we don't know what we're
@@ -594,6 +839,53 @@ void XmlDocument::streamIn(std::istream& in, std::string& tag)
 
 const char* XmlDocument::parse(const char* p, void* prevData)
 {
+	return parse(p, prevData, false);
+}
+
+
+/**
+ * Parses a File in situ.
+ *
+ * Names, values and text that appear in the File exactly as they are stored
+ * are not copied. They refer to the bytes of the File, which the document
+ * keeps alive until it's destroyed or parses another File. Only strings that
+ * contain entities or white space that has to be condensed are decoded into
+ * storage of their own.
+ *
+ * Clears the document before parsing.
+ *
+ * \param file	File to parse. Copying a File shares its bytes so this doesn't
+ *				copy the file's contents.
+ *
+ * 
+eturn	Pointer just past the last character parsed or \c nullptr if the
+ *			File couldn't be parsed.
+ *
+ * 
+ote	XmlNode::value(), XmlAttribute::name() and XmlAttribute::value()
+ *			copy the characters the first time they're called. Use
+ *			XmlNode::valueView(), XmlAttribute::nameView() and
+ *			XmlAttribute::valueView() to read them where they are.
+ */
+const char* XmlDocument::parse(const File& file)
+{
+	clear();
+	_source = file;
+
+	return parse(_source.raw_bytes(), nullptr, true);
+}
+
+
+/**
+ * Parses a document.
+ *
+ * \param inSitu	Let strings refer to the source buffer instead of copying
+ *					them. Only for buffers held in _source.
+ */
+const char* XmlDocument::parse(const char* p, void* prevData, bool inSitu)
+{
+	NAS2D_PROFILE_ZONE("XmlDocument::parse");
+
 	clearError();
 
 	// Parse away, at the document level. Since a document contains nothing but
@@ -617,7 +909,12 @@ const char* XmlDocument::parse(const char* p, void* prevData)
 		location.second = 0;
 	}
 
-	XmlParsingData data(p, location.first, location.second);
+	if (_arenaAllocation && !_arena)
+	{
+		_arena = new XmlArena();
+	}
+
+	XmlParsingData data(p, location.first, location.second, _arenaAllocation ? _arena : nullptr, inSitu);
 	location = data.cursor();
 
 	p = skipWhiteSpace(p);
@@ -629,7 +926,7 @@ const char* XmlDocument::parse(const char* p, void* prevData)
 
 	while (p && *p)
 	{
-		XmlNode* node = identify(p);
+		XmlNode* node = identify(p, &data);
 		if (node)
 		{
 			p = node->parse(p, &data);
@@ -685,8 +982,11 @@ void XmlDocument::error(XmlErrorCode err, const char* pError, void* data)
 
 /**
  * Figure out what is at *p, and parse it. Returns null if it is not an xml node.
+ *
+ * \param p		Input to identify.
+ * \param data	XmlParsingData used to find the arena to allocate from. May be \c nullptr.
  */
-XmlNode* XmlNode::identify(const char* p)
+XmlNode* XmlNode::identify(const char* p, void* data)
 {
 	XmlNode* returnNode = 0;
 
@@ -718,14 +1018,14 @@ XmlNode* XmlNode::identify(const char* p)
 		#ifdef DEBUG_PARSER
 		TIXML_LOG("XML parsing Comment\n");
 		#endif
-		returnNode = new XmlComment();
+		returnNode = create<XmlComment>(data);
 	}
 	else if (stringEqual(p, cdataHeader, false))
 	{
 		#ifdef DEBUG_PARSER
 		TIXML_LOG("XML parsing CDATA\n");
 		#endif
-		XmlText* text = new XmlText("");
+		XmlText* text = create<XmlText>(data, "");
 		text->CDATA(true);
 		returnNode = text;
 	}
@@ -734,21 +1034,21 @@ XmlNode* XmlNode::identify(const char* p)
 		#ifdef DEBUG_PARSER
 		TIXML_LOG("XML parsing Unknown(1)\n");
 		#endif
-		returnNode = new XmlUnknown();
+		returnNode = create<XmlUnknown>(data);
 	}
 	else if (isAlpha(*(p + 1)) || *(p + 1) == '_')
 	{
 		#ifdef DEBUG_PARSER
 		TIXML_LOG("XML parsing Element\n");
 		#endif
-		returnNode = new XmlElement("");
+		returnNode = create<XmlElement>(data, "");
 	}
 	else
 	{
 		#ifdef DEBUG_PARSER
 		TIXML_LOG("XML parsing Unknown(2)\n");
 		#endif
-		returnNode = new XmlUnknown();
+		returnNode = create<XmlUnknown>(data);
 	}
 
 	if (returnNode)
@@ -944,7 +1244,7 @@ const char* XmlElement::parse(const char* p, void* data)
 	// Read the name.
 	const char* pErr = p;
 
-	p = readName(p, _value);
+	p = readName(p, _value, data);
 	if (!p || !*p)
 	{
 		if (doc) { doc->error(XML_ERROR_FAILED_TO_READ_ELEMENT_NAME, pErr, data); }
@@ -1016,7 +1316,7 @@ const char* XmlElement::parse(const char* p, void* data)
 		else
 		{
 			// Try to read an attribute:
-			XmlAttribute* attrib = new XmlAttribute();
+			XmlAttribute* attrib = create<XmlAttribute>(data);
 			if (!attrib)
 			{
 				return nullptr;
@@ -1029,17 +1329,17 @@ const char* XmlElement::parse(const char* p, void* data)
 			if (!p || !*p)
 			{
 				if (doc) doc->error(XML_ERROR_PARSING_ELEMENT, pErr, data);
-				delete attrib;
+				destroy(attrib, parsingArena(data));
 				return nullptr;
 			}
 
 			// Handle the strange case of double attributes:
-			XmlAttribute* node = attributeSet.find(attrib->name());
+			XmlAttribute* node = attributeSet.find(attrib->nameView());
 
 			if (node)
 			{
 				if (doc) { doc->error(XML_ERROR_PARSING_ELEMENT, pErr, data); }
-				delete attrib;
+				destroy(attrib, parsingArena(data));
 				return nullptr;
 			}
 
@@ -1064,7 +1364,7 @@ const char* XmlElement::readValue(const char* p, void* data)
 		if (*p != '<')
 		{
 			// Take what we have, make a text element.
-			XmlText* textNode = new XmlText("");
+			XmlText* textNode = create<XmlText>(data, "");
 
 			if (!textNode)
 			{
@@ -1088,7 +1388,7 @@ const char* XmlElement::readValue(const char* p, void* data)
 			}
 			else
 			{
-				delete textNode;
+				destroy(textNode, parsingArena(data));
 			}
 		}
 		else
@@ -1102,7 +1402,7 @@ const char* XmlElement::readValue(const char* p, void* data)
 			}
 			else
 			{
-				XmlNode* node = identify(p);
+				XmlNode* node = identify(p, data);
 				if (node)
 				{
 					p = node->parse(p, data);
@@ -1165,14 +1465,15 @@ const char* XmlUnknown::parse(const char* p, void* data)
 	}
 
 	++p;
-	_value = "";
 
+	const char* start = p;
 	while (p && *p && *p != '>')
 	{
-		_value += *p;
 		++p;
 	}
 
+	storeString(_value, start, p - start, data);
+
 	if (!p)
 	{
 		if (doc) { doc->error(XML_ERROR_PARSING_UNKNOWN, 0, 0); }
@@ -1218,7 +1519,7 @@ void XmlComment::streamIn(std::istream& in, std::string& tag)
 const char* XmlComment::parse(const char* p, void* data)
 {
 	XmlDocument* doc = document();
-	_value = "";
+	_value.clear();
 
 	p = skipWhiteSpace(p);
 
@@ -1238,13 +1539,10 @@ const char* XmlComment::parse(const char* p, void* data)
 
 	p += strlen(startTag);
 
-	_value = "";
 	// Keep all the white space.
-	while (p && *p && !stringEqual(p, endTag, false))
-	{
-		_value.append(p, 1);
-		++p;
-	}
+	const char* end = findEndTag(p, endTag, false);
+	storeString(_value, p, end - p, data);
+	p = end;
 
 	if (p && *p)
 	{
@@ -1267,7 +1565,7 @@ const char* XmlAttribute::parse(const char* p, void* data)
 	}
 	// Read the name, the '=' and the value.
 	const char* pErr = p;
-	p = readName(p, _name);
+	p = readName(p, _name, data);
 	if (!p || !*p)
 	{
 		if (_document) _document->error(XML_ERROR_READING_ATTRIBUTES, pErr, data);
@@ -1296,19 +1594,19 @@ const char* XmlAttribute::parse(const char* p, void* data)
 	{
 		++p;
 		end = "\'";		// single quote in string
-		p = readText(p, &_value, false, end, false);
+		p = readText(p, _value, false, end, false, data);
 	}
 	else if (*p == DOUBLE_QUOTE)
 	{
 		++p;
 		end = "\"";		// double quote in string
-		p = readText(p, &_value, false, end, false);
+		p = readText(p, _value, false, end, false, data);
 	}
 	else
 	{
 		// All attribute values should be in single or double quotes. But this is such a common error
 		// that the parser will try its best, even without them.
-		_value = "";
+		const char* start = p;
 		while ((p && *p) && !white_space(*p) && *p != '/' && *p != '>') // existance, whitespace, tag end
 		{
 			if (*p == SINGLE_QUOTE || *p == DOUBLE_QUOTE)
@@ -1320,9 +1618,10 @@ const char* XmlAttribute::parse(const char* p, void* data)
 				return nullptr;
 			}
 
-			_value += *p;
 			++p;
 		}
+
+		storeString(_value, start, p - start, data);
 	}
 
 	return p;
@@ -1363,7 +1662,7 @@ void XmlText::streamIn(std::istream& in, std::string& tag)
 
 const char* XmlText::parse(const char* p, void* data)
 {
-	_value = "";
+	_value.clear();
 	XmlDocument* doc = document();
 
 	if (data)
@@ -1388,11 +1687,9 @@ const char* XmlText::parse(const char* p, void* data)
 		p += strlen(startTag);
 
 		// Keep all the white space, ignore the encoding, etc.
-		while (p && *p && !stringEqual(p, endTag, false))
-		{
-			_value += *p;
-			++p;
-		}
+		const char* end = findEndTag(p, endTag, false);
+		storeString(_value, p, end - p, data);
+		p = end;
 
 		std::string dummy;
 		p = readText(p, &dummy, false, endTag, false);
@@ -1403,7 +1700,7 @@ const char* XmlText::parse(const char* p, void* data)
 		bool ignoreWhite = true;
 
 		const char* end = "<";
-		p = readText(p, &_value, ignoreWhite, end, false);
+		p = readText(p, _value, ignoreWhite, end, false, data);
 		if (p && *p)
 		{
 			// don't truncate the '<'
@@ -0,0 +1,723 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright  2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// =
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#include "NAS2D/Xml/XmlReader.h"
+
+#include "NAS2D/FileStream.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+using namespace NAS2D;
+using namespace NAS2D::Xml;
+
+extern std::vector<std::string> XML_ERROR_TABLE;
+extern void fillErrorTable();
+
+const std::string XML_READER_EMPTY_STRING;
+
+
+/**
+ * C'tor
+ *
+ * \param buffer	Null terminated buffer holding an XML document. The buffer
+ *					must outlive the XmlReader.
+ */
+XmlReader::XmlReader(const char* buffer) :	_stream(nullptr),
+											_ownedStream(nullptr),
+											_chunkSize(0),
+											_streamDone(true)
+{
+	start(buffer ? buffer : "");
+}
+
+
+/**
+ * C'tor
+ *
+ * \param stream	FileStream to read the XML document from. The stream must
+ *					outlive the XmlReader.
+ * \param chunkSize	Number of bytes to read from the stream at a time.
+ */
+XmlReader::XmlReader(FileStream& stream, size_t chunkSize) :	_stream(&stream),
+																_ownedStream(nullptr),
+																_chunkSize(std::max<size_t>(chunkSize, 1)),
+																_streamDone(false)
+{
+	start(_buffer.c_str());
+}
+
+
+/**
+ * C'tor
+ *
+ * \param stream	FileStream to read the XML document from. The XmlReader takes
+ *					ownership of the stream.
+ * \param chunkSize	Number of bytes to read from the stream at a time.
+ */
+XmlReader::XmlReader(FileStream&& stream, size_t chunkSize) :	_stream(nullptr),
+																_ownedStream(new FileStream(std::move(stream))),
+																_chunkSize(std::max<size_t>(chunkSize, 1)),
+																_streamDone(false)
+{
+	_stream = _ownedStream;
+	start(_buffer.c_str());
+}
+
+
+/**
+ * D'tor
+ */
+XmlReader::~XmlReader()
+{
+	delete _ownedStream;
+}
+
+
+/**
+ * Advances to the next node.
+ *
+ * \return	True if the reader is positioned on a node. False at the end of the
+ *			document or if an error occured.
+ */
+bool XmlReader::read()
+{
+	if (_error || _type == XML_READER_END_DOCUMENT)
+	{
+		return false;
+	}
+
+	// Empty elements are reported as a start and an end element.
+	if (_type == XML_READER_START_ELEMENT && _emptyElement)
+	{
+		_type = XML_READER_END_ELEMENT;
+		_emptyElement = false;
+		_attributeCount = 0;
+		return true;
+	}
+
+	_attributeCount = 0;
+	_emptyElement = false;
+
+	for (;;)
+	{
+		const char* tag = find("<");
+		if (!tag)
+		{
+			if (!_openElements.empty())
+			{
+				return fail(XmlBase::XML_ERROR_READING_END_TAG);
+			}
+
+			advance(_end);
+			_type = XML_READER_END_DOCUMENT;
+			_location = _cursor;
+			return false;
+		}
+
+		if (tag != _p)
+		{
+			// Text outside of the root element is ignored.
+			if (_openElements.empty())
+			{
+				advance(tag);
+				continue;
+			}
+
+			_location = _cursor;
+			XmlBase::readText(_p, &_text, true, "<", false);
+			advance(tag);
+
+			if (!_text.empty())
+			{
+				_type = XML_READER_TEXT;
+				return true;
+			}
+		}
+
+		// Make sure enough of the document is buffered to tell what kind of tag this is.
+		while (_end - _p < static_cast<ptrdiff_t>(strlen("<![CDATA[")) && fetch()) {}
+
+		if (XmlBase::stringEqual(_p, "<?", false))
+		{
+			if (!skip("?>", XmlBase::XML_ERROR_PARSING_DECLARATION)) { return false; }
+		}
+		else if (XmlBase::stringEqual(_p, "<!--", false))
+		{
+			if (!skip("-->", XmlBase::XML_ERROR_PARSING_COMMENT)) { return false; }
+		}
+		else if (XmlBase::stringEqual(_p, "<![CDATA[", false))
+		{
+			const char* end = find("]]>");
+			if (!end)
+			{
+				return fail(XmlBase::XML_ERROR_PARSING_CDATA);
+			}
+
+			_location = _cursor;
+			const char* text = _p + strlen("<![CDATA[");
+			_text.assign(text, end - text);
+			advance(end + strlen("]]>"));
+
+			if (!_openElements.empty())
+			{
+				_type = XML_READER_TEXT;
+				return true;
+			}
+		}
+		else if (XmlBase::stringEqual(_p, "<!", false))
+		{
+			if (!skip(">", XmlBase::XML_ERROR_PARSING_UNKNOWN)) { return false; }
+		}
+		else if (XmlBase::stringEqual(_p, "</", false))
+		{
+			return readEndElement();
+		}
+		else
+		{
+			return readStartElement();
+		}
+	}
+}
+
+
+/**
+ * Gets the kind of node the reader is positioned on.
+ */
+XmlReader::NodeType XmlReader::type() const
+{
+	return _type;
+}
+
+
+/**
+ * Gets the name of the current start or end element.
+ */
+const std::string& XmlReader::name() const
+{
+	return _name;
+}
+
+
+/**
+ * Gets the text of the current text node. Entities are decoded and white
+ * space is condensed following XmlBase::whitespaceCondensed().
+ */
+const std::string& XmlReader::text() const
+{
+	return _text;
+}
+
+
+/**
+ * Gets whether the current start element is an empty element (<tag />). The
+ * matching end element is still reported by the next read().
+ */
+bool XmlReader::emptyElement() const
+{
+	return _emptyElement;
+}
+
+
+/**
+ * Gets the depth of the current node. The root element is at depth 0.
+ */
+int XmlReader::depth() const
+{
+	int depth = static_cast<int>(_openElements.size());
+
+	// The element being reported is still on the stack.
+	if (_type == XML_READER_START_ELEMENT && !_emptyElement)
+	{
+		--depth;
+	}
+
+	return depth;
+}
+
+
+/**
+ * Gets the row of the current node.
+ */
+int XmlReader::row() const
+{
+	return _location.first + 1;
+}
+
+
+/**
+ * Gets the column of the current node.
+ */
+int XmlReader::column() const
+{
+	return _location.second + 1;
+}
+
+
+/**
+ * Gets the number of attributes of the current start element.
+ */
+int XmlReader::attributeCount() const
+{
+	return _attributeCount;
+}
+
+
+/**
+ * Gets the name of an attribute of the current start element.
+ *
+ * \param index	Index of the attribute, in the order they appear in the document.
+ */
+const std::string& XmlReader::attributeName(int index) const
+{
+	if (index < 0 || index >= _attributeCount)
+	{
+		return XML_READER_EMPTY_STRING;
+	}
+
+	return _attributes[index].first;
+}
+
+
+/**
+ * Gets the value of an attribute of the current start element.
+ *
+ * \param index	Index of the attribute, in the order they appear in the document.
+ */
+const std::string& XmlReader::attributeValue(int index) const
+{
+	if (index < 0 || index >= _attributeCount)
+	{
+		return XML_READER_EMPTY_STRING;
+	}
+
+	return _attributes[index].second;
+}
+
+
+/**
+ * Gets the value of a named attribute of the current start element.
+ *
+ * \return	Value of the attribute or an empty string if the attribute doesn't exist.
+ */
+const std::string& XmlReader::attribute(const std::string& name) const
+{
+	for (int i = 0; i < _attributeCount; ++i)
+	{
+		if (_attributes[i].first == name)
+		{
+			return _attributes[i].second;
+		}
+	}
+
+	return XML_READER_EMPTY_STRING;
+}
+
+
+/**
+ * Gets whether an error occured while reading the document.
+ */
+bool XmlReader::error() const
+{
+	return _error;
+}
+
+
+/**
+ * Gets a description of the error, if one occured.
+ */
+const std::string& XmlReader::errorDesc() const
+{
+	return _errorDesc;
+}
+
+
+/**
+ * Gets the error code of the error, if one occured. See XmlBase::XmlErrorCode.
+ */
+int XmlReader::errorId() const
+{
+	return _errorId;
+}
+
+
+/**
+ * Gets the row where the error occured.
+ */
+int XmlReader::errorRow() const
+{
+	return _errorLocation.first + 1;
+}
+
+
+/**
+ * Gets the column where the error occured.
+ */
+int XmlReader::errorCol() const
+{
+	return _errorLocation.second + 1;
+}
+
+
+/**
+ * Resets the reader to the beginning of a buffer.
+ */
+void XmlReader::start(const char* buffer)
+{
+	_p = buffer;
+	_end = buffer + strlen(buffer);
+	_cursor = std::make_pair(0, 0);
+
+	_type = XML_READER_NONE;
+	_emptyElement = false;
+	_location = _cursor;
+
+	_attributeCount = 0;
+
+	_error = false;
+	_errorId = XmlBase::XML_NO_ERROR;
+	_errorLocation = _cursor;
+
+	// Skip a UTF-8 byte order mark.
+	if (*_p && strncmp(_p, "\xef\xbb\xbf", 3) == 0)
+	{
+		_p += 3;
+	}
+}
+
+
+/**
+ * Reads the next chunk of the stream into the buffer. Everything before the
+ * current read position is discarded.
+ *
+ * \return	False if there's nothing left to read.
+ *
+ * \note	Invalidates any pointers into the buffer.
+ */
+bool XmlReader::fetch()
+{
+	if (_streamDone)
+	{
+		return false;
+	}
+
+	_buffer.erase(0, _p - _buffer.c_str());
+
+	size_t size = _buffer.size();
+	_buffer.resize(size + _chunkSize);
+	size_t count = _stream->read(&_buffer[size], _chunkSize);
+	_buffer.resize(size + count);
+
+	if (count < _chunkSize)
+	{
+		_streamDone = true;
+	}
+
+	// Anything after an embedded null can't be read.
+	if (memchr(_buffer.c_str() + size, '\0', count))
+	{
+		_streamDone = true;
+	}
+
+	_p = _buffer.c_str();
+	_end = _p + strlen(_p);
+
+	// Skip a UTF-8 byte order mark at the start of the stream.
+	if (_cursor.first == 0 && _cursor.second == 0 && strncmp(_p, "\xef\xbb\xbf", 3) == 0)
+	{
+		_p += 3;
+	}
+
+	return count > 0;
+}
+
+
+/**
+ * Finds an end tag at or after the current read position, reading more of the
+ * stream as needed.
+ *
+ * \return	Pointer to the end tag or \c nullptr if it isn't in the document.
+ */
+const char* XmlReader::find(const char* endTag)
+{
+	size_t length = strlen(endTag);
+	size_t offset = 0;
+
+	for (;;)
+	{
+		const char* found = XmlBase::findEndTag(_p + offset, endTag, false);
+		if (*found)
+		{
+			return found;
+		}
+
+		// The end tag may straddle the end of the buffer.
+		offset = static_cast<size_t>(_end - _p);
+		offset = offset > length ? offset - length + 1 : 0;
+
+		if (!fetch())
+		{
+			return nullptr;
+		}
+	}
+}
+
+
+/**
+ * Finds the '>' that closes the start tag at the current read position,
+ * ignoring any '>' in quoted attribute values.
+ *
+ * \return	Pointer to the '>' or \c nullptr if the tag isn't closed.
+ */
+const char* XmlReader::findTagEnd()
+{
+	size_t offset = 0;
+	char quote = 0;
+
+	for (;;)
+	{
+		for (const char* p = _p + offset; *p; ++p)
+		{
+			if (quote)
+			{
+				if (*p == quote) { quote = 0; }
+			}
+			else if (*p == '\"' || *p == '\'')
+			{
+				quote = *p;
+			}
+			else if (*p == '>')
+			{
+				return p;
+			}
+		}
+
+		offset = static_cast<size_t>(_end - _p);
+
+		if (!fetch())
+		{
+			return nullptr;
+		}
+	}
+}
+
+
+/**
+ * Moves the read position forward, keeping track of rows and columns.
+ */
+void XmlReader::advance(const char* to)
+{
+	for (; _p < to; ++_p)
+	{
+		if (*_p == '\n')
+		{
+			++_cursor.first;
+			_cursor.second = 0;
+		}
+		else if (*_p != '\r')
+		{
+			++_cursor.second;
+		}
+	}
+}
+
+
+/**
+ * Skips past the next occurance of an end tag.
+ *
+ * \param endTag	Tag to skip past.
+ * \param err		Error to raise if the end tag isn't found.
+ */
+bool XmlReader::skip(const char* endTag, XmlBase::XmlErrorCode err)
+{
+	const char* end = find(endTag);
+	if (!end)
+	{
+		return fail(err);
+	}
+
+	advance(end + strlen(endTag));
+	return true;
+}
+
+
+/**
+ * Reads a start element and its attributes at the current read position.
+ */
+bool XmlReader::readStartElement()
+{
+	if (!findTagEnd())
+	{
+		return fail(XmlBase::XML_ERROR_PARSING_ELEMENT);
+	}
+
+	_location = _cursor;
+
+	const char* p = XmlBase::readName(_p + 1, _name);
+	if (!p || _name.empty())
+	{
+		return fail(XmlBase::XML_ERROR_FAILED_TO_READ_ELEMENT_NAME);
+	}
+
+	for (;;)
+	{
+		p = XmlBase::skipWhiteSpace(p);
+		if (!p)
+		{
+			return fail(XmlBase::XML_ERROR_READING_ATTRIBUTES);
+		}
+
+		if (*p == '/')
+		{
+			if (*(p + 1) != '>')
+			{
+				return fail(XmlBase::XML_ERROR_PARSING_EMPTY);
+			}
+
+			_emptyElement = true;
+			p += 2;
+			break;
+		}
+		else if (*p == '>')
+		{
+			++p;
+			break;
+		}
+
+		if (_attributeCount == static_cast<int>(_attributes.size()))
+		{
+			_attributes.push_back(Attribute());
+		}
+
+		Attribute& attribute = _attributes[_attributeCount];
+
+		p = XmlBase::readName(p, attribute.first);
+		if (!p || attribute.first.empty())
+		{
+			return fail(XmlBase::XML_ERROR_READING_ATTRIBUTES);
+		}
+
+		for (int i = 0; i < _attributeCount; ++i)
+		{
+			if (_attributes[i].first == attribute.first)
+			{
+				return fail(XmlBase::XML_ERROR_PARSING_ELEMENT);
+			}
+		}
+
+		p = XmlBase::skipWhiteSpace(p);
+		if (!p || *p != '=')
+		{
+			return fail(XmlBase::XML_ERROR_READING_ATTRIBUTES);
+		}
+
+		p = XmlBase::skipWhiteSpace(p + 1);
+		if (!p)
+		{
+			return fail(XmlBase::XML_ERROR_READING_ATTRIBUTES);
+		}
+
+		if (*p == '\"' || *p == '\'')
+		{
+			const char quote[2] = { *p, 0 };
+			p = XmlBase::readText(p + 1, &attribute.second, false, quote, false);
+		}
+		else
+		{
+			// Same leniency as XmlAttribute: accept unquoted values.
+			const char* start = p;
+			while (*p && !XmlBase::white_space(*p) && *p != '/' && *p != '>')
+			{
+				if (*p == '\"' || *p == '\'')
+				{
+					return fail(XmlBase::XML_ERROR_READING_ATTRIBUTES);
+				}
+
+				++p;
+			}
+
+			attribute.second.assign(start, p - start);
+		}
+
+		if (!p)
+		{
+			return fail(XmlBase::XML_ERROR_READING_ATTRIBUTES);
+		}
+
+		++_attributeCount;
+	}
+
+	advance(p);
+
+	_openElements.push_back(_name);
+	if (_emptyElement)
+	{
+		_openElements.pop_back();
+	}
+
+	_type = XML_READER_START_ELEMENT;
+	return true;
+}
+
+
+/**
+ * Reads an end element at the current read position.
+ */
+bool XmlReader::readEndElement()
+{
+	if (!find(">"))
+	{
+		return fail(XmlBase::XML_ERROR_READING_END_TAG);
+	}
+
+	_location = _cursor;
+
+	const char* p = XmlBase::readName(_p + 2, _name);
+	if (!p || _name.empty())
+	{
+		return fail(XmlBase::XML_ERROR_READING_END_TAG);
+	}
+
+	p = XmlBase::skipWhiteSpace(p);
+	if (!p || *p != '>' || _openElements.empty() || _openElements.back() != _name)
+	{
+		return fail(XmlBase::XML_ERROR_READING_END_TAG);
+	}
+
+	advance(p + 1);
+	_openElements.pop_back();
+
+	_type = XML_READER_END_ELEMENT;
+	return true;
+}
+
+
+/**
+ * Stops the reader with an error at the current read position.
+ *
+ * \return	Always returns false.
+ */
+bool XmlReader::fail(XmlBase::XmlErrorCode err)
+{
+	if (XML_ERROR_TABLE.empty())
+	{
+		fillErrorTable();
+	}
+
+	_error = true;
+	_errorId = err;
+	_errorDesc = XML_ERROR_TABLE[err];
+	_errorLocation = _cursor;
+
+	_type = XML_READER_NONE;
+	_attributeCount = 0;
+
+	return false;
+}
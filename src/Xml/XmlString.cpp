@@ -0,0 +1,237 @@
+// ==================================================================================
+// = NAS2D
+// = Copyright  2008 - 2017 New Age Software
+// ==================================================================================
+// = NAS2D is distributed under the terms of the zlib license. You are free to copy,
+// = modify and distribute the software under the terms of the zlib license.
+// =
+// = Acknowledgement of your use of NAS2D is appriciated but is not required.
+// ==================================================================================
+#include "NAS2D/Xml/XmlString.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ostream>
+
+using namespace NAS2D::Xml;
+
+
+/**
+ * C'tor
+ *
+ * \param string	String to copy.
+ */
+XmlString::XmlString(const std::string& string) : _owned(true)
+{
+	new (&_storage.string) std::string(string);
+}
+
+
+/**
+ * Copy c'tor.
+ *
+ * \note	The copy always owns its characters, even when \c other is a view.
+ */
+XmlString::XmlString(const XmlString& other) : _owned(true)
+{
+	new (&_storage.string) std::string(other.data(), other.size());
+}
+
+
+/**
+ * Copy operator.
+ *
+ * \note	The copy always owns its characters, even when \c other is a view.
+ */
+XmlString& XmlString::operator=(const XmlString& other)
+{
+	if (this != &other)
+	{
+		assign(other.data(), other.size());
+	}
+
+	return *this;
+}
+
+
+/**
+ * Copies a \c std::string into the XmlString.
+ */
+XmlString& XmlString::operator=(const std::string& string)
+{
+	assign(string.data(), string.size());
+	return *this;
+}
+
+
+/**
+ * Copies characters into a string owned by the XmlString.
+ *
+ * \param data	Characters to copy. May point into the XmlString itself.
+ * \param size	Number of characters to copy.
+ */
+void XmlString::assign(const char* data, size_t size)
+{
+	if (_owned)
+	{
+		_storage.string.assign(data, size);
+		return;
+	}
+
+	new (&_storage.string) std::string(data, size);
+	_owned = true;
+}
+
+
+/**
+ * Takes over the contents of a \c std::string.
+ */
+void XmlString::assign(std::string&& string)
+{
+	if (_owned)
+	{
+		_storage.string = std::move(string);
+		return;
+	}
+
+	new (&_storage.string) std::string(std::move(string));
+	_owned = true;
+}
+
+
+/**
+ * Makes the XmlString a view of characters owned by something else.
+ *
+ * \param data	Characters to refer to. Must outlive the XmlString or the
+ *				next call to assign() or view().
+ * \param size	Number of characters.
+ */
+void XmlString::view(const char* data, size_t size)
+{
+	if (_owned)
+	{
+		_storage.string.~basic_string();
+		_owned = false;
+	}
+
+	_storage.view.data = data;
+	_storage.view.size = size;
+}
+
+
+/**
+ * Empties the XmlString.
+ */
+void XmlString::clear()
+{
+	if (_owned)
+	{
+		_storage.string.clear();
+		return;
+	}
+
+	_storage.view.data = "";
+	_storage.view.size = 0;
+}
+
+
+/**
+ * Gets the XmlString as a \c std::string.
+ *
+ * \note	Views copy their characters into a \c std::string of their own on
+ *			the first call. Use data() and size() to get at the characters
+ *			without a copy.
+ *
+ * \warning	Not safe to call from more than one thread at a time on a view.
+ */
+const std::string& XmlString::str() const
+{
+	if (!_owned)
+	{
+		View view = _storage.view;
+		new (&_storage.string) std::string(view.data, view.size);
+		_owned = true;
+	}
+
+	return _storage.string;
+}
+
+
+/**
+ * Compares the XmlString to a run of characters as long as itself ignoring
+ * case. "Case", "caSe", "CASE", etc. will all be viewed as identical.
+ *
+ * \see equalsRun()
+ */
+bool XmlString::equalsNoCase(const char* data) const
+{
+	const char* characters = this->data();
+	const size_t size = this->size();
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		if (characters[i] != data[i] && std::tolower(static_cast<unsigned char>(characters[i])) != std::tolower(static_cast<unsigned char>(data[i])))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * Compares the XmlString to a null terminated string.
+ *
+ * \param string		String to compare to.
+ * \param ignoreCase	Whether to ignore case.
+ */
+bool XmlString::equals(const char* string, bool ignoreCase) const
+{
+	const char* characters = data();
+	const size_t length = size();
+
+	for (size_t i = 0; i < length; ++i)
+	{
+		if (string[i] == '\0')
+		{
+			return false;
+		}
+
+		if (characters[i] != string[i] && (!ignoreCase || std::tolower(static_cast<unsigned char>(characters[i])) != std::tolower(static_cast<unsigned char>(string[i]))))
+		{
+			return false;
+		}
+	}
+
+	return string[length] == '\0';
+}
+
+
+/**
+ * Orders XmlStrings the same way \c std::string orders its strings.
+ */
+bool XmlString::operator<(const XmlString& rhs) const
+{
+	int result = std::memcmp(data(), rhs.data(), std::min(size(), rhs.size()));
+	return result < 0 || (result == 0 && size() < rhs.size());
+}
+
+
+/**
+ * Writes an XmlString to a stream.
+ */
+std::ostream& NAS2D::Xml::operator<<(std::ostream& out, const XmlString& string)
+{
+	return out.write(string.data(), string.size());
+}
+
+
+/**
+ * Appends an XmlString to a \c std::string.
+ */
+std::string& NAS2D::Xml::operator+=(std::string& out, const XmlString& string)
+{
+	return out.append(string.data(), string.size());
+}
@@ -42,11 +42,13 @@ void XmlText::write(std::string& buf, int depth) const
 			buf += "\t";
 		}
 
-		buf += "<![CDATA[" + value() + "]]>\n"; // unformatted output
+		buf += "<![CDATA[";
+		buf += _value;
+		buf += "]]>\n"; // unformatted output
 	}
 	else
 	{
-		buf += value();
+		buf += _value;
 	}
 }
 
@@ -69,9 +71,10 @@ XmlNode* XmlText::clone() const
 
 bool XmlText::blank() const
 {
-	for (unsigned i = 0; i < _value.length(); ++i)
+	const char* text = _value.data();
+	for (size_t i = 0; i < _value.size(); ++i)
 	{
-		if (!white_space(_value[i]))
+		if (!white_space(text[i]))
 		{
 			return false;
 		}
@@ -41,7 +41,9 @@ void XmlUnknown::write(std::string& buf, int depth) const
 		buf += "\t";
 	}
 
-	buf += "<" + value() + ">";
+	buf += "<";
+	buf += _value;
+	buf += ">";
 }
 
 